@@ -780,6 +780,92 @@ public:
             }
             return *this;
         }
+        
+        /*!
+            @brief Decode current and next set bits into an array and
+            advance enumerator past them
+            
+            Decodes a block at a time (bit-blocks word by word, GAP blocks
+            run by run), which is faster than value()/go_up() per bit.
+            
+            @param arr      - target array
+            @param arr_size - array capacity
+            @return number of decoded values 
+                    (less than arr_size if traversal ended)
+        */
+        unsigned decode(bm::id_t* arr, unsigned arr_size)
+        {
+            unsigned cnt = 0;
+            while (cnt < arr_size && this->valid())
+            {
+                bm::id_t base = bm::id_t(this->block_idx_) * bm::bits_in_block;
+                unsigned nbit = unsigned(this->position_ - base);
+                
+                if (this->block_type_) // GAP: copy "ON" runs
+                {
+                    const bm::gap_word_t* gptr = BMGAP_PTR(this->block_);
+                    unsigned is_set;
+                    unsigned gpos = bm::gap_bfind(gptr, nbit, &is_set);
+                    BM_ASSERT(is_set);
+                    for (;;)
+                    {
+                        unsigned run_end = gptr[gpos];
+                        for (; nbit <= run_end && cnt < arr_size; ++nbit)
+                        {
+                            arr[cnt++] = base + nbit;
+                        }
+                        if (nbit <= run_end) // array is full
+                            break;
+                        if (run_end == bm::gap_max_bits - 1 ||
+                            gptr[gpos + 1] == bm::gap_max_bits - 1)
+                        {
+                            nbit = bm::gap_max_bits; // end of block
+                            break;
+                        }
+                        nbit = gptr[gpos + 1] + 1u; // skip the "OFF" run
+                        gpos += 2;
+                    } // for
+                }
+                else // bit-block: bit list of every word
+                {
+                    unsigned char bits[32];
+                    unsigned nword = nbit >> bm::set_word_shift;
+                    bm::word_t w = this->block_[nword] &
+                                   (~0u << (nbit & bm::set_word_mask));
+                    for (;;)
+                    {
+                        unsigned bcnt = bm::bitscan(w, bits);
+                        unsigned wbase = nword * 32;
+                        unsigned i = 0;
+                        for (; i < bcnt && cnt < arr_size; ++i)
+                        {
+                            arr[cnt++] = base + wbase + bits[i];
+                        }
+                        if (i < bcnt) // array is full
+                        {
+                            nbit = wbase + bits[i];
+                            break;
+                        }
+                        if (++nword == bm::set_block_size)
+                        {
+                            nbit = bm::gap_max_bits; // end of block
+                            break;
+                        }
+                        w = this->block_[nword];
+                    } // for
+                }
+                
+                // re-position on the first bit not decoded yet
+                if (nbit == bm::gap_max_bits &&
+                    this->block_idx_ == bm::set_total_blocks - 1)
+                {
+                    this->invalidate();
+                    break;
+                }
+                go_to(base + nbit);
+            } // while
+            return cnt;
+        }
 
 
     private:
@@ -1822,6 +1908,24 @@ public:
     */
     void calc_stat(struct bm::bvector<Alloc>::statistics* st) const;
 
+    /*!
+       @brief Computes size of the serialized bitvector.
+
+       @param compression_level - serialization compression level (0-5)
+
+       Thin wrapper over bm::serializer::estimate_serialized_size()
+       with default serializer settings (byte-order is saved,
+       GAP levels are not saved). The result is exact, but the
+       estimate runs all block encoders of serialize() (only the output
+       is skipped), so it costs about as much as serialization itself.
+       Defined in bmserial.h (include it to use this method).
+
+       @return size of serialization BLOB (in bytes)
+
+       @sa calc_stat, serializer
+    */
+    size_t estimate_serialized_size(unsigned compression_level = 4) const;
+
     /*!
        \brief Sets new blocks allocation strategy.
        \param strat - Strategy code 0 - bitblocks allocation only.
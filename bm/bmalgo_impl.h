@@ -367,6 +367,24 @@ unsigned combine_count_and_operation_with_block(const bm::word_t* blk,
     return bit_operation_and_count(blk, blk + (bm::set_block_size), arg_blk);
 }
 
+/*!
+\brief Internal function computes AND distance up to the limit.
+\internal 
+\ingroup  distance
+*/
+inline
+unsigned combine_count_and_limit_with_block(const bm::word_t* blk,
+                                            const bm::word_t* arg_blk,
+                                            unsigned          limit)
+{
+    if (BM_IS_GAP(blk) || BM_IS_GAP(arg_blk))
+    {
+        return combine_count_and_operation_with_block(blk, arg_blk);
+    }
+    return bit_operation_and_count_limit(blk, blk + (bm::set_block_size), 
+                                         arg_blk, limit);
+}
+
 
 /*!
     \brief Internal function computes different existense of distance metric.
@@ -924,7 +942,7 @@ void distance_operation_any(const BV& bv1,
                                                  dmit, dmit_end);
 
                 // check if all distance requests alredy resolved
-                bool all_resolved = false;
+                bool all_resolved = true;
                 distance_metric_descriptor* it=dmit;
                 do
                 {
@@ -961,7 +979,7 @@ void distance_operation_any(const BV& bv1,
                                              dmit, dmit_end);
             
             // check if all distance requests alredy resolved
-            bool all_resolved = false;
+            bool all_resolved = true;
             distance_metric_descriptor* it=dmit;
             do
             {
@@ -995,6 +1013,60 @@ bm::id_t count_and(const BV& bv1, const BV& bv2)
     return distance_and_operation(bv1, bv2);
 }
 
+/*!
+   \brief Computes bitcount of AND operation of two bitsets up to the limit.
+   Computation stops as soon as the limit is reached, which makes it 
+   cheaper than count_and() for threshold queries.
+   \param bv1 - Argument bit-vector.
+   \param bv2 - Argument bit-vector.
+   \param limit - count limit
+   \return bitcount of the result if it is less than limit, 
+            otherwise limit
+   \ingroup  distance
+*/
+template<class BV>
+bm::id_t count_and_limit(const BV& bv1, const BV& bv2, bm::id_t limit)
+{
+    const typename BV::blocks_manager_type& bman1 = bv1.get_blocks_manager();
+    const typename BV::blocks_manager_type& bman2 = bv2.get_blocks_manager();
+    
+    if (!limit || !bman1.is_init() || !bman2.is_init())
+        return 0;
+
+    bm::word_t*** blk_root     = bman1.top_blocks_root();
+    bm::word_t*** blk_root_arg = bman2.top_blocks_root();
+    bm::id_t count = 0;
+
+    BM_SET_MMX_GUARD
+
+    unsigned effective_top_block_size = 
+        bm::min_value(bman1.effective_top_block_size(), 
+                      bman2.effective_top_block_size());
+
+    for (unsigned i = 0; i < effective_top_block_size; ++i)
+    {
+        bm::word_t** blk_blk;
+        bm::word_t** blk_blk_arg;
+        if ((blk_blk = blk_root[i]) == 0 || (blk_blk_arg= blk_root_arg[i]) == 0)
+        {
+            continue;
+        }
+        for (unsigned j = 0; j < bm::set_array_size; ++j)
+        {
+            if (!blk_blk[j] || !blk_blk_arg[j])
+                continue;
+            count += combine_count_and_limit_with_block(
+                                            BLOCK_ADDR_SAN(blk_blk[j]), 
+                                            BLOCK_ADDR_SAN(blk_blk_arg[j]),
+                                            limit - count);
+            if (count >= limit)
+                return limit;
+        } // for j
+
+    } // for i
+    return count;
+}
+
 /*!
    \brief Computes if there is any bit in AND operation of two bitsets
    \param bv1 - Argument bit-vector.
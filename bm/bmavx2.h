@@ -851,6 +851,481 @@ bool avx2_is_all_one(const __m256i* BMRESTRICT block,
 
 
 
+/*!
+    @brief CRC32C checksum using crc32 instructions (SSE4.2 subset of AVX2 targets)
+    @param buf - data buffer
+    @param len - buffer length in bytes
+    @param crc - CRC32C of the previous data chunk (0 - start)
+    @return CRC32C
+    @ingroup AVX2
+*/
+inline
+unsigned avx2_crc32c(const unsigned char* BMRESTRICT buf, 
+                     size_t len, 
+                     unsigned crc)
+{
+    unsigned c = ~crc;
+#ifdef BM64_AVX2
+    bm::id64_t c64 = c;
+    for (; len >= 8; len -= 8, buf += 8)
+        c64 = _mm_crc32_u64(c64, *(const bm::id64_t*)buf);
+    c = (unsigned)c64;
+#else
+    for (; len >= 4; len -= 4, buf += 4)
+        c = _mm_crc32_u32(c, *(const unsigned*)buf);
+#endif
+    for (; len; --len)
+        c = _mm_crc32_u8(c, *buf++);
+    return ~c;
+}
+
+
+/*!
+    @brief Stream VByte (16-bit) d-gap decoder
+    Decodes two groups of 8 values per iteration (one per 128-bit lane),
+    carries prefix sum across lanes. Reads 16 bytes of data per group.
+    @param ctrl - control bytes
+    @param data - data bytes
+    @param dst  - target array
+    @param groups - number of groups to decode
+    @param prev - previous value (prefix sum base), updated
+    @return pointer on the data bytes of the next group
+    @ingroup AVX2
+*/
+inline
+const unsigned char* avx2_svb16_dgap_decode(const unsigned char* BMRESTRICT ctrl,
+                                           const unsigned char* BMRESTRICT data,
+                                           bm::gap_word_t*      BMRESTRICT dst,
+                                           unsigned                        groups,
+                                           bm::gap_word_t&                 prev)
+{
+    const unsigned char (*shuf)[16] = bm::svb16_shuffle_table<true>::_shuf;
+    __m256i mprev = _mm256_set1_epi16((short)prev);
+    const __m256i mbcast = _mm256_set1_epi16(0x0F0E); // broadcast of the last
+    for (; groups >= 2; groups -= 2, ctrl += 2, dst += 16)
+    {
+        unsigned c0 = ctrl[0], c1 = ctrl[1];
+        const unsigned char* data1 = data + 8 + _mm_popcnt_u32(c0);
+        __m256i v = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)data)),
+            _mm_loadu_si128((const __m128i*)data1), 1);
+        __m256i mshuf = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)shuf[c0])),
+            _mm_loadu_si128((const __m128i*)shuf[c1]), 1);
+        v = _mm256_shuffle_epi8(v, mshuf);
+        v = _mm256_add_epi16(v, _mm256_slli_si256(v, 2));
+        v = _mm256_add_epi16(v, _mm256_slli_si256(v, 4));
+        v = _mm256_add_epi16(v, _mm256_slli_si256(v, 8));
+        // carry the sum of the low lane into the high lane
+        __m256i mlast = _mm256_shuffle_epi8(v, mbcast);
+        v = _mm256_add_epi16(v, _mm256_permute2x128_si256(mlast, mlast, 0x08));
+        v = _mm256_add_epi16(v, mprev);
+        _mm256_storeu_si256((__m256i*)dst, v);
+        mprev = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, mbcast), 0xFF);
+        data = data1 + 8 + _mm_popcnt_u32(c1);
+    }
+    __m128i mprev128 = _mm256_castsi256_si128(mprev);
+    if (groups) // last odd group
+    {
+        unsigned c = ctrl[0];
+        __m128i v = _mm_loadu_si128((const __m128i*)data);
+        v = _mm_shuffle_epi8(v, _mm_loadu_si128((const __m128i*)shuf[c]));
+        v = _mm_add_epi16(v, _mm_slli_si128(v, 2));
+        v = _mm_add_epi16(v, _mm_slli_si128(v, 4));
+        v = _mm_add_epi16(v, _mm_slli_si128(v, 8));
+        v = _mm_add_epi16(v, mprev128);
+        _mm_storeu_si128((__m128i*)dst, v);
+        mprev128 = _mm_shuffle_epi8(v, _mm256_castsi256_si128(mbcast));
+        data += 8 + _mm_popcnt_u32(c);
+    }
+    prev = (bm::gap_word_t)_mm_extract_epi16(mprev128, 0);
+    return data;
+}
+
+/*!
+    @brief Unpacks 64-bit word into list of ON bit indexes
+    (table driven byte expansion, 2 bytes (16 indexes) per iteration)
+    @param w - value
+    @param bits - target array (64 bytes, tail can be overwritten)
+    @return number of bits in the list
+    @ingroup AVX2
+*/
+inline
+unsigned avx2_bitscan64(bm::id64_t w, unsigned char* BMRESTRICT bits)
+{
+    unsigned char* BMRESTRICT pos = bits;
+    __m128i moffs = _mm_set_epi8(8,8,8,8,8,8,8,8, 0,0,0,0,0,0,0,0);
+    const __m128i m16 = _mm_set1_epi8(16);
+    for (; w; w >>= 16, moffs = _mm_add_epi8(moffs, m16))
+    {
+        unsigned b0 = unsigned(w & 0xFFu);
+        unsigned b1 = unsigned((w >> 8) & 0xFFu);
+        __m128i v = _mm_unpacklo_epi64(
+            _mm_loadl_epi64((const __m128i*)bm::bit_idx_table<true>::_idx[b0]),
+            _mm_loadl_epi64((const __m128i*)bm::bit_idx_table<true>::_idx[b1]));
+        v = _mm_add_epi8(v, moffs);
+        _mm_storel_epi64((__m128i*)pos, v);
+        pos += _mm_popcnt_u32(b0);
+        _mm_storel_epi64((__m128i*)pos, _mm_srli_si128(v, 8));
+        pos += _mm_popcnt_u32(b1);
+    }
+    return unsigned(pos - bits);
+}
+
+/*!
+    @brief Unpacks 32-bit word into list of 16-bit ON bit indexes
+    (table driven byte expansion, 2 bytes (16 indexes) per iteration)
+    @param w - value
+    @param dst - target array (32 elements, tail can be overwritten)
+    @param base - index of the word bit 0
+    @return number of bits in the list
+    @ingroup AVX2
+*/
+inline
+unsigned avx2_bit_to_arr16(bm::word_t w, 
+                           bm::gap_word_t* BMRESTRICT dst, 
+                           unsigned base)
+{
+    bm::gap_word_t* BMRESTRICT pos = dst;
+    __m256i mbase = _mm256_add_epi16(_mm256_set1_epi16((short)base),
+                        _mm256_set_m128i(_mm_set1_epi16(8), _mm_setzero_si128()));
+    const __m256i m16 = _mm256_set1_epi16(16);
+    for (; w; w >>= 16, mbase = _mm256_add_epi16(mbase, m16))
+    {
+        unsigned b0 = w & 0xFFu;
+        unsigned b1 = (w >> 8) & 0xFFu;
+        __m256i v = _mm256_cvtepu8_epi16(_mm_unpacklo_epi64(
+            _mm_loadl_epi64((const __m128i*)bm::bit_idx_table<true>::_idx[b0]),
+            _mm_loadl_epi64((const __m128i*)bm::bit_idx_table<true>::_idx[b1])));
+        v = _mm256_add_epi16(v, mbase);
+        _mm_storeu_si128((__m128i*)pos, _mm256_castsi256_si128(v));
+        pos += _mm_popcnt_u32(b0);
+        _mm_storeu_si128((__m128i*)pos, _mm256_extracti128_si256(v, 1));
+        pos += _mm_popcnt_u32(b1);
+    }
+    return unsigned(pos - dst);
+}
+
+/*!
+    @brief Lane masks of 256-bit vector for bits [left, right] 
+    (left and right are bit positions within the vector)
+    \internal
+*/
+BMFORCEINLINE
+__m256i avx2_bit_range_mask(unsigned left, unsigned right)
+{
+    const __m256i midx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i ml = _mm256_set1_epi32(int(left >> bm::set_word_shift));
+    const __m256i mr = _mm256_set1_epi32(int(right >> bm::set_word_shift));
+    const __m256i mwl = _mm256_set1_epi32(
+        int(bm::block_set_table<true>::_right[left & bm::set_word_mask]));
+    const __m256i mwr = _mm256_set1_epi32(
+        int(bm::block_set_table<true>::_left[right & bm::set_word_mask]));
+    __m256i m1 = _mm256_or_si256(_mm256_cmpgt_epi32(midx, ml),
+                    _mm256_and_si256(_mm256_cmpeq_epi32(midx, ml), mwl));
+    __m256i m2 = _mm256_or_si256(_mm256_cmpgt_epi32(mr, midx),
+                    _mm256_and_si256(_mm256_cmpeq_epi32(midx, mr), mwr));
+    return _mm256_and_si256(m1, m2);
+}
+
+/*!
+    @brief AND two bit blocks and test for any bit.
+    Blocks are scanned in 128-byte stripes, first non-empty stripe stops the scan.
+    @ingroup AVX2
+*/
+inline
+bool avx2_and_block_any(const __m256i* BMRESTRICT block,
+                        const __m256i* BMRESTRICT block_end,
+                        const __m256i* BMRESTRICT mask_block)
+{
+    do
+    {
+        __m256i w0 = _mm256_and_si256(_mm256_load_si256(block+0), _mm256_load_si256(mask_block+0));
+        __m256i w1 = _mm256_and_si256(_mm256_load_si256(block+1), _mm256_load_si256(mask_block+1));
+        __m256i w2 = _mm256_and_si256(_mm256_load_si256(block+2), _mm256_load_si256(mask_block+2));
+        __m256i w3 = _mm256_and_si256(_mm256_load_si256(block+3), _mm256_load_si256(mask_block+3));
+
+        w0 = _mm256_or_si256(_mm256_or_si256(w0, w1), _mm256_or_si256(w2, w3));
+        if (!_mm256_testz_si256(w0, w0))
+            return true;
+        block += 4; mask_block += 4;
+    } while (block < block_end);
+    return false;
+}
+
+/*!
+    @brief AND bit count for two aligned bit-blocks with early exit.
+    Count is reduced after every 128-byte stripe, scan stops as soon as
+    the limit is reached.
+    @return bit count (exact if less than limit, otherwise >= limit)
+    @ingroup AVX2
+*/
+inline
+bm::id_t avx2_bit_count_and_limit(const __m256i* BMRESTRICT block,
+                                  const __m256i* BMRESTRICT block_end,
+                                  const __m256i* BMRESTRICT mask_block,
+                                  bm::id_t                  limit)
+{
+    BM_AVX2_POPCNT_PROLOG;
+    bm::id_t count = 0;
+    do
+    {
+        __m256i cnt, ymm0;
+
+        ymm0 = _mm256_and_si256(_mm256_load_si256(block+0), _mm256_load_si256(mask_block+0));
+        BM_AVX2_BIT_COUNT(bc, ymm0)
+        cnt = bc;
+        ymm0 = _mm256_and_si256(_mm256_load_si256(block+1), _mm256_load_si256(mask_block+1));
+        BM_AVX2_BIT_COUNT(bc, ymm0)
+        cnt = _mm256_add_epi64(cnt, bc);
+        ymm0 = _mm256_and_si256(_mm256_load_si256(block+2), _mm256_load_si256(mask_block+2));
+        BM_AVX2_BIT_COUNT(bc, ymm0)
+        cnt = _mm256_add_epi64(cnt, bc);
+        ymm0 = _mm256_and_si256(_mm256_load_si256(block+3), _mm256_load_si256(mask_block+3));
+        BM_AVX2_BIT_COUNT(bc, ymm0)
+        cnt = _mm256_add_epi64(cnt, bc);
+
+        __m128i s = _mm_add_epi64(_mm256_castsi256_si128(cnt),
+                                  _mm256_extracti128_si256(cnt, 1));
+        s = _mm_add_epi64(s, _mm_unpackhi_epi64(s, s));
+        count += (bm::id_t)_mm_cvtsi128_si32(s);
+        if (count >= limit)
+            break;
+        block += 4; mask_block += 4;
+    } while (block < block_end);
+    return count;
+}
+
+/*!
+    @brief 32x32 bit-matrix transposition: bit j of src[i] goes to bit i of dst[j].
+    Bytes of 32 words are regrouped into byte plains (pshufb, dword 
+    transpose and lane permute), bits are taken out of byte plains 
+    with movemask.
+    @ingroup AVX2
+*/
+inline
+void avx2_bit_transpose_32x32(const bm::word_t* BMRESTRICT src,
+                              bm::word_t* BMRESTRICT dst)
+{
+    const __m256i bshuf = 
+        _mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15,
+                         0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    const __m256i lperm = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    
+    __m256i v0 = _mm256_shuffle_epi8(_mm256_loadu_si256((__m256i*)(src+0)), bshuf);
+    __m256i v1 = _mm256_shuffle_epi8(_mm256_loadu_si256((__m256i*)(src+8)), bshuf);
+    __m256i v2 = _mm256_shuffle_epi8(_mm256_loadu_si256((__m256i*)(src+16)), bshuf);
+    __m256i v3 = _mm256_shuffle_epi8(_mm256_loadu_si256((__m256i*)(src+24)), bshuf);
+
+    __m256i t0 = _mm256_unpacklo_epi32(v0, v1);
+    __m256i t1 = _mm256_unpackhi_epi32(v0, v1);
+    __m256i t2 = _mm256_unpacklo_epi32(v2, v3);
+    __m256i t3 = _mm256_unpackhi_epi32(v2, v3);
+
+    __m256i bp[4];
+    bp[0] = _mm256_permutevar8x32_epi32(_mm256_unpacklo_epi64(t0, t2), lperm);
+    bp[1] = _mm256_permutevar8x32_epi32(_mm256_unpackhi_epi64(t0, t2), lperm);
+    bp[2] = _mm256_permutevar8x32_epi32(_mm256_unpacklo_epi64(t1, t3), lperm);
+    bp[3] = _mm256_permutevar8x32_epi32(_mm256_unpackhi_epi64(t1, t3), lperm);
+
+    for (unsigned b = 0; b < 4; ++b)
+    {
+        __m256i y = bp[b];
+        bm::word_t* d = dst + b * 8;
+        for (int k = 7; k >= 0; --k)
+        {
+            d[k] = (bm::word_t)_mm256_movemask_epi8(y);
+            y = _mm256_add_epi8(y, y);
+        }
+    } // for b
+}
+
+/*!
+    @brief Bitcount of bit block in the range [left, right] (borders included).
+    Edge vectors are counted with lane masks (masked prefix/suffix),
+    vectors in between with nibble lookup popcount.
+    @param block - bit block (aligned)
+    @param left - left border
+    @param right - right border
+    @ingroup AVX2
+*/
+inline
+bm::id_t avx2_bit_block_calc_count_range(const bm::word_t* BMRESTRICT block,
+                                         unsigned left, unsigned right)
+{
+    BM_ASSERT(left <= right);
+    BM_AVX2_POPCNT_PROLOG
+
+    const __m256i* BMRESTRICT b = (const __m256i*) block;
+    const unsigned v_left = left >> 8;
+    const unsigned v_right = right >> 8;
+    __m256i cnt;
+    if (v_left == v_right)
+    {
+        __m256i v = _mm256_and_si256(_mm256_loadu_si256(b + v_left),
+                        avx2_bit_range_mask(left & 255u, right & 255u));
+        BM_AVX2_BIT_COUNT(cnt, v);
+    }
+    else
+    {
+        __m256i v = _mm256_and_si256(_mm256_loadu_si256(b + v_left),
+                        avx2_bit_range_mask(left & 255u, 255u));
+        BM_AVX2_BIT_COUNT(cnt, v);
+        v = _mm256_and_si256(_mm256_loadu_si256(b + v_right),
+                        avx2_bit_range_mask(0u, right & 255u));
+        BM_AVX2_BIT_COUNT(bc, v);
+        cnt = _mm256_add_epi64(cnt, bc);
+        for (unsigned i = v_left + 1; i < v_right; ++i)
+        {
+            v = _mm256_loadu_si256(b + i);
+            BM_AVX2_BIT_COUNT(bc, v);
+            cnt = _mm256_add_epi64(cnt, bc);
+        }
+    }
+    bm::id64_t* cnt64 = (bm::id64_t*)&cnt;
+    return (bm::id_t)(cnt64[0] + cnt64[1] + cnt64[2] + cnt64[3]);
+}
+
+/*!
+    @brief Find the first 1 bit in bit block starting from nbit
+    (first vector is masked, next vectors are tested for all zero)
+    @param block - bit block (aligned)
+    @param nbit - bit position to start search from
+    @param pos - index of the first 1 bit (out)
+    @return true if found
+    @ingroup AVX2
+*/
+inline
+bool avx2_bit_find_first(const bm::word_t* BMRESTRICT block, 
+                         unsigned nbit, unsigned* BMRESTRICT pos)
+{
+    const __m256i* BMRESTRICT b = (const __m256i*) block;
+    const __m256i* BMRESTRICT b_end = b + bm::set_block_size / 8;
+    b += nbit >> 8;
+    __m256i v = _mm256_and_si256(_mm256_loadu_si256(b), 
+                                 avx2_bit_range_mask(nbit & 255u, 255u));
+    while (_mm256_testz_si256(v, v))
+    {
+        if (++b == b_end)
+            return false;
+        v = _mm256_loadu_si256(b);
+    }
+    unsigned zm = unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(
+                            _mm256_cmpeq_epi32(v, _mm256_setzero_si256()))));
+    zm = ~zm & 0xFFu; // non-zero lanes
+    unsigned nword = 
+        unsigned((const bm::word_t*)b - block) + _mm_popcnt_u32((zm & (0 - zm)) - 1);
+    bm::word_t w = block[nword];
+    if (nword == (nbit >> bm::set_word_shift))
+        w &= bm::block_set_table<true>::_right[nbit & bm::set_word_mask];
+    *pos = (nword << bm::set_word_shift) + _mm_popcnt_u32((w & (0 - w)) - 1);
+    return true;
+}
+
+/*!
+    @brief Hybrid binary search for the GAP where bit = pos located.
+    Branchless binary steps narrow the search down to 32 elements window,
+    window is resolved with two (overlapping) 16-element SIMD compares.
+    Short GAP buffers (less than 8 elements) are compared with one masked
+    load which can read past GAP length (within minimal GAP capacity).
+    @param buf - GAP buffer pointer.
+    @param pos - index of the element.
+    @param is_set - output. GAP value (0 or 1). 
+    @return GAP index.
+    @ingroup AVX2
+*/
+inline
+unsigned avx2_gap_bfind(const unsigned short* BMRESTRICT buf, 
+                        unsigned pos, unsigned* BMRESTRICT is_set)
+{
+    unsigned start = 1;
+    unsigned n = ((*buf) >> 3); // search [start, start + n), last is >= pos
+    if (n <= 16)
+    {
+        const __m128i mbias = _mm_set1_epi16((short)0x8000); // unsigned compare
+        const __m128i mp = _mm_set1_epi16((short)(pos ^ 0x8000));
+        __m128i m1 = _mm_xor_si128(
+                        _mm_loadu_si128((const __m128i*)(buf + 1)), mbias);
+        unsigned mask1 = unsigned(_mm_movemask_epi8(_mm_cmpgt_epi16(mp, m1)));
+        if (n < 8)
+        {
+            start += _mm_popcnt_u32(mask1 & ((1u << (n * 2)) - 1)) >> 1;
+        }
+        else
+        {
+            __m128i m2 = _mm_xor_si128(
+                        _mm_loadu_si128((const __m128i*)(buf + 1 + n - 8)), mbias);
+            unsigned c1 = _mm_popcnt_u32(mask1) >> 1;
+            unsigned c2 = 
+                _mm_popcnt_u32(_mm_movemask_epi8(_mm_cmpgt_epi16(mp, m2))) >> 1;
+            start = (c1 < 8) ? start + c1 : start + n - 8 + c2;
+        }
+    }
+    else
+    {
+        while (n > 32)
+        {
+            unsigned half = n >> 1;
+            start = (buf[start + half - 1] < pos) ? start + half : start;
+            n -= half;
+        }
+        // elements are sorted: compare masks are prefixes
+        const __m256i mbias = _mm256_set1_epi16((short)0x8000);
+        const __m256i mp = _mm256_set1_epi16((short)(pos ^ 0x8000));
+        __m256i m1 = _mm256_xor_si256(
+               _mm256_loadu_si256((const __m256i*)(buf + start)), mbias);
+        __m256i m2 = _mm256_xor_si256(
+               _mm256_loadu_si256((const __m256i*)(buf + start + n - 16)), mbias);
+        unsigned c1 = (unsigned)
+            _mm_popcnt_u32(_mm256_movemask_epi8(_mm256_cmpgt_epi16(mp, m1))) >> 1;
+        unsigned c2 = (unsigned)
+            _mm_popcnt_u32(_mm256_movemask_epi8(_mm256_cmpgt_epi16(mp, m2))) >> 1;
+        start = (c1 < 16) ? start + c1 : start + n - 16 + c2;
+    }
+    *is_set = ((*buf) & 1) ^ ((start - 1) & 1);
+    return start;
+}
+
+/*!
+    @brief Lower bound rank of sorted GAP ends: for every a[i] computes
+    number of b elements less than a[i]. Each b element is broadcast
+    and compared against 16 a elements at once.
+    @param a - sorted array (GAP ends)
+    @param a_len - length of a
+    @param b - sorted array (GAP ends)
+    @param b_len - length of b
+    @param rank - target array (a_len elements)
+    @ingroup AVX2
+*/
+inline
+void avx2_gap_rank(const bm::gap_word_t* BMRESTRICT a, unsigned a_len,
+                   const bm::gap_word_t* BMRESTRICT b, unsigned b_len,
+                   bm::gap_word_t*       BMRESTRICT rank)
+{
+    const __m256i mbias = _mm256_set1_epi16((short)0x8000); // unsigned compare
+    unsigned i = 0, j = 0;
+    for (; i + 16 <= a_len; i += 16)
+    {
+        __m256i ma = _mm256_xor_si256(
+                        _mm256_loadu_si256((const __m256i*)(a + i)), mbias);
+        __m256i mr = _mm256_set1_epi16((short)j);
+        const bm::gap_word_t a_last = a[i + 15];
+        for (; j < b_len && b[j] < a_last; ++j)
+        {
+            __m256i mb = _mm256_set1_epi16((short)(b[j] ^ 0x8000));
+            mr = _mm256_sub_epi16(mr, _mm256_cmpgt_epi16(ma, mb)); // +1 if a > b
+        }
+        _mm256_storeu_si256((__m256i*)(rank + i), mr);
+    }
+    for (; i < a_len; ++i)
+    {
+        for (; j < b_len && b[j] < a[i]; ++j) {}
+        rank[i] = (bm::gap_word_t)j;
+    }
+}
+
+
+
 #define VECT_XOR_ARR_2_MASK(dst, src, src_end, mask)\
     avx2_xor_arr_2_mask((__m256i*)(dst), (__m256i*)(src), (__m256i*)(src_end), (bm::word_t)mask)
 
@@ -899,6 +1374,39 @@ bool avx2_is_all_one(const __m256i* BMRESTRICT block,
 #define VECT_IS_ONE_BLOCK(dst, dst_end) \
     avx2_is_all_one((__m256i*) dst, (__m256i*) (dst_end))
 
+#define VECT_CRC32C(buf, len, crc) \
+    avx2_crc32c((const unsigned char*)(buf), (len), (crc))
+
+#define VECT_SVB16_DGAP_DECODE(ctrl, data, dst, groups, prev) \
+    avx2_svb16_dgap_decode((ctrl), (data), (dst), (groups), (prev))
+
+#define VECT_BITSCAN64(w, bits) \
+    avx2_bitscan64((w), (bits))
+
+#define VECT_BIT_TO_ARR16(w, dst, base) \
+    avx2_bit_to_arr16((w), (dst), (base))
+
+#define VECT_GAP_RANK(a, a_len, b, b_len, rank) \
+    avx2_gap_rank((a), (a_len), (b), (b_len), (rank))
+
+#define VECT_GAP_BFIND(buf, pos, is_set) \
+    avx2_gap_bfind((buf), (pos), (is_set))
+
+#define VECT_BIT_COUNT_RANGE(block, left, right) \
+    avx2_bit_block_calc_count_range((block), (left), (right))
+
+#define VECT_BIT_FIND_FIRST(block, nbit, pos) \
+    avx2_bit_find_first((block), (nbit), (pos))
+
+#define VECT_AND_BLOCK_ANY(first, last, mask) \
+    avx2_and_block_any((__m256i*) (first), (__m256i*) (last), (__m256i*) (mask))
+
+#define VECT_BITCOUNT_AND_LIMIT(first, last, mask, limit) \
+    avx2_bit_count_and_limit((__m256i*) (first), (__m256i*) (last), (__m256i*) (mask), (limit))
+
+#define VECT_BIT_TRANSPOSE_32x32(src, dst) \
+    avx2_bit_transpose_32x32((src), (dst))
+
 
 // TODO: write better pipelined AVX2 implementation
 /*!
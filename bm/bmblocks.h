@@ -1680,6 +1680,74 @@ private:
     bm::word_t*    block_;
 };
 
+/**
+    Buffer of several bit-blocks (temporary work area for block-wise
+    algorithms), allocated on first use and freed on destruction
+    \internal
+*/
+template<class Alloc>
+class bit_blocks_buffer
+{
+public:
+    typedef typename Alloc::allocator_pool_type allocator_pool_type;
+    
+    /**
+        \param alloc - allocator
+        \param cnt   - number of blocks
+        \param pool  - memory pool (0 - blocks are one contiguous area, 
+                       otherwise every block is taken from the pool 
+                       separately on first use)
+    */
+    bit_blocks_buffer(const Alloc& alloc, unsigned cnt,
+                      allocator_pool_type* pool = 0)
+    : alloc_(alloc), cnt_(cnt), buf_(0), blocks_(0)
+    {
+        alloc_.set_pool(pool); // allocator copy does not inherit the pool
+    }
+    ~bit_blocks_buffer()
+    {
+        if (buf_)
+            alloc_.free_bit_block(buf_, cnt_);
+        if (blocks_)
+        {
+            for (unsigned i = 0; i < cnt_; ++i)
+            {
+                if (blocks_[i])
+                    alloc_.free_bit_block(blocks_[i]);
+            }
+            alloc_.free_ptr(blocks_, cnt_);
+        }
+    }
+    
+    /// i-th block of the buffer
+    bm::word_t* block(unsigned i)
+    {
+        BM_ASSERT(i < cnt_);
+        if (!alloc_.get_pool())
+        {
+            if (!buf_)
+                buf_ = alloc_.alloc_bit_block(cnt_);
+            return buf_ + i * bm::set_block_size;
+        }
+        if (!blocks_)
+        {
+            blocks_ = (bm::word_t**) alloc_.alloc_ptr(cnt_);
+            ::memset(blocks_, 0, cnt_ * sizeof(bm::word_t*));
+        }
+        if (!blocks_[i])
+            blocks_[i] = alloc_.alloc_bit_block();
+        return blocks_[i];
+    }
+private:
+    bit_blocks_buffer(const bit_blocks_buffer&);
+    bit_blocks_buffer& operator=(const bit_blocks_buffer&);
+private:
+    Alloc         alloc_;
+    unsigned      cnt_;
+    bm::word_t*   buf_;        ///< contiguous blocks
+    bm::word_t**  blocks_;     ///< separate blocks (from the pool)
+};
+
 
 }
 
@@ -523,6 +523,9 @@ template<typename T>
 unsigned gap_bfind(const T* buf, unsigned pos, unsigned* is_set)
 {
     BM_ASSERT(pos < bm::gap_max_bits);
+#if defined(VECT_GAP_BFIND)
+    return VECT_GAP_BFIND(buf, pos, is_set);
+#else
     *is_set = (*buf) & 1;
 
     BMREGISTER unsigned start = 1;
@@ -538,6 +541,7 @@ unsigned gap_bfind(const T* buf, unsigned pos, unsigned* is_set)
     }
     *is_set ^= ((start-1) & 1);
     return start; 
+#endif
 }
 
 
@@ -595,7 +599,12 @@ template<typename T>
 unsigned gap_test_unr(const T* buf, const unsigned pos)
 {
     BM_ASSERT(pos < bm::gap_max_bits);
-#if defined(BMSSE2OPT)
+#if defined(VECT_GAP_BFIND)
+    unsigned is_set;
+    bm::gap_bfind(buf, pos, &is_set);
+    BM_ASSERT(is_set == bm::gap_test(buf, pos));
+    return is_set;
+#elif defined(BMSSE2OPT)
     unsigned start = 1;
     unsigned end = 1 + ((*buf) >> 3);
     unsigned dsize = end - start;
@@ -633,47 +642,6 @@ unsigned gap_test_unr(const T* buf, const unsigned pos)
 
     unsigned res = ((*buf) & 1) ^ ((--start) & 1);
 
-    BM_ASSERT(res == bm::gap_test(buf, pos));
-    return res;
-#endif
-#if defined(BMSSE42OPT)
-    unsigned start = 1;
-    unsigned end = 1 + ((*buf) >> 3);
-    unsigned dsize = end - start;
-
-    if (dsize < 17)
-    {
-        start = bm::sse4_gap_find(buf+1, (bm::gap_word_t)pos, dsize);
-        unsigned res = ((*buf) & 1) ^ ((start) & 1);
-        BM_ASSERT(buf[start+1] >= pos);
-        BM_ASSERT(buf[start] < pos || (start==0));
-        BM_ASSERT(res == bm::gap_test(buf, pos));
-        return res;
-    }
-    unsigned arr_end = end;
-    while (start != end)
-    {
-        unsigned curr = (start + end) >> 1;
-        if (buf[curr] < pos)
-            start = curr + 1;
-        else
-            end = curr;
-
-        unsigned size = end - start;
-        if (size < 16)
-        {
-            size += (end != arr_end);
-            unsigned idx = bm::sse4_gap_find(buf + start, (bm::gap_word_t)pos, size);
-            start += idx;
-
-            BM_ASSERT(buf[start] >= pos);
-            BM_ASSERT(buf[start - 1] < pos || (start == 1));
-            break;
-        }
-    }
-    
-    unsigned res = ((*buf) & 1) ^ ((--start) & 1);
-
     BM_ASSERT(res == bm::gap_test(buf, pos));
     return res;
 #else
@@ -1329,6 +1297,178 @@ template<typename T> int gapcmp(const T* buf1, const T* buf2)
 }
 
 
+#ifdef VECT_GAP_RANK
+
+/*!
+   \brief Checks if GAP buffers are long enough to use SIMD rank based
+   GAP-GAP operations (short buffers are faster to merge sequentially)
+   \internal
+   @ingroup gapfunc
+*/
+template<typename T>
+bool gap_rank_op_allowed(const T* BMRESTRICT vect1, const T* BMRESTRICT vect2)
+{
+    const unsigned len1 = unsigned(*vect1 >> 3);
+    const unsigned len2 = unsigned(*vect2 >> 3);
+    return (len1 + len2 >= 64) &&
+           (len1 < bm::gap_max_buff_len) && (len2 < bm::gap_max_buff_len);
+}
+
+/*!
+   \brief Truth table of a GAP functor, bit (v1 * 2 + v2) keeps f(v1, v2)
+   (lets rank based GAP operations evaluate functor without calls)
+   \internal
+   @ingroup gapfunc
+*/
+template<class F>
+unsigned gap_op_truth_table(F& f)
+{
+    return (f(0u, 0u) & 1) | ((f(0u, 1u) & 1) << 1) | 
+           ((f(1u, 0u) & 1) << 2) | ((f(1u, 1u) & 1) << 3);
+}
+
+/*!
+   \brief Evaluates GAP functor truth table (see gap_op_truth_table)
+   \internal
+   @ingroup gapfunc
+*/
+BMFORCEINLINE
+unsigned gap_op_eval(unsigned ft, unsigned v1, unsigned v2)
+{
+    return (ft >> (v1 * 2 + v2)) & 1;
+}
+
+/*!
+   \brief GAP operation using SIMD rank of run ends (see gap_buff_op).
+   Run ends of both operands are ranked against each other, every end is
+   flagged as a result boundary without branching and scattered
+   into the merge position (i + rank), then kept boundaries are compacted.
+   \internal
+   @ingroup gapfunc
+*/
+template<typename T, class F> 
+void gap_buff_op_rank(T*         BMRESTRICT dest, 
+                      const T*   BMRESTRICT vect1,
+                      unsigned   vect1_mask, 
+                      const T*   BMRESTRICT vect2,
+                      unsigned   vect2_mask, 
+                      F&         f,
+                      unsigned&  dlen)
+{
+    const T* BMRESTRICT a = vect1 + 1;
+    const T* BMRESTRICT b = vect2 + 1;
+    const unsigned a_len = unsigned(*vect1 >> 3);
+    const unsigned b_len = unsigned(*vect2 >> 3);
+
+    T rank_a[bm::gap_max_buff_len];
+    T rank_b[bm::gap_max_buff_len];
+    T merged[bm::gap_max_buff_len * 2];
+    unsigned char keep[bm::gap_max_buff_len * 2];
+
+    VECT_GAP_RANK(a, a_len, b, b_len, rank_a);
+    VECT_GAP_RANK(b, b_len, a, a_len, rank_b);
+
+    const unsigned a0 = (*vect1 & 1) ^ vect1_mask;
+    const unsigned b0 = (*vect2 & 1) ^ vect2_mask;
+    const unsigned ft = bm::gap_op_truth_table(f);
+
+    // boundary flags indexed by [(a value) * 4 + (b value) * 2 + tie]
+    unsigned char bound_a[8], bound_b[8];
+    for (unsigned v = 0; v < 8; ++v)
+    {
+        const unsigned va = v >> 2, vb = (v >> 1) & 1, tie = v & 1;
+        const unsigned r = bm::gap_op_eval(ft, va, vb);
+        bound_a[v] = (unsigned char)(r != bm::gap_op_eval(ft, va ^ 1, vb ^ tie));
+        bound_b[v] = (unsigned char)
+                        ((r != bm::gap_op_eval(ft, va, vb ^ 1)) & (tie ^ 1));
+    }
+
+    // final (gap_max_bits - 1) ends of both operands are not ranked
+    for (unsigned i = 0; i < a_len - 1; ++i)
+    {
+        const unsigned k = rank_a[i];
+        const unsigned tie = (b[k] == a[i]); // both runs end here
+        const unsigned v = (((a0 ^ i) & 1) << 2) | (((b0 ^ k) & 1) << 1) | tie;
+        merged[i + k] = a[i];
+        keep[i + k] = bound_a[v];
+    }
+    for (unsigned j = 0; j < b_len - 1; ++j)
+    {
+        const unsigned k = rank_b[j];
+        const unsigned tie = (a[k] == b[j]); // accounted as vect1 end
+        const unsigned v = (((a0 ^ k) & 1) << 2) | (((b0 ^ j) & 1) << 1) | tie;
+        merged[j + k + tie] = b[j];
+        keep[j + k + tie] = bound_b[v];
+    }
+
+    T* BMRESTRICT res = dest + 1;
+    const unsigned total = a_len + b_len - 2;
+    for (unsigned p = 0; p < total; ++p)
+    {
+        *res = merged[p];
+        res += keep[p];
+    }
+    *res = (T)(bm::gap_max_bits - 1);
+
+    dlen = unsigned(res - dest);
+    *dest = (T)(bm::gap_op_eval(ft, a0, b0) + (dlen << 3));
+}
+
+/*!
+   \brief GAP distance operation using SIMD rank of run ends
+   (see gap_buff_count_op). Bitcount of vect2 at every vect1 end is 
+   computed from vect2 prefix bitcounts, no sequential merge is needed.
+   \internal
+   @ingroup gapfunc
+*/
+template<typename T, class F> 
+unsigned gap_buff_count_op_rank(const T* BMRESTRICT vect1, 
+                                const T* BMRESTRICT vect2, 
+                                F f)
+{
+    const T* BMRESTRICT a = vect1 + 1;
+    const T* BMRESTRICT b = vect2 + 1;
+    const unsigned a_len = unsigned(*vect1 >> 3);
+    const unsigned b_len = unsigned(*vect2 >> 3);
+
+    T rank_a[bm::gap_max_buff_len];
+    unsigned cnt_b[bm::gap_max_buff_len + 1]; // vect2 bitcount [0..b[k-1]]
+    VECT_GAP_RANK(a, a_len, b, b_len, rank_a);
+
+    const unsigned a0 = *vect1 & 1;
+    const unsigned b0 = *vect2 & 1;
+    const unsigned ft = bm::gap_op_truth_table(f);
+
+    cnt_b[0] = 0;
+    for (unsigned k = 0, b_prev = 0; k < b_len; ++k)
+    {
+        cnt_b[k + 1] = cnt_b[k] + ((b0 ^ (k & 1)) * (b[k] + 1 - b_prev));
+        b_prev = unsigned(b[k]) + 1;
+    }
+
+    unsigned count = 0;
+    unsigned cnt_prev = 0; // vect2 bitcount [0..a[i-1]]
+    unsigned a_prev = 0;   // start of the current vect1 run
+    for (unsigned i = 0; i < a_len; ++i)
+    {
+        const unsigned k = rank_a[i];
+        const unsigned b_start = k ? unsigned(b[k - 1]) + 1 : 0u;
+        const unsigned bb = b0 ^ (k & 1);
+        const unsigned cnt = cnt_b[k] + bb * (unsigned(a[i]) + 1 - b_start);
+        const unsigned ones = cnt - cnt_prev;
+        const unsigned len = unsigned(a[i]) + 1 - a_prev;
+        const unsigned ba = a0 ^ (i & 1);
+        count += bm::gap_op_eval(ft, ba, 1u) * ones + 
+                 bm::gap_op_eval(ft, ba, 0u) * (len - ones);
+        cnt_prev = cnt;
+        a_prev = unsigned(a[i]) + 1;
+    }
+    return count;
+}
+
+#endif
+
+
 /*!
    \brief Abstract operation for GAP buffers. 
           Receives functor F as a template argument
@@ -1355,6 +1495,13 @@ void gap_buff_op(T*         BMRESTRICT dest,
                  F&         f,
                  unsigned&  dlen)
 {
+#ifdef VECT_GAP_RANK
+    if (bm::gap_rank_op_allowed(vect1, vect2))
+    {
+        bm::gap_buff_op_rank(dest, vect1, vect1_mask, vect2, vect2_mask, f, dlen);
+        return;
+    }
+#endif
     BMREGISTER const T*  cur1 = vect1;
     BMREGISTER const T*  cur2 = vect2;
 
@@ -1500,6 +1647,10 @@ unsigned gap_buff_any_op(const T*   BMRESTRICT vect1,
 template<typename T, class F> 
 unsigned gap_buff_count_op(const T*  vect1, const T*  vect2, F f)
 {
+#ifdef VECT_GAP_RANK
+    if (bm::gap_rank_op_allowed(vect1, vect2))
+        return bm::gap_buff_count_op_rank(vect1, vect2, f);
+#endif
     unsigned count;// = 0;
     const T* cur1 = vect1;
     const T* cur2 = vect2;
@@ -2620,6 +2771,29 @@ template<typename T>
 }
 
 
+/*!
+   \brief Checks if GAP block is well formed: GAP boundaries are 
+   strictly increasing and the last one closes the block
+   (validation of untrusted input, e.g. deserialized blocks)
+   \param buf - GAP buffer pointer.
+   \return true if GAP block is valid
+
+   @ingroup gapfunc
+*/
+template<typename T> bool gap_is_valid(const T* buf)
+{
+    const T* pend = buf + (*buf >> 3);
+    if (pend == buf || *pend != bm::gap_max_bits - 1)
+        return false;
+    for (const T* pcurr = buf + 2; pcurr <= pend; ++pcurr)
+    {
+        if (*pcurr <= *(pcurr-1))
+            return false;
+    }
+    return true;
+}
+
+
 /*!
    \brief Calculates sum of all words in GAP block. (For debugging purposes)
    \note For debugging and testing ONLY.
@@ -3380,6 +3554,9 @@ bm::id_t bit_block_calc_count_range(const bm::word_t* block,
                                     bm::word_t right)
 {
     BM_ASSERT(left <= right);
+#if defined(VECT_BIT_COUNT_RANGE)
+    return VECT_BIT_COUNT_RANGE(block, left, right);
+#else
     unsigned nword, nbit;    
     nbit = left & bm::set_word_mask;
     const bm::word_t* word = 
@@ -3430,6 +3607,7 @@ bm::id_t bit_block_calc_count_range(const bm::word_t* block,
     }
 
     return count;
+#endif
 }
 
 /*!
@@ -3444,40 +3622,24 @@ bm::id_t bit_block_calc_count_to(const bm::word_t*  block,
                                  bm::word_t         right)
 {
     BM_ASSERT(block);
+#if defined(VECT_BIT_COUNT_RANGE)
+    return VECT_BIT_COUNT_RANGE(block, 0, right);
+#else
     if (right == 0)
         return *block & 1;
     bm::id_t count = 0;
 
     unsigned bitcount = right + 1;
 
-    // AVX2 or 64-bit loop unroll
-    #if defined(BMAVX2OPT)
-        BM_AVX2_POPCNT_PROLOG
-    
-        __m256i cnt = _mm256_setzero_si256();
-        bm::id64_t* cnt64;
-    
-        for ( ;bitcount >= 256; bitcount -= 256)
-        {
-            const __m256i* src = (__m256i*)block;
-            __m256i xmm256 = _mm256_load_si256(src);
-            BM_AVX2_BIT_COUNT(bc, xmm256);
-            cnt = _mm256_add_epi64(cnt, bc);
-
-            block += 8;
-        }
-        cnt64 = (bm::id64_t*)&cnt;
-        count += (unsigned)(cnt64[0] + cnt64[1] + cnt64[2] + cnt64[3]);
-    #else
-        for ( ;bitcount >= 64; bitcount -= 64)
-        {
-            bm::id64_t* p = (bm::id64_t*)block;
-            bm::id64_t a64 = *p;
-            
-            count += bm::word_bitcount64(a64);
-            block += 2;
-        }
-    #endif
+    // 64-bit loop unroll
+    for ( ;bitcount >= 64; bitcount -= 64)
+    {
+        bm::id64_t* p = (bm::id64_t*)block;
+        bm::id64_t a64 = *p;
+        
+        count += bm::word_bitcount64(a64);
+        block += 2;
+    }
 
     // now word aligned, count bits the usual way
     for ( ;bitcount >= 32; bitcount -= 32)
@@ -3493,6 +3655,7 @@ bm::id_t bit_block_calc_count_to(const bm::word_t*  block,
     }
 
     return count;
+#endif
 }
 
 
@@ -4082,6 +4245,9 @@ unsigned bit_block_and_any(const bm::word_t* src1,
                            const bm::word_t* src1_end,
                            const bm::word_t* src2)
 {
+#ifdef VECT_AND_BLOCK_ANY
+    return VECT_AND_BLOCK_ANY(src1, src1_end, src2);
+#else
     unsigned count = 0;
     do
     {
@@ -4093,6 +4259,61 @@ unsigned bit_block_and_any(const bm::word_t* src1,
         src1+=4; src2+=4;
     } while ((src1 < src1_end) && (count == 0));
     return count;
+#endif
+}
+
+
+/*!
+   \brief Function ANDs two bitblocks and computes the bitcount 
+   up to the limit. Scan stops as soon as the limit is reached.
+   Function does not analyse availability of source blocks.
+
+   \param src1     - first bit block
+   \param src1_end - first bit block end
+   \param src2     - second bit block
+   \param limit    - count limit
+
+   \returns bitcount (exact if less than limit, otherwise >= limit)
+
+   @ingroup bitfunc
+*/
+inline 
+unsigned bit_block_and_count_limit(const bm::word_t* src1, 
+                                   const bm::word_t* src1_end,
+                                   const bm::word_t* src2,
+                                   unsigned          limit)
+{
+#ifdef VECT_BITCOUNT_AND_LIMIT
+    return VECT_BITCOUNT_AND_LIMIT(src1, src1_end, src2, limit);
+#else
+    unsigned count = 0;
+# ifdef BM64OPT
+    const bm::id64_t* b1 = (bm::id64_t*) src1;
+    const bm::id64_t* b1_end = (bm::id64_t*) src1_end;
+    const bm::id64_t* b2 = (bm::id64_t*) src2;
+    do
+    {
+        count += bitcount64_4way(b1[0] & b2[0], 
+                                 b1[1] & b2[1], 
+                                 b1[2] & b2[2], 
+                                 b1[3] & b2[3]);
+        b1 += 4;
+        b2 += 4;
+    } while ((b1 < b1_end) && (count < limit));
+# else
+    do
+    {
+        BM_INCWORD_BITCOUNT(count, src1[0] & src2[0]);
+        BM_INCWORD_BITCOUNT(count, src1[1] & src2[1]);
+        BM_INCWORD_BITCOUNT(count, src1[2] & src2[2]);
+        BM_INCWORD_BITCOUNT(count, src1[3] & src2[3]);
+
+        src1+=4;
+        src2+=4;
+    } while ((src1 < src1_end) && (count < limit));
+# endif
+    return count;
+#endif
 }
 
 
@@ -4455,6 +4676,32 @@ bm::id_t bit_operation_and_any(const bm::word_t* BMRESTRICT src1,
     return bit_block_and_any(src1, src1_end, src2);
 }
 
+/*!
+   \brief Performs bitblock AND operation and calculates bitcount 
+   of the result up to the limit.
+
+   \param src1     - first bit block.
+   \param src1_end - first bit block end
+   \param src2     - second bit block.
+   \param limit    - count limit
+
+   \returns bitcount value (exact if less than limit, otherwise >= limit)
+
+   @ingroup bitfunc
+*/
+inline 
+bm::id_t bit_operation_and_count_limit(const bm::word_t* BMRESTRICT src1,
+                                       const bm::word_t* BMRESTRICT src1_end,
+                                       const bm::word_t* BMRESTRICT src2,
+                                       bm::id_t                     limit)
+{
+    if (IS_EMPTY_BLOCK(src1) || IS_EMPTY_BLOCK(src2))
+    {
+        return 0;
+    }
+    return bit_block_and_count_limit(src1, src1_end, src2, limit);
+}
+
 
 
 /*!
@@ -4994,6 +5241,32 @@ unsigned bit_count_nonzero_size(const T*     blk,
     return count + unsigned(2 * sizeof(T));
 }
 
+/**
+    \brief Computes CRC32C (Castagnoli) checksum of a memory buffer
+
+    Uses SSE4.2 crc32 instructions when available (BMSSE42OPT, BMAVX2OPT).
+
+    \param buf - data buffer
+    \param len - buffer length in bytes
+    \param crc - CRC32C of the previous data chunk (0 - start new checksum)
+
+    \return CRC32C
+
+    @ingroup bitfunc
+*/
+inline
+unsigned crc32c(const unsigned char* buf, size_t len, unsigned crc = 0)
+{
+#ifdef VECT_CRC32C
+    return VECT_CRC32C(buf, len, crc);
+#else
+    unsigned c = ~crc;
+    for (; len; --len)
+        c = bm::crc32c_table<true>::_crc[(c ^ *buf++) & 0xFF] ^ (c >> 8);
+    return ~c;
+#endif
+}
+
 
 /**
     \brief Searches for the next 1 bit in the BIT block
@@ -5008,6 +5281,18 @@ int bit_find_in_block(const bm::word_t* data,
                       unsigned          nbit, 
                       bm::id_t*         prev)
 {
+#if defined(VECT_BIT_FIND_FIRST)
+    unsigned pos;
+    if (nbit >= bm::gap_max_bits)
+        return 0;
+    if (!VECT_BIT_FIND_FIRST(data, nbit, &pos))
+    {
+        *prev += bm::gap_max_bits - nbit; // next block, as the scalar scan
+        return 0;
+    }
+    *prev += pos - nbit;
+    return 1;
+#else
     BMREGISTER bm::id_t p = *prev;
     int found = 0;
 
@@ -5037,6 +5322,7 @@ int bit_find_in_block(const bm::word_t* data,
     }
     *prev = p;
     return found;
+#endif
 }
 
 /*!
@@ -5083,7 +5369,9 @@ unsigned bit_find_first(const bm::word_t* block, unsigned* first)
 {
     BM_ASSERT(block);
     BM_ASSERT(first);
-
+#if defined(VECT_BIT_FIND_FIRST)
+    return VECT_BIT_FIND_FIRST(block, 0, first);
+#else
     for (unsigned i = 0; i < bm::set_block_size; ++i)
     {
         bm::word_t w = block[i];
@@ -5095,6 +5383,7 @@ unsigned bit_find_first(const bm::word_t* block, unsigned* first)
         }
     } // for i
     return 0u;
+#endif
 }
 
 
@@ -5300,6 +5589,15 @@ unsigned short bitscan_popcnt64(bm::id64_t w, B* bits)
 template<typename V, typename B>
 unsigned short bitscan(V w, B* bits)
 {
+#if defined(VECT_BITSCAN64)
+    // SIMD expansion writes tails in 8 (or 16) byte units,
+    // which fits into (sizeof(V) * 8) array for V of 16-bit and wider
+    if (bm::conditional<sizeof(B) == 1 && sizeof(V) >= 2>::test())
+    {
+        bm::id64_t w64 = bm::id64_t(w) & (~0ULL >> (64 - sizeof(V) * 8));
+        return (unsigned short) VECT_BITSCAN64(w64, (unsigned char*)bits);
+    }
+#endif
     if (bm::conditional<sizeof(V) == 8>::test())
     {
         return bm::bitscan_popcnt64(w, bits);
@@ -5387,6 +5685,14 @@ template<typename T> T bit_convert_to_arr(T* BMRESTRICT dest,
         {
             return 0;
         }
+#if defined(VECT_BIT_TO_ARR16)
+        if (bm::conditional<sizeof(T) == 2>::test())
+        {
+            // 16-bit indexes are decoded directly (space for 32 is checked)
+            pcurr += VECT_BIT_TO_ARR16(val, (bm::gap_word_t*)pcurr, bit_idx);
+            continue;
+        }
+#endif
         unsigned char b_list[64];
         unsigned word_bit_cnt  = bm::bitscan_popcnt(val, b_list);
         for (unsigned j = 0; j < word_bit_cnt; ++j)
@@ -5895,7 +6201,11 @@ unsigned short bitscan_wave(const bm::word_t* w_ptr, unsigned char* bits)
     w0 = w_ptr[0];
     w1 = w_ptr[1];
     
-#if defined(BMAVX2OPT) || defined(BMSSE42OPT)
+#if defined(VECT_BITSCAN64)
+    // combine into 64-bit word and decode with table driven SIMD expansion
+    bm::id64_t w = (bm::id64_t(w1) << 32) | w0;
+    cnt0 = (unsigned short) VECT_BITSCAN64(w, bits);
+#elif defined(BMAVX2OPT) || defined(BMSSE42OPT)
     // combine into 64-bit word and scan (when HW popcnt64 is available)
     bm::id64_t w = (bm::id64_t(w1) << 32) | w0;
     cnt0 = (unsigned short) bm::bitscan_popcnt64(w, bits);
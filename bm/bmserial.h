@@ -35,6 +35,10 @@ For more information please visit:  http://bitmagic.io
 
 #endif
 
+#ifndef BM_NO_STL
+#include <stdexcept>
+#endif
+
 #ifdef _MSC_VER
 #pragma warning( push )
 #pragma warning( disable : 4311 4312 4127)
@@ -85,6 +89,17 @@ const unsigned char set_block_arrgap_egamma     = 21; //!< Gamma compressed delt
 const unsigned char set_block_bit_0runs         = 22; //!< Bit block with encoded zero intervals
 const unsigned char set_block_arrgap_egamma_inv = 23; //!< Gamma compressed inverted delta GAP array
 const unsigned char set_block_arrgap_inv        = 24;  //!< List of bits OFF (GAP block)
+const unsigned char set_block_ref_eq            = 25;  //!< Block identical to the reference vector block
+const unsigned char set_block_xor_ref           = 26;  //!< Block XOR-ed with the reference vector block
+const unsigned char set_block_crc32c            = 27;  //!< CRC32C checkpoint of the next stream chunk
+const unsigned char set_block_gap_svb           = 28;  //!< GAP block, Stream VByte coded d-gaps
+const unsigned char set_block_arrgap_svb        = 29;  //!< List of bits ON, Stream VByte coded d-gaps
+const unsigned char set_block_arrgap_svb_inv    = 30;  //!< List of bits OFF, Stream VByte coded d-gaps
+const unsigned char set_block_gap_bienc         = 31;  //!< GAP block, Binary Interpolative coded
+const unsigned char set_block_arrgap_bienc      = 32;  //!< List of bits ON, Binary Interpolative coded
+const unsigned char set_block_arrgap_bienc_inv  = 33;  //!< List of bits OFF, Binary Interpolative coded
+
+const unsigned set_crc32c_chunk_size = 16 * 1024; //!< Stream bytes between CRC32C checkpoints
 
 
 /// \internal
@@ -94,9 +109,57 @@ enum serialization_header_mask {
     BM_HM_RESIZE  = (1 << 1), ///< resized vector
     BM_HM_ID_LIST = (1 << 2), ///< id list stored
     BM_HM_NO_BO   = (1 << 3), ///< no byte-order
-    BM_HM_NO_GAPL = (1 << 4)  ///< no GAP levels
+    BM_HM_NO_GAPL = (1 << 4), ///< no GAP levels
+    BM_HM_REF     = (1 << 5), ///< serialized against a reference vector
+    BM_HM_CRC     = (1 << 6)  ///< CRC32C checkpoints
 };
 
+/**
+    \brief Reports XOR/reference compressed BLOB deserialized 
+    without the reference vector
+    (std::logic_error or BM_ERR_BADARG in STL-free mode)
+    \internal
+    \ingroup bvserial 
+*/
+inline void throw_serial_ref_error()
+{
+#ifndef BM_NO_STL
+    throw std::logic_error("BM: reference vector required for deserialization");
+#else
+    BM_ASSERT_THROW(false, BM_ERR_BADARG);
+#endif
+}
+
+/**
+    \brief Reports CRC32C verification failure (corrupted BLOB)
+    (std::logic_error or BM_ERR_CRC in STL-free mode)
+    \internal
+    \ingroup bvserial 
+*/
+inline void throw_serial_crc_error()
+{
+#ifndef BM_NO_STL
+    throw std::logic_error("BM: CRC32C mismatch, serialized BLOB is corrupted");
+#else
+    BM_ASSERT_THROW(false, BM_ERR_CRC);
+#endif
+}
+
+/**
+    \brief Reports block encoding out of the block bounds (corrupted BLOB)
+    (std::logic_error or BM_ERR_BADARG in STL-free mode)
+    \internal
+    \ingroup bvserial 
+*/
+inline void throw_serial_format_error()
+{
+#ifndef BM_NO_STL
+    throw std::logic_error("BM: serialized BLOB format error");
+#else
+    BM_ASSERT_THROW(false, BM_ERR_BADARG);
+#endif
+}
+
 
 
 #define SER_NEXT_GRP(enc, nb, B_1ZERO, B_8ZERO, B_16ZERO, B_32ZERO) \
@@ -173,7 +236,11 @@ public:
 
     /**
         Set compression level. Higher compression takes more time to process.
-        @param clevel - compression level (0-4)
+        Level 4 uses bit-serial Elias Gamma for GAP and array blocks,
+        level 5 adds Binary Interpolative coding (used when it wins,
+        best for clustered sparse ids, cold storage).
+        @param clevel - compression level (0-5)
+        @sa svb_serialization
     */
     void set_compression_level(unsigned clevel);
 
@@ -209,6 +276,21 @@ public:
     */
     void serialize(const BV& bv, typename serializer<BV>::buffer& buf, const statistics_type* bv_stat);
 
+    /**
+        Computes exact size of the serialization BLOB without producing it.
+        
+        Runs the block encoders of serialize() in a dry-run mode
+        (no output is written), so the result accounts for all current
+        settings: compression level, reference vector and CRC32C.
+        The cost is close to serialize() (block encoding dominates,
+        only the writes are skipped), use it when the exact size is
+        needed before the output buffer is allocated.
+        
+        @param bv - input bitvector
+        @return size of serialization block (same as serialize() returns)
+    */
+    size_t estimate_serialized_size(const BV& bv);
+
     
     /**
         Set GAP length serialization (serializes GAP levels of the original vector)
@@ -223,53 +305,137 @@ public:
     */
     void byte_order_serialization(bool value);
 
+    /**
+        Set reference vector for XOR/reference compression.
+        
+        Blocks identical to the blocks of the reference vector are saved 
+        as references, other blocks are saved as XOR difference 
+        with the reference block if it gives a shorter encoding.
+        The same reference vector must be used for deserialization.
+        
+        @param bv_ref - reference vector (NULL - no reference compression)
+    */
+    void set_ref_vector(const BV* bv_ref);
+
+    /**
+        Set CRC32C checksum serialization. 
+        Serialized stream is split into 16KB chunks, each chunk is preceded 
+        by a checkpoint (chunk length and CRC32C), so deserialization 
+        verifies a chunk before decoding it.
+        
+        @param value - TRUE serialization format includes CRC32C checkpoints
+    */
+    void crc32c_serialization(bool value);
+
+    /**
+        Set Stream VByte serialization of GAP and array blocks.
+        Blocks are coded as byte aligned d-gaps (fast SIMD decoding) 
+        instead of the bit-serial codes of compression levels 4-5. 
+        Takes effect for compression level 3 and up.
+        
+        @param value - TRUE to use Stream VByte coded blocks
+    */
+    void svb_serialization(bool value);
+
 protected:
     /**
         Encode serialization header information
     */
-    void encode_header(const BV& bv, bm::encoder& enc);
+    template<class Enc>
+    void encode_header(const BV& bv, Enc& enc);
+
+    /**
+        Encode all blocks of the vector (and the end of stream token)
+        @param crc_pos - stream start position (for CRC32C checkpoints)
+    */
+    template<class Enc>
+    void encode_blocks(const BV& bv, Enc& enc,
+                       typename Enc::position_type crc_pos);
     
     /**
         Encode GAP block
     */
-    void encode_gap_block(bm::gap_word_t* gap_block, bm::encoder& enc);
+    template<class Enc>
+    void encode_gap_block(bm::gap_word_t* gap_block, Enc& enc);
 
     /**
         Encode GAP block with Elias Gamma coder
     */
-    void gamma_gap_block(bm::gap_word_t* gap_block, bm::encoder& enc);
+    template<class Enc>
+    void gamma_gap_block(bm::gap_word_t* gap_block, Enc& enc);
 
     /**
         Encode GAP block as delta-array with Elias Gamma coder
     */
+    template<class Enc>
     void gamma_gap_array(const bm::gap_word_t* gap_block, 
                          unsigned              arr_len, 
-                         bm::encoder&          enc,
+                         Enc&                  enc,
                          bool                  inverted = false);
 
     /**
         Encode BIT block with repeatable runs of zeroes
     */
+    template<class Enc>
     void encode_bit_interval(const bm::word_t* blk, 
-                             bm::encoder&      enc,
+                             Enc&              enc,
                              unsigned          size_control);
 
+    /**
+        Encode BIT block (choose the best representation)
+        @return false if block is empty and nothing was encoded
+    */
+    template<class Enc>
+    bool encode_bit_block(const bm::word_t* blk, Enc& enc);
+
+    /**
+        Encode block as a reference or XOR difference with the 
+        reference vector block
+        @return false if block needs to be encoded as is
+    */
+    template<class Enc>
+    bool encode_ref_block(const bm::word_t* blk,
+                          unsigned          nb,
+                          Enc&              enc);
+
+    /**
+        Reserve CRC32C checkpoint for the stream chunk to follow
+        @return checkpoint position
+    */
+    template<class Enc>
+    typename Enc::position_type begin_crc32c_chunk(Enc& enc);
+
+    /**
+        Close the stream chunk: save its length and CRC32C 
+        (of the stream since the previous chunk) into the checkpoint
+    */
+    void end_crc32c_chunk(bm::encoder&   enc, 
+                          unsigned char* chk_pos, 
+                          unsigned char*& crc_pos);
+
+    /**
+        Close the stream chunk (dry run)
+    */
+    void end_crc32c_chunk(bm::encoder_size_counter& enc, 
+                          size_t                    chk_pos, 
+                          size_t&                   crc_pos);
+
 private:
     serializer(const serializer&);
     serializer& operator=(const serializer&);
 
-private:
-
-    typedef bm::bit_out<bm::encoder>  bit_out_type;
-    typedef bm::gamma_encoder<bm::gap_word_t, bit_out_type> gamma_encoder_func;
-
 private:
     allocator_type alloc_;
     bool           gap_serial_;
     bool           byte_order_serial_;
+    bool           crc_serial_;
+    bool           svb_serial_;
     bm::word_t*    temp_block_;
     unsigned       compression_level_;
     bool           own_temp_block_;
+    const BV*      ref_bv_;          ///< reference vector
+    bm::word_t*    xor_block_;       ///< XOR difference block
+    unsigned char* xor_enc_buf_;     ///< XOR block encoding buffer
 };
 
 /**
@@ -297,6 +463,22 @@ protected:
                           unsigned        block_type, 
                           bm::gap_word_t* dst_arr);
 
+    /// Read and validate length of the id list 
+    /// (format error if it does not fit the block)
+    gap_word_t read_id_list_len(decoder_type& decoder, unsigned min_len);
+
+    /// Read CRC32C checkpoint and verify the stream chunk ahead of it
+    /// (before any block of the chunk is decoded)
+    ///
+    /// @param crc_pos - end of the previous chunk (stream start), 
+    ///                  gets the end of the verified chunk
+    /// @param buf_end - end of the BLOB (0 if unknown), chunk 
+    ///                  running past it is rejected without reading it
+    /// @return true if stream checksum is correct
+    bool read_crc32c(decoder_type&         decoder,
+                     const unsigned char*& crc_pos,
+                     const unsigned char*  buf_end);
+
 protected:
     bm::gap_word_t   id_array_[bm::gap_equiv_len * 2];
 };
@@ -312,11 +494,25 @@ public:
     typedef BV bvector_type;
     typedef typename deseriaizer_base<DEC>::decoder_type decoder_type;
 public:
-    deserializer() : temp_block_(0) {}
+    deserializer() : temp_block_(0), ref_bv_(0), buf_size_(0) {}
     
     unsigned deserialize(bvector_type&        bv, 
                          const unsigned char* buf, 
                          bm::word_t*          temp_block);
+
+    /**
+        Set reference vector used for serialization 
+        (needed for XOR/reference compressed BLOBs)
+        @sa serializer::set_ref_vector
+    */
+    void set_ref_vector(const bvector_type* bv_ref) { ref_bv_ = bv_ref; }
+
+    /**
+        Set size of the source buffer (0 - unknown, default).
+        CRC32C chunks of a truncated BLOB are then rejected
+        without reading past the buffer.
+    */
+    void set_buf_size(size_t buf_size) { buf_size_ = buf_size; }
 protected:
    typedef typename BV::blocks_manager_type blocks_manager_type;
    typedef typename BV::allocator_type allocator_type;
@@ -326,9 +522,20 @@ protected:
                         bvector_type&  bv, blocks_manager_type& bman,
                         unsigned i,
                         bm::word_t* blk);
+
+   /// decode bit block encoding (bit, interval, GAP or array) into bit block
+   void decode_bit_block(unsigned char btype, decoder_type& dec,
+                         bm::word_t* dst_block);
+
+   /// deserialize reference or XOR block (using the reference vector)
+   void deserialize_ref(unsigned char btype, decoder_type& dec,
+                        bvector_type&  bv,
+                        unsigned i);
 protected:
-    bm::gap_word_t   gap_temp_block_[bm::gap_equiv_len * 4];
-    bm::word_t*      temp_block_;
+    bm::gap_word_t      gap_temp_block_[bm::gap_equiv_len * 4];
+    bm::word_t*         temp_block_;
+    const bvector_type* ref_bv_;  ///< reference vector
+    size_t              buf_size_; ///< source buffer size (0 - unknown)
 };
 
 
@@ -362,6 +569,15 @@ public:
                      bm::word_t*           temp_block,
                      set_operation         op);
 
+    /// const COUNT_AND of a vector and BLOB, bv is never modified;
+    /// scan stops after block nb_last (last non-empty block of bv)
+    ///
+    static
+    unsigned count_and(const bvector_type&   bv,
+                       serial_iterator_type& sit,
+                       bm::word_t*           temp_block,
+                       unsigned              nb_last);
+
 private:
     typedef typename BV::blocks_manager_type blocks_manager_type;
 
@@ -410,6 +626,9 @@ public:
     /// get next block
     void next();
 
+    /// Returns true if CRC32C check failed (corrupted stream)
+    bool is_crc_error() const { return crc_error_; }
+
 	/// skip all zero or all-one blocks
 	void skip_mono_blocks();
 
@@ -422,6 +641,11 @@ public:
     /// Read gap block data (with head)
     void get_gap_block(bm::gap_word_t* dst_block);
 
+    /// Skip gap block (seek the stream without decoding 
+    /// if block encoding is not bit-serial)
+    /// @param tmp_block - scratch GAP block for bit-serial codes
+    void skip_gap_block(bm::gap_word_t* tmp_block);
+
     /// Return current decoder size
     unsigned dec_size() const { return decoder_.size(); }
 
@@ -520,6 +744,10 @@ protected:
     unsigned           mono_block_cnt_; ///< number of 0 or 1 blocks
 
     gap_word_t         gap_head_;
+
+    const unsigned char* crc_pos_;   ///< end of the last verified chunk
+    const unsigned char* crc_end_;   ///< next CRC32C checkpoint position
+    bool                 crc_error_; ///< CRC32C mismatch detected
 };
 
 /**
@@ -554,6 +782,32 @@ public:
                          set_operation        op = bm::set_OR,
                          bool                 exit_on_one = false ///<! exit early if any one are found
                          );
+
+    /**
+    \brief Batch COUNT_AND of one query vector against many serialized BLOBs
+    
+    Computes counts[i] = |bv_query AND bufs[i]| decoding every BLOB 
+    block by block against the query. Query vector stays const 
+    (its GAP blocks are never deoptimized), blocks absent in the query
+    are skipped in the input stream without decoding and the scan of each 
+    BLOB stops after the last non-empty block of the query.
+    
+    Function does not modify any shared state, so disjoint ranges of BLOBs
+    can be counted from several threads against the same query,
+    as long as each thread uses its own temp_block.
+    
+    \param bv_query - query vector
+    \param bufs - array of serialized BLOBs (XOR/reference BLOBs not supported)
+    \param buf_count - number of BLOBs
+    \param counts - [out] array of buf_count results
+    \param temp_block - temporary block to avoid re-allocations
+    */
+    static
+    void count_and_batch(const bvector_type&          bv_query,
+                         const unsigned char* const*  bufs,
+                         size_t                       buf_count,
+                         bm::id_t*                    counts,
+                         bm::word_t*                  temp_block = 0);
 private:
     /** experimental 3-way deserializator TARGET = MASK (OR/AND/XOR) BUF
     \param bv_target - target bvector
@@ -593,7 +847,12 @@ serializer<BV>::serializer(const allocator_type&   alloc,
 : alloc_(alloc),
   gap_serial_(false),
   byte_order_serial_(true),
-  compression_level_(4)
+  crc_serial_(false),
+  svb_serial_(false),
+  compression_level_(4),
+  ref_bv_(0),
+  xor_block_(0),
+  xor_enc_buf_(0)
 {
     if (temp_block == 0)
     {
@@ -612,7 +871,12 @@ serializer<BV>::serializer(bm::word_t*    temp_block)
 : alloc_(allocator_type()),
   gap_serial_(false),
   byte_order_serial_(true),
-  compression_level_(4)
+  crc_serial_(false),
+  svb_serial_(false),
+  compression_level_(4),
+  ref_bv_(0),
+  xor_block_(0),
+  xor_enc_buf_(0)
 {
     if (temp_block == 0)
     {
@@ -644,6 +908,11 @@ serializer<BV>::~serializer()
 {
     if (own_temp_block_)
         alloc_.free_bit_block(temp_block_);
+    if (xor_block_)
+    {
+        alloc_.free_bit_block(xor_block_);
+        alloc_.free_bit_block((bm::word_t*)xor_enc_buf_, 2);
+    }
 }
 
 
@@ -660,7 +929,30 @@ void serializer<BV>::byte_order_serialization(bool value)
 }
 
 template<class BV>
-void serializer<BV>::encode_header(const BV& bv, bm::encoder& enc)
+void serializer<BV>::crc32c_serialization(bool value)
+{
+    crc_serial_ = value;
+}
+
+template<class BV>
+void serializer<BV>::svb_serialization(bool value)
+{
+    svb_serial_ = value;
+}
+
+template<class BV>
+void serializer<BV>::set_ref_vector(const BV* bv_ref)
+{
+    ref_bv_ = bv_ref;
+    if (ref_bv_ && !xor_block_)
+    {
+        xor_block_ = alloc_.alloc_bit_block();
+        xor_enc_buf_ = (unsigned char*)alloc_.alloc_bit_block(2);
+    }
+}
+
+template<class BV> template<class Enc>
+void serializer<BV>::encode_header(const BV& bv, Enc& enc)
 {
     const blocks_manager_type& bman = bv.get_blocks_manager();
 
@@ -676,6 +968,12 @@ void serializer<BV>::encode_header(const BV& bv, bm::encoder& enc)
     if (!gap_serial_) 
         header_flag |= BM_HM_NO_GAPL;
 
+    if (ref_bv_)
+        header_flag |= BM_HM_REF;
+
+    if (crc_serial_)
+        header_flag |= BM_HM_CRC;
+
     enc.put_8(header_flag);
 
     if (byte_order_serial_)
@@ -698,18 +996,61 @@ void serializer<BV>::encode_header(const BV& bv, bm::encoder& enc)
     
 }
 
-template<class BV>
-void serializer<BV>::gamma_gap_block(bm::gap_word_t* gap_block, bm::encoder& enc)
+template<class BV> template<class Enc>
+void serializer<BV>::gamma_gap_block(bm::gap_word_t* gap_block, Enc& enc)
 {
     unsigned len = gap_length(gap_block);
 
+    // Use Stream VByte d-gaps (byte aligned, fast to decode)
+    if (len > 6 && svb_serial_ && (compression_level_ > 2))
+    {
+        unsigned svb_size = bm::svb16_dgap_size(gap_block + 1, len - 2);
+        if (svb_size < (len-2)*sizeof(gap_word_t))
+        {
+            enc.put_8(set_block_gap_svb);
+            enc.put_16(gap_block[0]);
+            enc.put_svb16_dgap(gap_block + 1, len - 2);
+            return;
+        }
+    }
+
+    // Use Binary Interpolative coding if it is better than Elias Gamma
+    if (len > 6 && (compression_level_ > 4))
+    {
+        unsigned n = len - 2; // number of GAP boundaries to save
+        bm::bit_out_counter bic_cnt;
+        bm::bic_encode_u16(bic_cnt, gap_block + 2, n - 2, 
+                           gap_block[1] + 1u, gap_block[n] - 1u);
+        unsigned bic_size = 
+            1 + unsigned(3 * sizeof(gap_word_t)) + bic_cnt.size();
+
+        bm::gamma_size_counter<gap_word_t> gsize;
+        bm::for_each_dgap(gap_block, gsize);
+        unsigned gamma_size = 1 + unsigned(sizeof(gap_word_t)) + gsize.size();
+        unsigned plain_size = unsigned((len-1) * sizeof(gap_word_t));
+        if (gamma_size > plain_size)
+            gamma_size = 1 + plain_size;
+
+        if (bic_size < gamma_size)
+        {
+            enc.put_8(set_block_gap_bienc);
+            enc.put_16(gap_block[0]);
+            enc.put_16(gap_block[1]);
+            enc.put_16(gap_block[n]);
+            bm::bit_out<Enc> bout(enc);
+            bm::bic_encode_u16(bout, gap_block + 2, n - 2, 
+                               gap_block[1] + 1u, gap_block[n] - 1u);
+            return;
+        }
+    }
+
     // Use Elias Gamma encoding 
     if (len > 6 && (compression_level_ > 3)) 
     {
-        encoder::position_type enc_pos0 = enc.get_pos();
+        typename Enc::position_type enc_pos0 = enc.get_pos();
         {
-            bit_out_type bout(enc);
-            gamma_encoder_func gamma(bout);
+            bm::bit_out<Enc> bout(enc);
+            bm::gamma_encoder<bm::gap_word_t, bm::bit_out<Enc> > gamma(bout);
 
             enc.put_8(set_block_gap_egamma);		
             enc.put_16(gap_block[0]);
@@ -718,7 +1059,7 @@ void serializer<BV>::gamma_gap_block(bm::gap_word_t* gap_block, bm::encoder& enc
         }
 
         // evaluate gamma coding efficiency
-        encoder::position_type enc_pos1 = enc.get_pos();
+        typename Enc::position_type enc_pos1 = enc.get_pos();
         unsigned gamma_size = (unsigned)(enc_pos1 - enc_pos0);        
         if (gamma_size > (len-1)*sizeof(gap_word_t))
         {
@@ -735,17 +1076,67 @@ void serializer<BV>::gamma_gap_block(bm::gap_word_t* gap_block, bm::encoder& enc
     enc.put_16(gap_block, len-1);
 }
 
-template<class BV>
+template<class BV> template<class Enc>
 void serializer<BV>::gamma_gap_array(const bm::gap_word_t* gap_array, 
                                      unsigned              arr_len, 
-                                     bm::encoder&          enc,
+                                     Enc&                  enc,
                                      bool                  inverted)
 {
+    if (svb_serial_ && compression_level_ > 2 && arr_len > 8)
+    {
+        unsigned svb_size = bm::svb16_dgap_size(gap_array, arr_len);
+        if (svb_size < arr_len*sizeof(gap_word_t))
+        {
+            enc.put_8(inverted ? set_block_arrgap_svb_inv 
+                               : set_block_arrgap_svb);
+            enc.put_16((gap_word_t)arr_len);
+            enc.put_svb16_dgap(gap_array, arr_len);
+            return;
+        }
+    }
+
+    // Use Binary Interpolative coding if it is better than Elias Gamma
+    if (compression_level_ > 4 && arr_len > 2)
+    {
+        bm::bit_out_counter bic_cnt;
+        bm::bic_encode_u16(bic_cnt, gap_array + 1, arr_len - 2, 
+                           gap_array[0] + 1u, gap_array[arr_len-1] - 1u);
+        unsigned bic_size = 
+            1 + unsigned(3 * sizeof(gap_word_t)) + bic_cnt.size();
+
+        unsigned plain_size = unsigned(arr_len * sizeof(gap_word_t));
+        unsigned best_size = 1 + unsigned(sizeof(gap_word_t)) + plain_size;
+        if (arr_len > 25)
+        {
+            bm::gamma_size_counter<unsigned> gsize;
+            gsize(arr_len);
+            gsize(gap_array[0] + 1u);
+            for (unsigned i = 1; i < arr_len; ++i)
+                gsize(unsigned(gap_array[i] - gap_array[i-1]));
+            unsigned gamma_size = 1 + gsize.size();
+            if (gamma_size <= plain_size)
+                best_size = gamma_size;
+        }
+
+        if (bic_size < best_size)
+        {
+            enc.put_8(inverted ? set_block_arrgap_bienc_inv 
+                               : set_block_arrgap_bienc);
+            enc.put_16((gap_word_t)arr_len);
+            enc.put_16(gap_array[0]);
+            enc.put_16(gap_array[arr_len-1]);
+            bm::bit_out<Enc> bout(enc);
+            bm::bic_encode_u16(bout, gap_array + 1, arr_len - 2, 
+                               gap_array[0] + 1u, gap_array[arr_len-1] - 1u);
+            return;
+        }
+    }
+
     if (compression_level_ > 3 && arr_len > 25)
     {        
-        encoder::position_type enc_pos0 = enc.get_pos();
+        typename Enc::position_type enc_pos0 = enc.get_pos();
         {
-            bit_out_type bout(enc);
+            bm::bit_out<Enc> bout(enc);
 
             enc.put_8(
                 inverted ? set_block_arrgap_egamma_inv 
@@ -764,7 +1155,7 @@ void serializer<BV>::gamma_gap_array(const bm::gap_word_t* gap_array,
             }
         }
 
-        encoder::position_type enc_pos1 = enc.get_pos();
+        typename Enc::position_type enc_pos1 = enc.get_pos();
         unsigned gamma_size = (unsigned)(enc_pos1 - enc_pos0);            
         if (gamma_size > (arr_len)*sizeof(gap_word_t))
         {
@@ -782,8 +1173,8 @@ void serializer<BV>::gamma_gap_array(const bm::gap_word_t* gap_array,
 }
 
 
-template<class BV>
-void serializer<BV>::encode_gap_block(bm::gap_word_t* gap_block, bm::encoder& enc)
+template<class BV> template<class Enc>
+void serializer<BV>::encode_gap_block(bm::gap_word_t* gap_block, Enc& enc)
 {
     if (compression_level_ > 2)
     {
@@ -835,9 +1226,9 @@ void serializer<BV>::encode_gap_block(bm::gap_word_t* gap_block, bm::encoder& en
     gamma_gap_block(gap_block, enc);
 }
 
-template<class BV>
+template<class BV> template<class Enc>
 void serializer<BV>::encode_bit_interval(const bm::word_t* blk, 
-                                         bm::encoder&      enc,
+                                         Enc&              enc,
                                          unsigned          //size_control
                                          )
 {
@@ -886,6 +1277,219 @@ void serializer<BV>::encode_bit_interval(const bm::word_t* blk,
     }
 }
 
+template<class BV> template<class Enc>
+bool serializer<BV>::encode_bit_block(const bm::word_t* blk, Enc& enc)
+{
+    gap_word_t*  gap_temp_block = (gap_word_t*) temp_block_;
+
+    if (compression_level_ <= 1)
+    {
+        enc.put_prefixed_array_32(set_block_bit, blk, bm::set_block_size);
+        return true;            
+    }
+
+    // compute bit-block statistics: bit-count and number of GAPS
+    unsigned block_bc = 0;
+    bm::id_t bit_gaps = 
+        bit_block_calc_count_change(blk, blk + bm::set_block_size,
+							            &block_bc);
+    unsigned block_bc_inv = bm::gap_max_bits - block_bc;
+    switch (block_bc)
+    {
+    case 1: // corner case: only 1 bit on
+        {
+            bm::id_t bit_idx = 0;
+            bit_find_in_block(blk, bit_idx, &bit_idx);
+            enc.put_8(set_block_bit_1bit); enc.put_16((short)bit_idx);
+            return true;
+        }
+    case 0: return false; // empty block
+    default:
+        break;
+    }
+
+
+    // compute alternative representation sizes
+    //
+    unsigned arr_block_size = unsigned(sizeof(gap_word_t) + (block_bc * sizeof(gap_word_t)));
+    unsigned arr_block_size_inv = unsigned(sizeof(gap_word_t) + (block_bc_inv * sizeof(gap_word_t)));
+    unsigned gap_block_size = unsigned(sizeof(gap_word_t) + ((bit_gaps+1) * sizeof(gap_word_t)));
+    unsigned interval_block_size;
+    interval_block_size = bit_count_nonzero_size(blk, bm::set_block_size);
+
+    bool inverted = false;
+
+    if (arr_block_size_inv < arr_block_size &&
+        arr_block_size_inv < gap_block_size &&
+        arr_block_size_inv < interval_block_size)
+    {
+        inverted = true;
+        goto bit_as_array;
+    }
+
+    // if interval representation is not a good alternative
+    if ((interval_block_size > arr_block_size) || 
+        (interval_block_size > gap_block_size))
+    {
+        if (gap_block_size < (bm::gap_equiv_len-64) &&
+            gap_block_size < arr_block_size)
+        {
+            unsigned len = bit_convert_to_gap(gap_temp_block, 
+                                              blk, 
+                                              bm::gap_max_bits, 
+                                              bm::gap_equiv_len-64);
+            if (len) // save as GAP
+            {
+                gamma_gap_block(gap_temp_block, enc);
+                return true;
+            }
+        }
+
+        if (arr_block_size < ((bm::gap_equiv_len-64) * sizeof(gap_word_t)))
+        {
+        bit_as_array:
+            gap_word_t arr_len;
+            unsigned mask = inverted ? ~0 : 0;
+            arr_len = bit_convert_to_arr(gap_temp_block, 
+                                         blk, 
+                                         bm::gap_max_bits, 
+                                         bm::gap_equiv_len-64,
+                                         mask);
+            if (arr_len)
+            {
+                gamma_gap_array(gap_temp_block, arr_len, enc, inverted);
+                return true;
+            }
+
+        }
+        // full bit-block
+        enc.put_prefixed_array_32(set_block_bit, blk, bm::set_block_size);
+        return true;            
+    }
+
+    // if interval block is a winner
+    // it needs to have a compelling advantage of 25% over bit block
+    //
+    unsigned threashold_block_size =
+        bm::set_block_size * sizeof(bm::word_t);
+    threashold_block_size -= threashold_block_size / 4;
+
+    if (interval_block_size < arr_block_size &&
+        interval_block_size < gap_block_size &&
+        interval_block_size < (bm::set_block_size * sizeof(bm::word_t))
+        )
+    {
+        encode_bit_interval(blk, enc, interval_block_size);
+        return true;
+    }
+
+    if (gap_block_size < bm::gap_equiv_len &&
+        gap_block_size < arr_block_size)
+    {
+        unsigned len = bit_convert_to_gap(gap_temp_block, 
+                                          blk, 
+                                          bm::gap_max_bits, 
+                                          bm::gap_equiv_len-64);
+        if (len) // save as GAP
+        {
+            gamma_gap_block(gap_temp_block, enc);
+            return true;
+        }
+    }
+
+
+    // if array is best
+    if (arr_block_size < bm::gap_equiv_len-64)
+    {
+        goto bit_as_array;
+    }
+    // full bit-block
+    enc.put_prefixed_array_32(set_block_bit, blk, bm::set_block_size);
+    return true;            
+}
+
+template<class BV> template<class Enc>
+bool serializer<BV>::encode_ref_block(const bm::word_t* blk,
+                                      unsigned          nb,
+                                      Enc&              enc)
+{
+    BM_ASSERT(ref_bv_ && xor_block_);
+    
+    const bm::word_t* ref_blk = ref_bv_->get_blocks_manager().get_block(nb);
+    if (!ref_blk)
+        return false;
+    
+    // compute XOR difference between the block and the reference block
+    if (BM_IS_GAP(blk))
+        bm::gap_convert_to_bitset(xor_block_, BMGAP_PTR(blk));
+    else
+        bm::bit_block_copy(xor_block_, blk);
+    if (BM_IS_GAP(ref_blk))
+        bm::gap_xor_to_bitset(xor_block_, BMGAP_PTR(ref_blk));
+    else
+        bm::bit_block_xor(xor_block_, ref_blk);
+    
+    if (bm::bit_is_all_zero(xor_block_, xor_block_ + bm::set_block_size))
+    {
+        enc.put_8(set_block_ref_eq);
+        return true;
+    }
+    
+    // encode XOR difference aside and compare with the plain encoding
+    bm::encoder enc_xor(xor_enc_buf_, 
+                        bm::set_block_size * sizeof(bm::word_t) * 2);
+    enc_xor.put_8(set_block_xor_ref);
+    encode_bit_block(xor_block_, enc_xor);
+    unsigned xor_size = enc_xor.size();
+    
+    typename Enc::position_type enc_pos0 = enc.get_pos();
+    if (BM_IS_GAP(blk))
+    {
+        encode_gap_block(BMGAP_PTR(blk), enc);
+    }
+    else
+    {
+        if (!encode_bit_block(blk, enc))
+            return false; // empty block
+    }
+    unsigned plain_size = (unsigned)(enc.get_pos() - enc_pos0);
+    if (xor_size < plain_size)
+    {
+        enc.set_pos(enc_pos0);
+        enc.memcpy(xor_enc_buf_, xor_size);
+    }
+    return true;
+}
+
+template<class BV> template<class Enc>
+typename Enc::position_type serializer<BV>::begin_crc32c_chunk(Enc& enc)
+{
+    typename Enc::position_type chk_pos = enc.get_pos();
+    enc.put_8(set_block_crc32c);
+    enc.put_32(0); // chunk length
+    enc.put_32(0); // CRC32C
+    return chk_pos;
+}
+
+template<class BV>
+void serializer<BV>::end_crc32c_chunk(bm::encoder&    enc, 
+                                      unsigned char*  chk_pos, 
+                                      unsigned char*& crc_pos)
+{
+    unsigned char* chunk = chk_pos + 1 + 2 * sizeof(bm::word_t);
+    unsigned char* end_pos = enc.get_pos();
+    
+    // CRC covers stream since the previous chunk (header), then the chunk
+    unsigned crc = bm::crc32c(crc_pos, size_t(chk_pos - crc_pos));
+    crc = bm::crc32c(chunk, size_t(end_pos - chunk), crc);
+    
+    enc.set_pos(chk_pos + 1);
+    enc.put_32(unsigned(end_pos - chunk));
+    enc.put_32(crc);
+    enc.set_pos(end_pos);
+    crc_pos = end_pos;
+}
+
 template<class BV>
 void serializer<BV>::serialize(const BV& bv,
                                typename serializer<BV>::buffer& buf,
@@ -908,25 +1512,71 @@ void serializer<BV>::serialize(const BV& bv,
 }
 
 
+template<class BV>
+void serializer<BV>::end_crc32c_chunk(bm::encoder_size_counter& enc, 
+                                      size_t                    /*chk_pos*/, 
+                                      size_t&                   crc_pos)
+{
+    crc_pos = enc.get_pos();
+}
+
 template<class BV>
 unsigned serializer<BV>::serialize(const BV& bv, 
                                    unsigned char* buf, size_t buf_size)
 {
     BM_ASSERT(temp_block_);
     
-    const blocks_manager_type& bman = bv.get_blocks_manager();
+    bm::encoder enc(buf, buf_size);  // create the encoder
+    encode_header(bv, enc);
+    encode_blocks(bv, enc, buf);
 
-    gap_word_t*  gap_temp_block = (gap_word_t*) temp_block_;
+    unsigned encoded_size = enc.size();
+    return encoded_size;
+}
+
+template<class BV>
+size_t serializer<BV>::estimate_serialized_size(const BV& bv)
+{
+    BM_ASSERT(temp_block_);
     
-    bm::encoder enc(buf, buf_size);  // create the encoder
+    bm::encoder_size_counter enc;
     encode_header(bv, enc);
+    encode_blocks(bv, enc, 0); // stream start
+    return enc.size();
+}
+
+template<class Alloc>
+size_t bvector<Alloc>::estimate_serialized_size(unsigned compression_level) const
+{
+    BM_DECLARE_TEMP_BLOCK(tb)
+    bm::serializer<bm::bvector<Alloc> > bvs(get_allocator(), tb);
+    bvs.set_compression_level(compression_level);
+    return bvs.estimate_serialized_size(*this);
+}
 
+template<class BV> template<class Enc>
+void serializer<BV>::encode_blocks(const BV& bv, Enc& enc, 
+                                   typename Enc::position_type crc_pos)
+{
+    const blocks_manager_type& bman = bv.get_blocks_manager();
     unsigned i,j;
 
+    // CRC32C checkpoints go ahead of the stream chunks,
+    // so deserializer verifies a chunk before decoding it
+    typename Enc::position_type chk_pos = 0;
+    if (crc_serial_)
+        chk_pos = begin_crc32c_chunk(enc);
 
     // save blocks.
     for (i = 0; i < bm::set_total_blocks; ++i)
     {
+        if (crc_serial_ && 
+            unsigned(enc.get_pos() - chk_pos) >= bm::set_crc32c_chunk_size)
+        {
+            end_crc32c_chunk(enc, chk_pos, crc_pos);
+            chk_pos = begin_crc32c_chunk(enc);
+        }
+
         bm::word_t* blk = bman.get_block(i);
         // -----------------------------------------
         // Empty or ONE block serialization
@@ -940,7 +1590,9 @@ unsigned serializer<BV>::serialize(const BV& bv,
             if (next_nb == bm::set_total_blocks) // no more blocks
             {
                 enc.put_8(set_block_azero);
-                return enc.size();
+                if (crc_serial_)
+                    end_crc32c_chunk(enc, chk_pos, crc_pos);
+                return;
             }
             unsigned nb = next_nb - i;
             
@@ -990,6 +1642,12 @@ unsigned serializer<BV>::serialize(const BV& bv,
             }
         }
 
+        // ------------------------------
+        // Reference vector block serialization
+
+        if (ref_bv_ && encode_ref_block(blk, i, enc))
+            continue;
+
         // ------------------------------
         // GAP serialization
 
@@ -1003,139 +1661,13 @@ unsigned serializer<BV>::serialize(const BV& bv,
         // ----------------------------------------------
         // BIT BLOCK serialization
 
-        {
-        if (compression_level_ <= 1)
-        {
-            enc.put_prefixed_array_32(set_block_bit, blk, bm::set_block_size);
-            continue;            
-        }
-
-        // compute bit-block statistics: bit-count and number of GAPS
-        unsigned block_bc = 0;
-        bm::id_t bit_gaps = 
-            bit_block_calc_count_change(blk, blk + bm::set_block_size,
-							            &block_bc);
-        unsigned block_bc_inv = bm::gap_max_bits - block_bc;
-        switch (block_bc)
-        {
-        case 1: // corner case: only 1 bit on
-            {
-                bm::id_t bit_idx = 0;
-                bit_find_in_block(blk, bit_idx, &bit_idx);
-                enc.put_8(set_block_bit_1bit); enc.put_16((short)bit_idx);
-                continue;
-            }
-        case 0: goto zero_block; // empty block
-        default:
-            break;
-        }
-       
-       
-        // compute alternative representation sizes
-        //
-        unsigned arr_block_size = unsigned(sizeof(gap_word_t) + (block_bc * sizeof(gap_word_t)));
-        unsigned arr_block_size_inv = unsigned(sizeof(gap_word_t) + (block_bc_inv * sizeof(gap_word_t)));
-        unsigned gap_block_size = unsigned(sizeof(gap_word_t) + ((bit_gaps+1) * sizeof(gap_word_t)));
-        unsigned interval_block_size;
-        interval_block_size = bit_count_nonzero_size(blk, bm::set_block_size);
-        
-        bool inverted = false;
-
-        if (arr_block_size_inv < arr_block_size &&
-            arr_block_size_inv < gap_block_size &&
-            arr_block_size_inv < interval_block_size)
-        {
-            inverted = true;
-            goto bit_as_array;
-        }
-
-        // if interval representation is not a good alternative
-        if ((interval_block_size > arr_block_size) || 
-            (interval_block_size > gap_block_size))
-        {
-            if (gap_block_size < (bm::gap_equiv_len-64) &&
-                gap_block_size < arr_block_size)
-            {
-                unsigned len = bit_convert_to_gap(gap_temp_block, 
-                                                  blk, 
-                                                  bm::gap_max_bits, 
-                                                  bm::gap_equiv_len-64);
-                if (len) // save as GAP
-                {
-                    gamma_gap_block(gap_temp_block, enc);
-                    continue;
-                }
-            }
-            
-            if (arr_block_size < ((bm::gap_equiv_len-64) * sizeof(gap_word_t)))
-            {
-            bit_as_array:
-                gap_word_t arr_len;
-                unsigned mask = inverted ? ~0 : 0;
-                arr_len = bit_convert_to_arr(gap_temp_block, 
-                                             blk, 
-                                             bm::gap_max_bits, 
-                                             bm::gap_equiv_len-64,
-                                             mask);
-                if (arr_len)
-                {
-                    gamma_gap_array(gap_temp_block, arr_len, enc, inverted);
-                    continue;
-                }
-                
-            }
-            // full bit-block
-            enc.put_prefixed_array_32(set_block_bit, blk, bm::set_block_size);
-            continue;            
-        }
-        
-        // if interval block is a winner
-        // it needs to have a compelling advantage of 25% over bit block
-        //
-        unsigned threashold_block_size =
-            bm::set_block_size * sizeof(bm::word_t);
-        threashold_block_size -= threashold_block_size / 4;
-            
-        if (interval_block_size < arr_block_size &&
-            interval_block_size < gap_block_size &&
-            interval_block_size < (bm::set_block_size * sizeof(bm::word_t))
-            )
-        {
-            encode_bit_interval(blk, enc, interval_block_size);
-            continue;
-        }
-        
-        if (gap_block_size < bm::gap_equiv_len &&
-            gap_block_size < arr_block_size)
-        {
-            unsigned len = bit_convert_to_gap(gap_temp_block, 
-                                              blk, 
-                                              bm::gap_max_bits, 
-                                              bm::gap_equiv_len-64);
-            if (len) // save as GAP
-            {
-                gamma_gap_block(gap_temp_block, enc);
-                continue;
-            }
-        }
-        
-         
-        // if array is best
-        if (arr_block_size < bm::gap_equiv_len-64)
-        {
-            goto bit_as_array;
-        }
-        // full bit-block
-        enc.put_prefixed_array_32(set_block_bit, blk, bm::set_block_size);
-        continue;            
-        }
+        if (!encode_bit_block(blk, enc))
+            goto zero_block; // empty block
     }
 
     enc.put_8(set_block_end);
-
-    unsigned encoded_size = enc.size();
-    return encoded_size;
-
+    if (crc_serial_)
+        end_crc32c_chunk(enc, chk_pos, crc_pos);
 }
 
 
@@ -1143,8 +1675,12 @@ unsigned serializer<BV>::serialize(const BV& bv,
 /// Bit mask flags for serialization algorithm
 /// \ingroup bvserial 
 enum serialization_flags {
-    BM_NO_BYTE_ORDER = 1,       ///< save no byte-order info (save some space)
-    BM_NO_GAP_LENGTH = (1 << 1) ///< save no GAP info (save some space)
+    BM_NO_BYTE_ORDER = 1,        ///< save no byte-order info (save some space)
+    BM_NO_GAP_LENGTH = (1 << 1), ///< save no GAP info (save some space)
+    BM_XOR_REF       = (1 << 2), ///< XOR/reference compression (sparse vector plains)
+    BM_CRC32C        = (1 << 3), ///< CRC32C checkpoints (verified on deserialization)
+    BM_AUTO_LEVEL    = (1 << 4), ///< compression level chosen per vector (sparse vector plains)
+    BM_SVB           = (1 << 5)  ///< Stream VByte coded GAP and array blocks (fast decode)
 };
 
 /*!
@@ -1204,6 +1740,12 @@ unsigned serialize(const BV& bv,
     else
         bv_serial.gap_length_serialization(true);
 
+    if (serialization_flags & BM_CRC32C)
+        bv_serial.crc32c_serialization(true);
+
+    if (serialization_flags & BM_SVB)
+        bv_serial.svb_serialization(true);
+
     bv_serial.set_compression_level(4);
     
     return bv_serial.serialize(bv, buf, 0);
@@ -1241,19 +1783,29 @@ unsigned serialize(BV& bv,
     @param buf - pointer on memory which keeps serialized bvector
     @param temp_block - pointer on temporary block, 
             if NULL bvector allocates own.
+    @param bv_ref - reference vector for XOR/reference compressed BLOB
+            (the same vector as used for serialization)
+    @param buf_size - size of the buffer (0 - unknown), CRC32C chunks 
+            of a truncated BLOB are rejected without reading past it
     @return Number of bytes consumed by deserializer.
 
+    BLOB with CRC32C checkpoints is verified chunk by chunk before decoding,
+    mismatch is reported as std::logic_error (BM_ERR_CRC in STL-free mode).
+
     Function desrializes bitvector from memory block containig results
     of previous serialization. Function does not remove bits 
     which are currently set. Effectively it means OR logical operation 
     between current bitset and previously serialized one.
 
     @ingroup bvserial
+    @sa serializer::set_ref_vector
 */
 template<class BV>
 unsigned deserialize(BV& bv, 
                      const unsigned char* buf, 
-                     bm::word_t* temp_block=0)
+                     bm::word_t* temp_block=0,
+                     const BV* bv_ref=0,
+                     size_t buf_size=0)
 {
     ByteOrder bo_current = globals<true>::byte_order();
 
@@ -1268,6 +1820,8 @@ unsigned deserialize(BV& bv,
     if (bo_current == bo)
     {
         deserializer<BV, bm::decoder> deserial;
+        deserial.set_ref_vector(bv_ref);
+        deserial.set_buf_size(buf_size);
         return deserial.deserialize(bv, buf, temp_block);
     }
     switch (bo_current) 
@@ -1275,11 +1829,15 @@ unsigned deserialize(BV& bv,
     case BigEndian:
         {
         deserializer<BV, bm::decoder_big_endian> deserial;
+        deserial.set_ref_vector(bv_ref);
+        deserial.set_buf_size(buf_size);
         return deserial.deserialize(bv, buf, temp_block);
         }
     case LittleEndian:
         {
         deserializer<BV, bm::decoder_little_endian> deserial;
+        deserial.set_ref_vector(bv_ref);
+        deserial.set_buf_size(buf_size);
         return deserial.deserialize(bv, buf, temp_block);
         }
     default:
@@ -1305,14 +1863,37 @@ unsigned deseriaizer_base<DEC>::read_id_list(decoder_type&   decoder,
 		break;
     case set_block_arrgap:
     case set_block_arrgap_inv:
-        len = decoder.get_16();
+        len = read_id_list_len(decoder, 0);
         decoder.get_16(dst_arr, len);
 		break;
+    case set_block_arrgap_svb:
+    case set_block_arrgap_svb_inv:
+        len = read_id_list_len(decoder, 0);
+        decoder.get_svb16_dgap(dst_arr, len);
+        break;
+    case set_block_arrgap_bienc:
+    case set_block_arrgap_bienc_inv:
+        {
+            len = read_id_list_len(decoder, 2);
+            if (!len)
+                break;
+            dst_arr[0] = decoder.get_16();
+            dst_arr[len-1] = decoder.get_16();
+            bit_in_type bin(decoder);
+            bm::bic_decode_u16(bin, dst_arr + 1, len - 2u,
+                               dst_arr[0] + 1u, dst_arr[len-1] - 1u);
+        }
+        break;
     case set_block_arrgap_egamma:
     case set_block_arrgap_egamma_inv:
         {
             bit_in_type bin(decoder);
             len = (gap_word_t)bin.gamma();
+            if (len > bm::gap_equiv_len) // longer than bit block
+            {
+                bm::throw_serial_format_error();
+                len = 0;
+            }
             gap_word_t prev = 0;
             for (gap_word_t k = 0; k < len; ++k)
             {
@@ -1330,6 +1911,42 @@ unsigned deseriaizer_base<DEC>::read_id_list(decoder_type&   decoder,
 	return len;
 }
 
+template<class DEC>
+gap_word_t deseriaizer_base<DEC>::read_id_list_len(decoder_type& decoder,
+                                                   unsigned      min_len)
+{
+    gap_word_t len = decoder.get_16();
+    if (len < min_len || len > bm::gap_equiv_len) // longer than bit block
+    {
+        bm::throw_serial_format_error();
+        len = 0;
+    }
+    return len;
+}
+
+
+template<class DEC>
+bool deseriaizer_base<DEC>::read_crc32c(decoder_type&         decoder,
+                                        const unsigned char*& crc_pos,
+                                        const unsigned char*  buf_end)
+{
+    const unsigned char* chk_pos = decoder.get_pos() - 1; // checkpoint token
+    if (buf_end && buf_end - decoder.get_pos() < 8) // truncated checkpoint
+        return false;
+    unsigned len = decoder.get_32();
+    unsigned crc_saved = decoder.get_32();
+    // chunk is closed on the first block after the threshold
+    if (len > 2 * bm::set_crc32c_chunk_size) // damaged length
+        return false;
+    const unsigned char* chunk = decoder.get_pos();
+    if (buf_end && size_t(buf_end - chunk) < len) // truncated BLOB
+        return false;
+    
+    unsigned crc = bm::crc32c(crc_pos, size_t(chk_pos - crc_pos));
+    crc = bm::crc32c(chunk, len, crc);
+    crc_pos = chunk + len;
+    return (crc == crc_saved);
+}
 
 template<class DEC>
 void deseriaizer_base<DEC>::read_gap_block(decoder_type&   decoder, 
@@ -1361,7 +1978,7 @@ void deseriaizer_base<DEC>::read_gap_block(decoder_type&   decoder,
     case set_block_arrgap_inv:
         {
             gap_set_all(dst_block, bm::gap_max_bits, 0);
-            gap_word_t len = decoder.get_16();
+            gap_word_t len = read_id_list_len(decoder, 0);
 
             for (gap_word_t k = 0; k < len; ++k)
             {
@@ -1372,6 +1989,10 @@ void deseriaizer_base<DEC>::read_gap_block(decoder_type&   decoder,
         break;
     case set_block_arrgap_egamma:
     case set_block_arrgap_egamma_inv:
+    case set_block_arrgap_svb:
+    case set_block_arrgap_svb_inv:
+    case set_block_arrgap_bienc:
+    case set_block_arrgap_bienc_inv:
         {
         	unsigned arr_len = read_id_list(decoder, block_type, id_array_);
             dst_block[0] = 0;
@@ -1401,18 +2022,55 @@ void deseriaizer_base<DEC>::read_gap_block(decoder_type&   decoder,
                 dst_block[len+1] = bm::gap_max_bits - 1;
             }
         }
-
-        }
-        break;        
+
+        }
+        break;        
+    case set_block_gap_svb:
+        {
+            unsigned len = gap_length(&gap_head);
+            --len;
+            *dst_block = gap_head;
+            decoder.get_svb16_dgap(dst_block+1, len - 1);
+            dst_block[len] = gap_max_bits - 1;
+        }
+        break;
+    case set_block_gap_bienc:
+        {
+            unsigned len = gap_length(&gap_head);
+            if (len < 4) // first and last boundaries are saved explicitly
+            {
+                bm::throw_serial_format_error();
+                gap_set_all(dst_block, bm::gap_max_bits, 0);
+                break;
+            }
+            --len;
+            unsigned n = len - 1; // number of saved GAP boundaries
+            *dst_block = gap_head;
+            dst_block[1] = decoder.get_16();
+            dst_block[n] = decoder.get_16();
+            bit_in_type bin(decoder);
+            bm::bic_decode_u16(bin, dst_block + 2, n - 2,
+                               dst_block[1] + 1u, dst_block[n] - 1u);
+            dst_block[len] = gap_max_bits - 1;
+        }
+        break;
     default:
         BM_ASSERT(0);
     }
 
     if (block_type == set_block_arrgap_egamma_inv || 
-        block_type == set_block_arrgap_inv)
+        block_type == set_block_arrgap_inv ||
+        block_type == set_block_arrgap_svb_inv ||
+        block_type == set_block_arrgap_bienc_inv)
     {
         gap_invert(dst_block);
     }
+
+    if (!bm::gap_is_valid(dst_block)) // damaged BLOB
+    {
+        bm::throw_serial_format_error();
+        gap_set_all(dst_block, bm::gap_max_bits, 0);
+    }
 }
 
 
@@ -1488,6 +2146,8 @@ deserializer<BV, DEC>::deserialize_gap(unsigned char btype, decoder_type& dec,
     }
     case set_block_arrgap: 
     case set_block_arrgap_egamma:
+    case set_block_arrgap_svb:
+    case set_block_arrgap_bienc:
         {
         	unsigned arr_len = this->read_id_list(dec, btype, this->id_array_);
             gap_temp_block_[0] = 0; // reset unused bits in gap header
@@ -1508,10 +2168,14 @@ deserializer<BV, DEC>::deserialize_gap(unsigned char btype, decoder_type& dec,
             break;
         }
     case set_block_gap_egamma:            
+    case set_block_gap_svb:
+    case set_block_gap_bienc:
         gap_head = (gap_word_t)
             (sizeof(gap_word_t) == 2 ? dec.get_16() : dec.get_32());
     case set_block_arrgap_egamma_inv:
     case set_block_arrgap_inv:
+    case set_block_arrgap_svb_inv:
+    case set_block_arrgap_bienc_inv:
         this->read_gap_block(dec, btype, gap_temp_block_, gap_head);
         break;
     default:
@@ -1526,6 +2190,108 @@ deserializer<BV, DEC>::deserialize_gap(unsigned char btype, decoder_type& dec,
 }
 
 
+template<class BV, class DEC>
+void deserializer<BV, DEC>::decode_bit_block(unsigned char btype,
+                                             decoder_type& dec,
+                                             bm::word_t*   dst_block)
+{
+    switch (btype)
+    {
+    case set_block_bit:
+        dec.get_32(dst_block, bm::set_block_size);
+        break;
+    case set_block_bit_0runs:
+        {
+            bit_block_set(dst_block, 0);
+            unsigned char run_type = dec.get_8();
+            for (unsigned j = 0; j < bm::set_block_size;run_type = !run_type)
+            {
+                unsigned run_length = dec.get_16();
+                if (run_type)
+                {
+                    unsigned run_end = j + run_length;
+                    for (;j < run_end; ++j)
+                    {
+                        BM_ASSERT(j < bm::set_block_size);
+                        dst_block[j] = dec.get_32();
+                    }
+                }
+                else
+                {
+                    j += run_length;
+                }
+            } // for
+        }
+        break;
+    case set_block_gap:
+    case set_block_gap_egamma:
+    case set_block_bit_1bit:
+    case set_block_arrgap:
+    case set_block_arrgap_inv:
+    case set_block_arrgap_egamma:
+    case set_block_arrgap_egamma_inv:
+    case set_block_gap_svb:
+    case set_block_arrgap_svb:
+    case set_block_arrgap_svb_inv:
+    case set_block_gap_bienc:
+    case set_block_arrgap_bienc:
+    case set_block_arrgap_bienc_inv:
+        {
+            gap_word_t gap_head = 0;
+            if (btype == set_block_gap || btype == set_block_gap_egamma ||
+                btype == set_block_gap_svb || btype == set_block_gap_bienc)
+            {
+                gap_head = (gap_word_t)
+                    (sizeof(gap_word_t) == 2 ? dec.get_16() : dec.get_32());
+            }
+            this->read_gap_block(dec, btype, gap_temp_block_, gap_head);
+            gap_convert_to_bitset(dst_block, gap_temp_block_);
+        }
+        break;
+    default:
+        BM_ASSERT(0); // unknown block type
+    }
+}
+
+template<class BV, class DEC>
+void deserializer<BV, DEC>::deserialize_ref(unsigned char btype,
+                                            decoder_type& dec,
+                                            bvector_type& bv,
+                                            unsigned      i)
+{
+    if (!ref_bv_)
+    {
+        bm::throw_serial_ref_error();
+        return;
+    }
+    const bm::word_t* ref_blk = ref_bv_->get_blocks_manager().get_block(i);
+
+    if (btype == set_block_ref_eq)
+    {
+        if (!ref_blk)
+            return;
+        if (BM_IS_GAP(ref_blk))
+            bv.combine_operation_with_block(i,
+                                            (bm::word_t*)BMGAP_PTR(ref_blk),
+                                            1, BM_OR);
+        else
+            bv.combine_operation_with_block(i, ref_blk, 0, BM_OR);
+        return;
+    }
+
+    // XOR difference with the reference block
+    decode_bit_block(dec.get_8(), dec, temp_block_);
+    if (ref_blk)
+    {
+        if (BM_IS_GAP(ref_blk))
+            gap_xor_to_bitset(temp_block_, BMGAP_PTR(ref_blk));
+        else
+            bit_block_xor(temp_block_, ref_blk);
+    }
+    bv.combine_operation_with_block(i, temp_block_, 0, BM_OR);
+}
+
+
 template<class BV, class DEC>
 unsigned deserializer<BV, DEC>::deserialize(bvector_type&        bv, 
                                             const unsigned char* buf,
@@ -1557,6 +2323,12 @@ unsigned deserializer<BV, DEC>::deserialize(bvector_type&        bv,
         /*ByteOrder bo = (bm::ByteOrder)*/dec.get_8();
     }
 
+    if ((header_flag & BM_HM_REF) && !ref_bv_) // reference vector is required
+    {
+        bv.set_new_blocks_strat(strat);
+        bm::throw_serial_ref_error();
+    }
+
     if (header_flag & BM_HM_ID_LIST)
     {
         // special case: the next comes plain list of integers
@@ -1601,9 +2373,27 @@ unsigned deserializer<BV, DEC>::deserialize(bvector_type&        bv,
 
     unsigned char btype;
     unsigned nb;
+    const unsigned char* crc_pos = buf; // end of the last verified chunk
+    const unsigned char* crc_end = 0;   // next checkpoint position
+    const unsigned char* buf_end = buf_size_ ? buf + buf_size_ : 0;
+    if (header_flag & BM_HM_CRC)
+        crc_end = dec.get_pos(); // checkpoint follows the header
 
     for (i = 0; i < bm::set_total_blocks; ++i)
     {
+        if (crc_end && dec.get_pos() >= crc_end) // verify the next chunk
+        {
+            if (dec.get_pos() != crc_end ||
+                dec.get_8() != set_block_crc32c ||
+                !this->read_crc32c(dec, crc_pos, buf_end))
+            {
+                bv.forget_count();
+                bv.set_new_blocks_strat(strat);
+                bm::throw_serial_crc_error();
+                return 0; // corrupted stream
+            }
+            crc_end = crc_pos;
+        }
         btype = dec.get_8();
         bm::word_t* blk = bman.get_block(i);
         
@@ -1681,27 +2471,7 @@ unsigned deserializer<BV, DEC>::deserialize(bvector_type&        bv,
         case set_block_bit_0runs:
         {
             //TODO: optimization if block exists
-            bit_block_set(temp_block, 0);
-
-            unsigned char run_type = dec.get_8();
-            for (unsigned j = 0; j < bm::set_block_size;run_type = !run_type)
-            {
-                unsigned run_length = dec.get_16();
-                if (run_type)
-                {
-                    unsigned run_end = j + run_length;
-                    for (;j < run_end; ++j)
-                    {
-                        BM_ASSERT(j < bm::set_block_size);
-                        temp_block[j] = dec.get_32();
-                    }
-                }
-                else
-                {
-                    j += run_length;
-                }
-            } // for
-
+            decode_bit_block(btype, dec, temp_block);
             bv.combine_operation_with_block(i, 
                                             temp_block,
                                             0, BM_OR);            
@@ -1743,6 +2513,12 @@ unsigned deserializer<BV, DEC>::deserialize(bvector_type&        bv,
         case set_block_arrgap_egamma:
         case set_block_arrgap_egamma_inv:
         case set_block_arrgap_inv:    
+        case set_block_gap_svb:
+        case set_block_arrgap_svb:
+        case set_block_arrgap_svb_inv:
+        case set_block_gap_bienc:
+        case set_block_arrgap_bienc:
+        case set_block_arrgap_bienc_inv:
             deserialize_gap(btype, dec, bv, bman, i, blk);
             continue;
         case set_block_arrbit:
@@ -1773,6 +2549,10 @@ unsigned deserializer<BV, DEC>::deserialize(bvector_type&        bv,
             }
             continue;
         }
+        case set_block_ref_eq:
+        case set_block_xor_ref:
+            deserialize_ref(btype, dec, bv, i);
+            continue;
         default:
             BM_ASSERT(0); // unknown block type
         } // switch
@@ -1794,7 +2574,10 @@ serial_stream_iterator<DEC>::serial_stream_iterator(const unsigned char* buf)
     state_(e_unknown),
     id_cnt_(0),
     block_idx_(0),
-    mono_block_cnt_(0)
+    mono_block_cnt_(0),
+    crc_pos_(buf),
+    crc_end_(0),
+    crc_error_(false)
 {
     ::memset(bit_func_table_, 0, sizeof(bit_func_table_));
 
@@ -1863,6 +2646,8 @@ serial_stream_iterator<DEC>::serial_stream_iterator(const unsigned char* buf)
         {
             bv_size_ = decoder_.get_32();
         }
+        if (header_flag & BM_HM_CRC)
+            crc_end_ = decoder_.get_pos(); // checkpoint follows the header
         state_ = e_blocks;
     }
 }
@@ -1898,6 +2683,22 @@ void serial_stream_iterator<DEC>::next()
             break;
         }
 
+        // verify the next stream chunk ahead of its CRC32C checkpoint
+        //
+        if (crc_end_ && decoder_.get_pos() >= crc_end_)
+        {
+            if (decoder_.get_pos() != crc_end_ ||
+                decoder_.get_8() != set_block_crc32c ||
+                !this->read_crc32c(decoder_, crc_pos_, 0))
+            {
+                crc_error_ = end_of_stream_ = true;
+                state_ = e_unknown;
+                bm::throw_serial_crc_error();
+                return;
+            }
+            crc_end_ = crc_pos_;
+        }
+
         block_type_ = decoder_.get_8();
 
         // pre-check for 7-bit zero block
@@ -1961,12 +2762,18 @@ void serial_stream_iterator<DEC>::next()
 
         case set_block_gap:
         case set_block_gap_egamma:
+        case set_block_gap_svb:
+        case set_block_gap_bienc:
             gap_head_ = (gap_word_t)
                 (sizeof(gap_word_t) == 2 ? 
                     decoder_.get_16() : decoder_.get_32());
         case set_block_arrgap:
         case set_block_arrgap_egamma:
         case set_block_arrgap_egamma_inv:
+        case set_block_arrgap_svb:
+        case set_block_arrgap_svb_inv:
+        case set_block_arrgap_bienc:
+        case set_block_arrgap_bienc_inv:
         case set_block_arrgap_inv:
 		case set_block_bit_1bit:
             state_ = e_gap_block;
@@ -2036,6 +2843,11 @@ serial_stream_iterator<DEC>::get_bit_block_ASSIGN(
         for (unsigned j = 0; j < bm::set_block_size;run_type = !run_type)
         {
             unsigned run_length = decoder_.get_16();
+            if (run_length > bm::set_block_size - j) // run out of the block
+            {
+                bm::throw_serial_format_error();
+                break;
+            }
             if (run_type)
             {
 				decoder_.get_32(dst_block ? dst_block + j : dst_block, run_length);
@@ -2048,6 +2860,11 @@ serial_stream_iterator<DEC>::get_bit_block_ASSIGN(
         {
             unsigned head_idx = decoder_.get_16();
             unsigned tail_idx = decoder_.get_16();
+            if (head_idx > tail_idx || tail_idx >= bm::set_block_size)
+            {
+                bm::throw_serial_format_error();
+                break;
+            }
             if (dst_block) 
             {
                 for (unsigned i = 0; i < head_idx; ++i)
@@ -2508,6 +3325,11 @@ serial_stream_iterator<DEC>::get_bit_block_COUNT_AND(bm::word_t*  dst_block,
         for (unsigned j = 0; j < bm::set_block_size;run_type = !run_type)
         {
             unsigned run_length = decoder_.get_16();
+            if (run_length > bm::set_block_size - j) // run out of the block
+            {
+                bm::throw_serial_format_error();
+                break;
+            }
             if (run_type)
             {
                 unsigned run_end = j + run_length;
@@ -2527,6 +3349,11 @@ serial_stream_iterator<DEC>::get_bit_block_COUNT_AND(bm::word_t*  dst_block,
         {
         unsigned head_idx = decoder_.get_16();
         unsigned tail_idx = decoder_.get_16();
+        if (head_idx > tail_idx || tail_idx >= bm::set_block_size)
+        {
+            bm::throw_serial_format_error();
+            break;
+        }
         for (unsigned i = head_idx; i <= tail_idx; ++i)
             count += word_bitcount(dst_block[i] & decoder_.get_32());
         }
@@ -2919,6 +3746,42 @@ serial_stream_iterator<DEC>::get_gap_block(bm::gap_word_t* dst_block)
     this->state_ = e_blocks;
 }
 
+template<class DEC>
+void 
+serial_stream_iterator<DEC>::skip_gap_block(bm::gap_word_t* tmp_block)
+{
+    BM_ASSERT(this->state_ == e_gap_block || 
+              this->block_type_ == set_block_bit_1bit);
+
+    switch (this->block_type_)
+    {
+    case set_block_gap:
+        {
+            unsigned len = gap_length(&this->gap_head_);
+            decoder_.seek((len - 2) * sizeof(gap_word_t));
+        }
+        break;
+    case set_block_bit_1bit:
+        decoder_.get_16();
+        break;
+    case set_block_arrgap:
+    case set_block_arrgap_inv:
+        {
+            gap_word_t len = this->read_id_list_len(decoder_, 0);
+            decoder_.seek(len * sizeof(gap_word_t));
+        }
+        break;
+    default: // bit-serial or variable length codes are decoded
+        this->read_gap_block(this->decoder_,
+                       this->block_type_,
+                       tmp_block,
+                       this->gap_head_);
+    }
+
+    ++(this->block_idx_);
+    this->state_ = e_blocks;
+}
+
 
 template<class DEC>
 unsigned 
@@ -2955,6 +3818,9 @@ unsigned operation_deserializer<BV>::deserialize(
     {
         bo = (bm::ByteOrder) dec.get_8();
     }
+    // XOR/reference compressed BLOB needs bm::deserialize() with reference
+    if (header_flag & BM_HM_REF)
+        bm::throw_serial_ref_error();
 
     blocks_manager_type& bman = bv.get_blocks_manager();
     bit_block_guard<blocks_manager_type> bg(bman);
@@ -2993,6 +3859,83 @@ unsigned operation_deserializer<BV>::deserialize(
 }
 
 
+template<class BV>
+void operation_deserializer<BV>::count_and_batch(
+                                    const bvector_type&          bv_query,
+                                    const unsigned char* const*  bufs,
+                                    size_t                       buf_count,
+                                    bm::id_t*                    counts,
+                                    bm::word_t*                  temp_block)
+{
+    BM_ASSERT(bufs && counts);
+
+    bm::id_t last;
+    if (!bv_query.find_reverse(last)) // empty query: all results are 0
+    {
+        for (size_t i = 0; i < buf_count; ++i)
+            counts[i] = 0;
+        return;
+    }
+    unsigned nb_last = unsigned(last >> bm::set_block_shift);
+
+    // XOR/reference compressed BLOBs need bm::deserialize() with reference
+    for (size_t i = 0; i < buf_count; ++i)
+    {
+        if (bufs[i][0] & BM_HM_REF) // header flag
+            bm::throw_serial_ref_error();
+    }
+
+    // private allocator, query's allocator (pool) is not touched
+    // (freed on exit or on CRC32C error)
+    typedef typename bvector_type::allocator_type allocator_type;
+    bm::bit_blocks_buffer<allocator_type> own_block(allocator_type(), 1);
+    if (temp_block == 0)
+    {
+        temp_block = own_block.block(0);
+    }
+
+    ByteOrder bo_current = globals<true>::byte_order();
+    for (size_t i = 0; i < buf_count; ++i)
+    {
+        const unsigned char* buf = bufs[i];
+        bm::decoder dec(buf);
+        unsigned char header_flag = dec.get_8();
+        ByteOrder bo = bo_current;
+        if (!(header_flag & BM_HM_NO_BO))
+        {
+            bo = (bm::ByteOrder) dec.get_8();
+        }
+        if (bo_current == bo)
+        {
+            serial_stream_current ss(buf);
+            counts[i] = iterator_deserializer<BV, serial_stream_current>::
+                            count_and(bv_query, ss, temp_block, nb_last);
+            continue;
+        }
+        switch (bo_current) 
+        {
+        case BigEndian:
+            {
+            serial_stream_be ss(buf);
+            counts[i] = iterator_deserializer<BV, serial_stream_be>::
+                            count_and(bv_query, ss, temp_block, nb_last);
+            }
+            break;
+        case LittleEndian:
+            {
+            serial_stream_le ss(buf);
+            counts[i] = iterator_deserializer<BV, serial_stream_le>::
+                            count_and(bv_query, ss, temp_block, nb_last);
+            }
+            break;
+        default:
+            BM_ASSERT(0);
+            counts[i] = 0;
+        };
+    } // for i
+}
+
+
 template<class BV>
 void operation_deserializer<BV>::deserialize(
                      bvector_type&        bv_target,
@@ -3490,6 +4433,106 @@ void iterator_deserializer<BV, SerialIterator>::deserialize(
 
 
 
+template<class BV, class SerialIterator>
+unsigned
+iterator_deserializer<BV, SerialIterator>::count_and(
+                                       const bvector_type&   bv, 
+                                       serial_iterator_type& sit, 
+                                       bm::word_t*           temp_block,
+                                       unsigned              nb_last)
+{
+    BM_ASSERT(temp_block);
+
+    unsigned count = 0;
+    gap_word_t   gap_temp_block[bm::gap_equiv_len*3];
+    gap_temp_block[0] = 0;
+
+    const blocks_manager_type& bman = bv.get_blocks_manager();
+    if (!bman.is_init())
+        return 0;
+
+    BM_SET_MMX_GUARD
+
+    typename serial_iterator_type::iterator_state state;
+    state = sit.get_state();
+    if (state == serial_iterator_type::e_list_ids)
+    {
+        unsigned id_count = sit.get_id_count();
+        for (unsigned i = 0; i < id_count; ++i)
+        {
+            count += bv.get_bit(sit.get_id());
+            sit.next();
+        } // for
+        return count;
+    }
+
+    for (;1;)
+    {
+        unsigned nb = sit.block_idx();
+        if (sit.is_eof() || nb > nb_last) // no more blocks in bv to AND with
+            return sit.is_crc_error() ? 0 : count;
+
+        state = sit.state();
+        switch (state)
+        {
+        case serial_iterator_type::e_blocks:
+            sit.next();
+            continue;
+        case serial_iterator_type::e_bit_block:
+            {
+            const bm::word_t* blk = bman.get_block(nb);
+            if (!blk) 
+            {
+                // AND with 0 is 0, just seek the input stream
+                sit.get_bit_block(0, temp_block, set_ASSIGN);
+            }
+            else
+            if (BM_IS_GAP(blk))
+            {
+                sit.get_bit_block(temp_block, temp_block, set_ASSIGN);
+                count += 
+                    bm::combine_count_and_operation_with_block(blk, temp_block);
+            }
+            else // COUNT_AND reads the target block, no modification
+            {
+                count += sit.get_bit_block(const_cast<bm::word_t*>(blk), 
+                                           temp_block, set_COUNT_AND);
+            }
+            }
+            break;
+        case serial_iterator_type::e_zero_blocks:
+            sit.skip_mono_blocks();
+            break;
+        case serial_iterator_type::e_one_blocks:
+            {
+            const bm::word_t* blk = bman.get_block(nb);
+            sit.next();
+            if (blk)
+                count += bman.block_bitcount(blk);
+            }
+            break;
+        case serial_iterator_type::e_gap_block:
+            {
+            const bm::word_t* blk = bman.get_block(nb);
+            if (!blk)
+            {
+                // AND with 0 is 0, just seek the input stream
+                sit.skip_gap_block(gap_temp_block);
+                break;
+            }
+            sit.get_gap_block(gap_temp_block);
+            bm::word_t* gptr = (bm::word_t*)gap_temp_block;
+            BMSET_PTRGAP(gptr);
+            count += bm::combine_count_and_operation_with_block(blk, gptr);
+            }
+            break;
+        default:
+            BM_ASSERT(0);
+            return count;
+        } // switch
+    } // for
+}
+
 template<class BV, class SerialIterator>
 unsigned 
 iterator_deserializer<BV, SerialIterator>::deserialize(
@@ -3534,6 +4577,8 @@ iterator_deserializer<BV, SerialIterator>::deserialize(
         bm::set_operation sop = op;
         if (sit.is_eof()) // argument stream ended
         {
+            if (sit.is_crc_error()) // corrupted stream, result is invalid
+                return 0;
             count += finalize_target_vector(bman, op, bv_block_idx);
             return count;
         }
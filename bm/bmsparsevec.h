@@ -55,6 +55,84 @@ template<class Val, class SV> class compressed_sparse_vector;
 template<typename EN, typename Val, unsigned CNT> class enumerator_group;
 
 
+/*!
+   \brief sparse vector value traits (unsigned types are stored as is)
+
+   Signed types are stored in bit-plains as unsigned zigzag code:
+   sign goes to plain 0, magnitude to the upper plains,
+   so small negative values use as few plains as small positive ones.
+   (0 -> 0, -1 -> 1, 1 -> 2, -2 -> 3, ...)
+
+   @ingroup sv
+   @internal
+*/
+template<typename T>
+struct sv_value_traits
+{
+    typedef T  unsigned_type;
+    enum { is_signed = 0 };
+
+    static unsigned_type s2u(T v) { return v; }
+    static T u2s(unsigned_type u) { return u; }
+    static T min_value() { return T(0); }
+    static T max_value() { return T(~T(0)); }
+};
+
+/// zigzag traits for signed types
+/// @internal
+template<typename T, typename U>
+struct sv_signed_value_traits
+{
+    typedef U  unsigned_type;
+    enum { is_signed = 1 };
+
+    static unsigned_type s2u(T v)
+    {
+        unsigned_type u = unsigned_type(unsigned_type(v) << 1);
+        return (v < 0) ? unsigned_type(~u) : u;
+    }
+    static T u2s(unsigned_type u)
+    {
+        unsigned_type m = unsigned_type(u >> 1);
+        return T((u & 1) ? unsigned_type(~m) : m);
+    }
+    static T min_value() { return u2s(unsigned_type(~unsigned_type(0))); }
+    static T max_value() { return u2s(unsigned_type(~unsigned_type(1))); }
+};
+
+template<> struct sv_value_traits<signed char>
+    : sv_signed_value_traits<signed char, unsigned char> {};
+template<> struct sv_value_traits<short>
+    : sv_signed_value_traits<short, unsigned short> {};
+template<> struct sv_value_traits<int>
+    : sv_signed_value_traits<int, unsigned int> {};
+template<> struct sv_value_traits<long>
+    : sv_signed_value_traits<long, unsigned long> {};
+template<> struct sv_value_traits<long long>
+    : sv_signed_value_traits<long long, unsigned long long> {};
+
+/// plain char is signed or unsigned depending on the platform (CHAR_MIN),
+/// signed plain char uses the zigzag code of signed char
+/// @internal
+template<bool SIGNED_CHAR>
+struct sv_char_value_traits : sv_signed_value_traits<char, unsigned char> {};
+
+template<>
+struct sv_char_value_traits<false>
+{
+    typedef char  unsigned_type;
+    enum { is_signed = 0 };
+
+    static unsigned_type s2u(char v) { return v; }
+    static char u2s(unsigned_type u) { return u; }
+    static char min_value() { return char(0); }
+    static char max_value() { return char(~char(0)); }
+};
+
+template<> struct sv_value_traits<char>
+    : sv_char_value_traits<(CHAR_MIN < 0)> {};
+
+
 /*!
    \brief sparse vector with runtime compression using bit transposition method
  
@@ -70,7 +148,10 @@ template<typename EN, typename Val, unsigned CNT> class enumerator_group;
  
    Overall it provides variable bit-depth compression, sparse compression in
    bit-plains.
- 
+
+   Signed integer types are stored in zigzag code (sign in plain 0),
+   see bm::sv_value_traits.
+
    @ingroup sv
 */
 template<class Val, class BV>
@@ -85,6 +166,8 @@ public:
     };
 
     typedef Val                                      value_type;
+    typedef bm::sv_value_traits<Val>                 value_traits_type;
+    typedef typename value_traits_type::unsigned_type unsigned_value_type;
     typedef bm::id_t                                 size_type;
     typedef BV                                       bvector_type;
     typedef bvector_type*                            bvector_type_ptr;
@@ -165,6 +248,7 @@ public:
         const_iterator(const sparse_vector_type* sv);
         const_iterator(const sparse_vector_type* sv, bm::id_t pos);
         const_iterator(const const_iterator& it);
+        const_iterator& operator=(const const_iterator& it);
         
         ~const_iterator();
 
@@ -190,7 +274,7 @@ public:
         const_iterator& operator++() { this->advance(); return *this; }
 
         /*! \brief Advance to the next available value */
-        const_iterator& operator++(int)
+        const_iterator operator++(int)
             { const_iterator tmp(*this);this->advance(); return tmp; }
 
 
@@ -214,18 +298,103 @@ public:
     private:
         enum buf_size_e
         {
-            buf_size = 4096 * 2
+            buf_size = bm::gap_max_bits, ///< decode window (one bit-block)
+            copy_size = 16               ///< decoded values a copy takes over
         };
         
+        /// take over the head of the decoded window of another iterator
+        void copy_window(const const_iterator& it);
+        
     private:
         const bm::sparse_vector<Val, BV>* sv_;
         bm::id_t                          pos_;     ///!< Position
         mutable value_type*               buf_;     ///!< value buffer
         mutable value_type*               buf_ptr_; ///!< position in the buffer
-        mutable allocator_pool_type       pool_;
+        mutable value_type*               buf_end_; ///!< end of decoded window
+        value_type                        head_[copy_size]; ///!< copied head
+    };
+    
+    /**
+        Back insert iterator implements buffered insert, faster than generic
+        access assignment.
+     
+        Values are accumulated in a window (up to the end of the current
+        bit-block) and flushed with the transposing import().
+        Buffered values are not visible in the vector until flush() 
+        (or iterator destruction).
+     
+        @ingroup sv
+    */
+    class back_insert_iterator
+    {
+    public:
+#ifndef BM_NO_STL
+        typedef std::output_iterator_tag  iterator_category;
+#endif
+        typedef sparse_vector<Val, BV>                     sparse_vector_type;
+        typedef sparse_vector_type*                        sparse_vector_type_ptr;
+        typedef typename sparse_vector_type::value_type    value_type;
+        typedef typename sparse_vector_type::size_type     size_type;
+        typedef typename sparse_vector_type::bvector_type  bvector_type;
+
+        typedef void difference_type;
+        typedef void pointer;
+        typedef void reference;
+        
+    public:
+        back_insert_iterator();
+        back_insert_iterator(sparse_vector_type* sv);
+        /// copy-ctor flushes the source iterator (to keep the insert order)
+        back_insert_iterator(const back_insert_iterator& bi);
+        
+        ~back_insert_iterator();
+        
+        /** push value to the vector */
+        back_insert_iterator& operator=(value_type v) 
+                                        { this->add(v); return *this; }
+        /** noop */
+        back_insert_iterator& operator*() { return *this; }
+        /** noop */
+        back_insert_iterator& operator++() { return *this; }
+        /** noop */
+        back_insert_iterator& operator++( int ) { return *this; }
+        
+        /** add value to the container*/
+        void add(value_type v);
+        
+        /** add NULL (no value) to the container */
+        void add_null();
+        
+        /** add a series of consequitive NULLs (no value) to the container */
+        void add_null(size_type count);
+        
+        /** return true if insertion buffer is empty */
+        bool empty() const { return !buf_cnt_; }
+        
+        /** flush the accumulated buffer */
+        void flush();
+    private:
+        enum buf_size_e
+        {
+            buf_size = bm::gap_max_bits ///< one bit-block window
+        };
+        
+        back_insert_iterator& operator=(const back_insert_iterator&);
+        
+        /** start the next window (up to the end of the bit-block) */
+        void start_window();
+        
+    private:
+        sparse_vector_type* sv_;        ///!< target vector
+        value_type*         buf_;       ///!< value buffer
+        bm::word_t*         null_buf_;  ///!< NULL flags of the buffer
+        size_type           buf_cnt_;   ///!< number of buffered values
+        size_type           buf_cap_;   ///!< capacity of the current window
+        bool                any_null_;  ///!< NULL flags are set
     };
     
     friend const_iterator;
+    friend back_insert_iterator;
 
 public:
     /*!
@@ -315,6 +484,13 @@ public:
     */
     const_iterator end() const { return const_iterator(this, bm::id_max); }
 
+    /** Provide back insert iterator
+        Back insert iterator implements buffered insertion, 
+        which is faster, than random access or push_back
+    */
+    back_insert_iterator get_back_inserter()
+                                { return back_insert_iterator(this); }
+
     /**
         \brief check if container supports NULL(unassigned) values
     */
@@ -372,6 +548,28 @@ public:
                      size_type   size,
                      bool        zero_mem = true) const;
 
+    /*!
+        \brief Gather elements to a C-style array by the list of indexes
+        (batch random access)
+     
+        Indexes are processed in runs addressing the same bit-block,
+        every plain block is located (and decoded) once per run.
+        Unsorted index lists are grouped by block in chunks first.
+     
+        \param arr - dest array (size elements)
+        \param idx - index list (every index must be less than size())
+        \param size - number of indexes
+        \param sorted_idx - sort order of the index list
+     
+        \return number of gathered elements
+     
+        \sa decode
+    */
+    size_type gather(value_type*       arr,
+                     const size_type*  idx,
+                     size_type         size,
+                     bm::sort_order    sorted_idx = bm::BM_UNKNOWN) const;
+
 
     
     /*! \brief return size of the vector
@@ -495,7 +693,7 @@ public:
         \brief get read-only access to bit-plain
         \return bit-vector for the bit plain or NULL
     */
-    const bvector_type_ptr get_plain(unsigned i) const { return plains_[i]; }
+    const bvector_type* get_plain(unsigned i) const { return plains_[i]; }
 
 
     /*!
@@ -510,7 +708,7 @@ public:
         \brief get access to bit-plain as is (can return NULL)
     */
     bvector_type_ptr plain(unsigned i) { return plains_[i]; }
-    const bvector_type_ptr plain(unsigned i) const { return plains_[i]; }
+    const bvector_type* plain(unsigned i) const { return plains_[i]; }
     
     /*!
         \brief free memory in bit-plain
@@ -541,6 +739,7 @@ public:
         \param offset - target index in the sparse vector to export from
         \param zero_mem - set to false if target array is pre-initialized
                           with 0s to avoid performance penalty
+        \param pool_ptr - memory pool for temporary blocks (0 - no pool)
      
         \return number of exported elements
      
@@ -599,6 +798,26 @@ private:
     */
     void free_vectors() BMNOEXEPT;
     
+    /*! \brief import small array using per-element bitscan
+    */
+    void import_bitscan(const value_type* arr, size_type size, size_type offset);
+    
+    /*! \brief import array block by block using 32x32 bit transposition
+    */
+    void import_blocks(const value_type* arr, size_type size, size_type offset);
+
+    /*! \brief gather by index list, runs of the same block are 
+        decoded together
+    */
+    void gather_runs(value_type*      arr,
+                     const size_type* idx,
+                     size_type        size,
+                     bool             sorted) const;
+    
+    /*! \brief convert extracted plain codes into signed values (in-place)
+    */
+    static void decode_signed(value_type* arr, size_type size);
+    
     /** Number of total bit-plains in the value type*/
     static unsigned value_bits() { return sv_value_plains; }
     
@@ -753,6 +972,7 @@ void sparse_vector<Val, BV>::throw_range_error(const char* err_msg) const
 #ifndef BM_NO_STL
     throw std::range_error(err_msg);
 #else
+    (void) err_msg;
     BM_ASSERT_THROW(false, BM_ERR_RANGE);
 #endif
 }
@@ -828,12 +1048,6 @@ void sparse_vector<Val, BV>::import(const value_type* arr,
                                     size_type         size,
                                     size_type         offset)
 {
-    unsigned char b_list[sizeof(Val)*8];
-    unsigned row_len[sizeof(Val)*8] = {0, };
-    
-    const unsigned transpose_window = 256;
-    bm::tmatrix<bm::id_t, sizeof(Val)*8, transpose_window> tm; // matrix accumulator
-    
     if (size == 0)
     {
         throw_range_error("sparse_vector range error (import size 0)");
@@ -842,6 +1056,36 @@ void sparse_vector<Val, BV>::import(const value_type* arr,
     // clear all plains in the range to provide corrrect import of 0 values
     this->clear_range(offset, offset + size - 1);
     
+    // small arrays are cheaper to scan than to transpose whole blocks
+    const size_type import_blocks_min = 256;
+    if (size < import_blocks_min)
+        import_bitscan(arr, size, offset);
+    else
+        import_blocks(arr, size, offset);
+    
+    if (offset + size > size_)
+        size_ = offset + size;
+    
+    bvector_type* bv_null = get_null_bvect();
+    if (bv_null) // configured to support NULL assignments
+    {
+        bv_null->set_range(offset, offset + size - 1);
+    }
+}
+
+//---------------------------------------------------------------------
+
+template<class Val, class BV>
+void sparse_vector<Val, BV>::import_bitscan(const value_type* arr,
+                                            size_type         size,
+                                            size_type         offset)
+{
+    unsigned char b_list[sizeof(Val)*8];
+    unsigned row_len[sizeof(Val)*8] = {0, };
+    
+    const unsigned transpose_window = 256;
+    bm::tmatrix<bm::id_t, sizeof(Val)*8, transpose_window> tm; // matrix accumulator
+    
     // transposition algorithm uses bitscen to find index bits and store it
     // in temporary matrix (list for each bit plain), matrix here works
     // when array gets to big - the list gets loaded into bit-vector using
@@ -851,7 +1095,7 @@ void sparse_vector<Val, BV>::import(const value_type* arr,
     size_type i;
     for (i = 0; i < size; ++i)
     {
-        unsigned bcnt = bm::bitscan(arr[i], b_list);
+        unsigned bcnt = bm::bitscan(value_traits_type::s2u(arr[i]), b_list);
         const unsigned bit_idx = i + offset;
         
         for (unsigned j = 0; j < bcnt; ++j)
@@ -884,16 +1128,95 @@ void sparse_vector<Val, BV>::import(const value_type* arr,
             bm::combine_or(*bv, r, r + rl);
         }
     } // for k
+}
+
+//---------------------------------------------------------------------
+
+template<class Val, class BV>
+void sparse_vector<Val, BV>::import_blocks(const value_type* arr,
+                                           size_type         size,
+                                           size_type         offset)
+{
+    // 32-bit slices of the value type (64-bit values take 2 transpositions)
+    const unsigned slices = (value_bits() + 31) / 32;
     
+    bm::bit_blocks_buffer<allocator_type> pbuf_blocks(alloc_, value_bits());
+    bm::word_t* tb = pbuf_blocks.block(0); // bit-plains of the current block
     
-    if (i + offset > size_)
-        size_ = i + offset;
-    
-    bvector_type* bv_null = get_null_bvect();
-    if (bv_null) // configured to support NULL assignments
+    bm::word_t plain_any[sv_value_plains];
+    unsigned_value_type BM_VECT_ALIGN vbuf[32] BM_VECT_ALIGN_ATTR;
+    bm::word_t BM_VECT_ALIGN tbuf[32] BM_VECT_ALIGN_ATTR;
+    bm::word_t BM_VECT_ALIGN pbuf[32] BM_VECT_ALIGN_ATTR;
+
+    const size_type end = offset + size;
+    for (size_type pos = offset; pos < end; )
     {
-        bv_null->set_range(offset, offset + size - 1);
-    }
+        // window of the current bit-block
+        unsigned nb = unsigned(pos >> bm::set_block_shift);
+        size_type blk_base = pos & ~size_type(bm::set_block_mask);
+        size_type wend = 
+            (end - blk_base > bm::gap_max_bits) ? blk_base + bm::gap_max_bits : end;
+        unsigned w0 = unsigned((pos - blk_base) >> bm::set_word_shift);
+        unsigned w1 = unsigned((wend - 1 - blk_base) >> bm::set_word_shift);
+        
+        ::memset(plain_any, 0, sizeof(plain_any));
+        for (unsigned w = w0; w <= w1; ++w)
+        {
+            // 32 elements of the bit-block word w
+            size_type g = blk_base + (w << bm::set_word_shift);
+            const unsigned_value_type* src;
+            if (!value_traits_type::is_signed && g >= offset && g + 32 <= end)
+            {
+                src = (const unsigned_value_type*)(arr + (g - offset));
+            }
+            else // partial group (pad with 0s) or signed values to encode
+            {
+                for (unsigned k = 0; k < 32; ++k)
+                    vbuf[k] = (g + k >= offset && g + k < end) ? 
+                        value_traits_type::s2u(arr[g + k - offset]) : 0;
+                src = vbuf;
+            }
+            for (unsigned sl = 0; sl < slices; ++sl)
+            {
+                const bm::word_t* vw;
+                if (sizeof(Val) == sizeof(bm::word_t))
+                {
+                    vw = (const bm::word_t*)src;
+                }
+                else
+                {
+                    for (unsigned k = 0; k < 32; ++k)
+                        tbuf[k] = bm::word_t(src[k] >> (sl * 32));
+                    vw = tbuf;
+                }
+                bm::bit_transpose_32x32(vw, pbuf);
+                
+                unsigned p_base = sl * 32;
+                unsigned p_cnt = bm::min_value(32u, value_bits() - p_base);
+                for (unsigned p = 0; p < p_cnt; ++p)
+                {
+                    tb[(p_base + p) * bm::set_block_size + w] = pbuf[p];
+                    plain_any[p_base + p] |= pbuf[p];
+                }
+            } // for sl
+        } // for w
+        
+        // OR bit-plain blocks into the plain vectors
+        for (unsigned p = 0; p < value_bits(); ++p)
+        {
+            if (!plain_any[p])
+                continue;
+            bm::word_t* pblk = tb + p * bm::set_block_size;
+            if (w0)
+                ::memset(pblk, 0, w0 * sizeof(bm::word_t));
+            if (w1 < bm::set_block_size - 1)
+                ::memset(pblk + w1 + 1, 0, 
+                         (bm::set_block_size - 1 - w1) * sizeof(bm::word_t));
+            bvector_type* bv = get_plain(p);
+            bv->combine_operation_with_block(nb, pblk, false, BM_OR);
+        } // for p
+        pos = wend;
+    } // for pos
 }
 
 //---------------------------------------------------------------------
@@ -920,13 +1243,205 @@ sparse_vector<Val, BV>::decode(value_type* arr,
 
 template<class Val, class BV>
 typename sparse_vector<Val, BV>::size_type
-sparse_vector<Val, BV>::extract_range(value_type* arr,
+sparse_vector<Val, BV>::gather(value_type*       arr,
+                               const size_type*  idx,
+                               size_type         size,
+                               bm::sort_order    sorted_idx) const
+{
+    if (size == 0)
+        return 0;
+    
+    if (sorted_idx == bm::BM_UNKNOWN)
+    {
+        sorted_idx = bm::BM_SORTED;
+        for (size_type i = 1; i < size; ++i)
+        {
+            if (idx[i] < idx[i-1])
+            {
+                sorted_idx = bm::BM_UNSORTED;
+                break;
+            }
+        }
+    }
+    const size_type chunk_max = 65536; // positions fit gap_word_t
+    if (sorted_idx == bm::BM_SORTED || size < 64)
+    {
+        gather_runs(arr, idx, size, sorted_idx == bm::BM_SORTED);
+        return size;
+    }
+    
+    // unsorted list: chunks are grouped by block number (2-pass radix sort 
+    // of positions), gathered as sorted runs and scattered back
+    //
+    size_type chunk = size < chunk_max ? size : chunk_max;
+    size_t buf_bytes = chunk * (2 * sizeof(bm::gap_word_t) + 
+                                sizeof(size_type) + sizeof(value_type));
+    size_t blk_bytes = bm::set_block_size * sizeof(bm::word_t);
+    bm::bit_blocks_buffer<allocator_type> 
+                    cbuf(alloc_, unsigned((buf_bytes + blk_bytes - 1) / blk_bytes));
+    bm::gap_word_t* pos = (bm::gap_word_t*) cbuf.block(0);
+    bm::gap_word_t* pos_tmp = pos + chunk;
+    size_type* sidx = (size_type*) (pos_tmp + chunk);
+    value_type* sarr = (value_type*) (sidx + chunk);
+    
+    unsigned cnt[256];
+    for (size_type base = 0; base < size; base += chunk)
+    {
+        unsigned n = unsigned((size - base < chunk) ? size - base : chunk);
+        const size_type* cidx = idx + base;
+        
+        for (unsigned pass = 0; pass < 2; ++pass)
+        {
+            unsigned shift = bm::set_block_shift + pass * 8;
+            const bm::gap_word_t* src = pos_tmp;
+            bm::gap_word_t* dst = pass ? pos : pos_tmp;
+            ::memset(cnt, 0, sizeof(cnt));
+            for (unsigned k = 0; k < n; ++k)
+                ++cnt[(cidx[k] >> shift) & 0xFF];
+            for (unsigned b = 0, sum = 0; b < 256; ++b)
+            {
+                unsigned c = cnt[b]; cnt[b] = sum; sum += c;
+            }
+            if (pass)
+            {
+                for (unsigned k = 0; k < n; ++k)
+                    dst[cnt[(cidx[src[k]] >> shift) & 0xFF]++] = src[k];
+            }
+            else
+            {
+                for (unsigned k = 0; k < n; ++k)
+                    dst[cnt[(cidx[k] >> shift) & 0xFF]++] = bm::gap_word_t(k);
+            }
+        } // for pass
+        
+        for (unsigned k = 0; k < n; ++k)
+            sidx[k] = cidx[pos[k]];
+        gather_runs(sarr, sidx, n, false);
+        for (unsigned k = 0; k < n; ++k)
+            arr[base + pos[k]] = sarr[k];
+    } // for base
+    return size;
+}
+
+//---------------------------------------------------------------------
+
+template<class Val, class BV>
+void sparse_vector<Val, BV>::gather_runs(value_type*      varr,
+                                         const size_type* idx,
+                                         size_type        size,
+                                         bool             sorted) const
+{
+    unsigned_value_type* arr = (unsigned_value_type*) varr;
+    ::memset(arr, 0, sizeof(value_type)*size);
+
+    // GAP block is expanded when the run is long enough to pay off
+    const size_type gap_expand_run = 256;
+    bm::bit_blocks_buffer<allocator_type> tbuf(alloc_, 1);
+    
+    const unsigned eff_plains = effective_plains();
+    for (size_type i = 0; i < size; )
+    {
+        if (idx[i] >= size_)
+            throw_range_error("sparse vector range error");
+        unsigned nb = unsigned(idx[i] >> bm::set_block_shift);
+        
+        // find the run of indexes in the same block
+        size_type r = i + 1;
+        if (sorted)
+        {
+            size_type cnt = size - r;
+            while (cnt) // first index of the next blocks
+            {
+                size_type half = cnt >> 1;
+                if ((idx[r + half] >> bm::set_block_shift) == nb)
+                {
+                    r += half + 1; cnt -= half + 1;
+                }
+                else
+                    cnt = half;
+            }
+            if (idx[r - 1] >= size_)
+                throw_range_error("sparse vector range error");
+        }
+        else
+        {
+            for (; r < size && (idx[r] >> bm::set_block_shift) == nb; ++r)
+            {
+                if (idx[r] >= size_)
+                    throw_range_error("sparse vector range error");
+            }
+        }
+        
+        unsigned i0 = nb >> bm::set_array_shift; // top block address
+        unsigned j0 = nb &  bm::set_array_mask;  // address in sub-block
+        for (unsigned p = 0; p < eff_plains; ++p)
+        {
+            const bm::word_t* blk = get_block(p, i0, j0);
+            if (!blk)
+                continue;
+            const unsigned_value_type mask = 
+                            unsigned_value_type(unsigned_value_type(1) << p);
+            if (BM_IS_GAP(blk))
+            {
+                const bm::gap_word_t* gap_blk = BMGAP_PTR(blk);
+                if (r - i < gap_expand_run)
+                {
+                    for (size_type k = i; k < r; ++k)
+                    {
+                        unsigned nbit = unsigned(idx[k] & bm::set_block_mask);
+                        if (bm::gap_test_unr(gap_blk, nbit))
+                            arr[k] |= mask;
+                    }
+                    continue;
+                }
+                bm::word_t* tb = tbuf.block(0);
+                bm::gap_convert_to_bitset(tb, gap_blk);
+                blk = tb;
+            }
+            else
+            if (IS_FULL_BLOCK(blk))
+            {
+                for (size_type k = i; k < r; ++k)
+                    arr[k] |= mask;
+                continue;
+            }
+            for (size_type k = i; k < r; ++k)
+            {
+                unsigned nbit = unsigned(idx[k] & bm::set_block_mask);
+                bm::word_t w = blk[nbit >> bm::set_word_shift];
+                arr[k] |= unsigned_value_type(
+                    unsigned_value_type((w >> (nbit & bm::set_word_mask)) & 1u) << p);
+            }
+        } // for p
+        i = r;
+    } // for i
+    decode_signed(varr, size);
+}
+
+//---------------------------------------------------------------------
+
+template<class Val, class BV>
+void sparse_vector<Val, BV>::decode_signed(value_type* arr, size_type size)
+{
+    if (!value_traits_type::is_signed)
+        return;
+    const unsigned_value_type* uarr = (const unsigned_value_type*) arr;
+    for (size_type i = 0; i < size; ++i)
+        arr[i] = value_traits_type::u2s(uarr[i]);
+}
+
+//---------------------------------------------------------------------
+
+template<class Val, class BV>
+typename sparse_vector<Val, BV>::size_type
+sparse_vector<Val, BV>::extract_range(value_type* varr,
                                       size_type size,
                                       size_type offset,
                                       bool      zero_mem) const
 {
     if (size == 0)
         return 0;
+    unsigned_value_type* arr = (unsigned_value_type*) varr;
     if (zero_mem)
         ::memset(arr, 0, sizeof(value_type)*size);
 
@@ -936,6 +1451,8 @@ sparse_vector<Val, BV>::extract_range(value_type* arr,
     {
         end = size_;
     }
+    if (start >= end)
+        return 0;
     
     // calculate logical block coordinates and masks
     //
@@ -979,21 +1496,22 @@ sparse_vector<Val, BV>::extract_range(value_type* arr,
                 is_set = (blk[nword] & mask0);
             }
             size_type idx = k - offset;
-            value_type vm = (bool) is_set;
+            unsigned_value_type vm = (bool) is_set;
             vm <<= j;
             arr[idx] |= vm;
             
         } // for k
 
     } // for j
-    return 0;
+    decode_signed(varr, end - start);
+    return end - start;
 }
 
 //---------------------------------------------------------------------
 
 template<class Val, class BV>
 typename sparse_vector<Val, BV>::size_type
-sparse_vector<Val, BV>::extract_plains(value_type* arr,
+sparse_vector<Val, BV>::extract_plains(value_type* varr,
                                        size_type   size,
                                        size_type   offset,
                                        bool        zero_mem) const
@@ -1001,6 +1519,7 @@ sparse_vector<Val, BV>::extract_plains(value_type* arr,
     if (size == 0)
         return 0;
 
+    unsigned_value_type* arr = (unsigned_value_type*) varr;
     if (zero_mem)
         ::memset(arr, 0, sizeof(value_type)*size);
     
@@ -1010,6 +1529,8 @@ sparse_vector<Val, BV>::extract_plains(value_type* arr,
     {
         end = size_;
     }
+    if (start >= end)
+        return 0;
     
     for (size_type i = 0; i < value_bits(); ++i)
     {
@@ -1017,7 +1538,7 @@ sparse_vector<Val, BV>::extract_plains(value_type* arr,
         if (!bv)
             continue;
        
-        value_type mask = 1;
+        unsigned_value_type mask = 1;
         mask <<= i;
         typename BV::enumerator en(bv, offset);
         for (;en.valid(); ++en)
@@ -1029,8 +1550,9 @@ sparse_vector<Val, BV>::extract_plains(value_type* arr,
         } // for
         
     } // for i
+    decode_signed(varr, end - start);
 
-    return 0;
+    return end - start;
 }
 
 
@@ -1038,50 +1560,16 @@ sparse_vector<Val, BV>::extract_plains(value_type* arr,
 
 template<class Val, class BV>
 typename sparse_vector<Val, BV>::size_type
-sparse_vector<Val, BV>::extract(value_type* arr,
+sparse_vector<Val, BV>::extract(value_type* varr,
                                 size_type   size,
                                 size_type   offset,
                                 bool        zero_mem,
                                 allocator_pool_type* pool_ptr) const
 {
-    /// Decoder functor
-    /// @internal
-    ///
-    struct sv_decode_visitor_func
-    {
-        sv_decode_visitor_func(value_type* varr,
-                               value_type  mask,
-                               size_type   off)
-        : arr_(varr), mask_(mask), off_(off)
-        {}
-        
-        void add_bits(bm::id_t arr_offset, const unsigned char* bits, unsigned bits_size)
-        {
-            size_type idx_base = arr_offset - off_;
-            for (unsigned i = 0; i < bits_size; ++i)
-            {
-                size_type idx = idx_base + bits[i];
-                arr_[idx] |= mask_;
-            }
-            
-        }
-        void add_range(bm::id_t arr_offset, unsigned sz)
-        {
-            size_type idx_base = arr_offset - off_;
-            for (unsigned i = 0; i < sz; ++i)
-            {
-                arr_[i + idx_base] |= mask_;
-            }
-        }
-        value_type*  arr_;
-        value_type   mask_;
-        size_type    off_;
-    };
-
-
     if (size == 0)
         return 0;
 
+    unsigned_value_type* arr = (unsigned_value_type*) varr;
     if (zero_mem)
         ::memset(arr, 0, sizeof(value_type)*size);
     
@@ -1091,42 +1579,96 @@ sparse_vector<Val, BV>::extract(value_type* arr,
     {
         end = size_;
     }
+    if (start >= end)
+        return 0;
     
-	bool masked_scan = !(offset == 0 && size == this->size());
-
-    if (masked_scan) // use temp vector to decompress the area
+    // GAP plain blocks of the current block are expanded here
+    bm::bit_blocks_buffer<allocator_type> 
+                    pbuf_blocks(alloc_, value_bits(), pool_ptr);
+    
+    // 32-bit slices of the value type (64-bit values take 2 transpositions)
+    const unsigned slices = (value_bits() + 31) / 32;
+    const unsigned eff_plains = effective_plains();
+    
+    const bm::word_t* blks[sv_value_plains];
+    bm::word_t BM_VECT_ALIGN pbuf[32] BM_VECT_ALIGN_ATTR;
+    bm::word_t BM_VECT_ALIGN vbuf[32] BM_VECT_ALIGN_ATTR;
+    
+    for (size_type pos = start; pos < end; )
     {
-        // for large array extraction use logical opartions
-        // (faster due to vectorization)
-        bvector_type bv_mask;
-        bv_mask.set_allocator_pool(pool_ptr);
+        // window of the current bit-block
+        unsigned nb = unsigned(pos >> bm::set_block_shift);
+        unsigned i0 = nb >> bm::set_array_shift; // top block address
+        unsigned j0 = nb &  bm::set_array_mask;  // address in sub-block
+        size_type blk_base = pos & ~size_type(bm::set_block_mask);
+        size_type wend = 
+            (end - blk_base > bm::gap_max_bits) ? blk_base + bm::gap_max_bits : end;
+        unsigned w0 = unsigned((pos - blk_base) >> bm::set_word_shift);
+        unsigned w1 = unsigned((wend - 1 - blk_base) >> bm::set_word_shift);
+        pos = wend;
         
-        for (size_type i = 0; i < value_bits(); ++i)
+        bool any_blk = false;
+        for (unsigned p = 0; p < value_bits(); ++p)
         {
-            const bvector_type* bv = plains_[i];
-            if (bv)
+            const bm::word_t* blk = (p < eff_plains) ? get_block(p, i0, j0) : 0;
+            if (BM_IS_GAP(blk))
             {
-                bv_mask.set_range(offset, end - 1);
-                bv_mask.bit_and(*bv);
-
-                sv_decode_visitor_func func(arr, (value_type(1) << i), offset);
-                bm::for_each_bit(bv_mask, func);
-                bv_mask.clear();
+                bm::word_t* tb = pbuf_blocks.block(p);
+                bm::gap_convert_to_bitset(tb, BMGAP_PTR(blk));
+                blk = tb;
             }
-        } // for i
-    }
-    else
-    {
-        for (size_type i = 0; i < value_bits(); ++i)
-        {
-            const bvector_type* bv = plains_[i];
-            if (bv)
+            else if (blk)
             {
-                sv_decode_visitor_func func(arr, (value_type(1) << i), 0);
-                bm::for_each_bit(*bv, func);
+                blk = BLOCK_ADDR_SAN(blk);
             }
-        } // for i
-    }
+            blks[p] = blk;
+            any_blk |= bool(blk);
+        } // for p
+        if (!any_blk)
+            continue;
+        
+        for (unsigned w = w0; w <= w1; ++w)
+        {
+            // 32 elements of the bit-block word w
+            size_type g = blk_base + (w << bm::set_word_shift);
+            bm::word_t mask = ~0u;
+            if (g < start)
+                mask <<= unsigned(start - g);
+            if (g + 32 > end)
+                mask &= ~0u >> unsigned(g + 32 - end);
+            
+            for (unsigned sl = 0; sl < slices; ++sl)
+            {
+                bm::word_t any_bits = 0;
+                for (unsigned p = 0; p < 32; ++p)
+                {
+                    const bm::word_t* blk = (sl * 32 + p < value_bits()) ? 
+                                                    blks[sl * 32 + p] : 0;
+                    bm::word_t pw = blk ? (blk[w] & mask) : 0;
+                    pbuf[p] = pw;
+                    any_bits |= pw;
+                }
+                if (!any_bits)
+                    continue;
+                bm::bit_transpose_32x32(pbuf, vbuf);
+                if (mask == ~0u)
+                {
+                    unsigned_value_type* dst = arr + (g - offset);
+                    for (unsigned k = 0; k < 32; ++k)
+                        dst[k] |= unsigned_value_type(
+                                    unsigned_value_type(vbuf[k]) << (sl * 32));
+                }
+                else // head or tail of the range
+                {
+                    for (unsigned k = 0; k < 32; ++k)
+                        if (mask & (1u << k))
+                            arr[g + k - offset] |= unsigned_value_type(
+                                    unsigned_value_type(vbuf[k]) << (sl * 32));
+                }
+            } // for sl
+        } // for w
+    } // for pos
+    decode_signed(varr, end - start);
 
     return end - start;
 }
@@ -1223,7 +1765,7 @@ sparse_vector<Val, BV>::get(bm::id_t i) const
 {
     BM_ASSERT(i < size_);
     
-    value_type v = 0;
+    unsigned_value_type v = 0;
     
     // calculate logical block coordinates and masks
     //
@@ -1268,35 +1810,35 @@ sparse_vector<Val, BV>::get(bm::id_t i) const
         if ((blk = blka[0+0])!=0)
         {
             unsigned is_set = (BM_IS_GAP(blk)) ? bm::gap_test_unr(BMGAP_PTR(blk), nbit) : (blk[nword] & mask0);
-            value_type vm = (bool) is_set;
+            unsigned_value_type vm = (bool) is_set;
             vm <<= (j+0);
             v |= vm;
         }
         if ((blk = blka[0+1])!=0)
         {
             unsigned is_set = (BM_IS_GAP(blk)) ? bm::gap_test_unr(BMGAP_PTR(blk), nbit) : (blk[nword] & mask0);
-            value_type vm = (bool) is_set;
+            unsigned_value_type vm = (bool) is_set;
             vm <<= (j+1);
             v |= vm;
         }
         if ((blk = blka[0+2])!=0)
         {
             unsigned is_set = (BM_IS_GAP(blk)) ? bm::gap_test_unr(BMGAP_PTR(blk), nbit) : (blk[nword] & mask0);
-            value_type vm = (bool) is_set;
+            unsigned_value_type vm = (bool) is_set;
             vm <<= (j+2);
             v |= vm;
         }
         if ((blk = blka[0+3])!=0)
         {
             unsigned is_set = (BM_IS_GAP(blk)) ? bm::gap_test_unr(BMGAP_PTR(blk), nbit) : (blk[nword] & mask0);
-            value_type vm = (bool) is_set;
+            unsigned_value_type vm = (bool) is_set;
             vm <<= (j+3);
             v |= vm;
         }
 
     } // for j
     
-    return v;
+    return value_traits_type::u2s(v);
 }
 
 
@@ -1361,8 +1903,10 @@ void sparse_vector<Val, BV>::set_value(size_type idx, value_type v)
 //---------------------------------------------------------------------
 
 template<class Val, class BV>
-void sparse_vector<Val, BV>::set_value_no_null(size_type idx, value_type v)
+void sparse_vector<Val, BV>::set_value_no_null(size_type idx, value_type val)
 {
+    unsigned_value_type v = value_traits_type::s2u(val);
+
     // calculate logical block coordinates and masks
     //
     unsigned nb = unsigned(idx >>  bm::set_block_shift);
@@ -1385,7 +1929,7 @@ void sparse_vector<Val, BV>::set_value_no_null(size_type idx, value_type v)
     }
     if (v)
     {
-        value_type mask = 1u;
+        unsigned_value_type mask = 1u;
         for (unsigned j = 0; j <= bsr; ++j)
         {
             if (v & mask)
@@ -1416,6 +1960,11 @@ void sparse_vector<Val, BV>::inc(size_type idx)
 {
     if (idx >= size_)
         size_ = idx+1;
+    if (value_traits_type::is_signed) // zigzag code has no binary carry
+    {
+        set_value(idx, value_type(get(idx) + 1));
+        return;
+    }
 
     for (unsigned i = 0; i < sv_value_plains; ++i)
     {
@@ -1458,8 +2007,11 @@ template<class Val, class BV>
 void sparse_vector<Val, BV>::destruct_bvector(bvector_type* bv) const
 {
 #ifdef BM_NO_STL   // C compatibility mode
-    bv->~TBM_bvector();
-    ::free((void*)bv);
+    if (bv)
+    {
+        bv->~bvector_type();
+        ::free((void*)bv);
+    }
 #else
     delete bv;
 #endif
@@ -1734,7 +2286,7 @@ void sparse_vector<Val, BV>::set_allocator_pool(
 
 template<class Val, class BV>
 sparse_vector<Val, BV>::const_iterator::const_iterator()
-: sv_(0), pos_(bm::id_max), buf_(0), buf_ptr_(0)
+: sv_(0), pos_(bm::id_max), buf_(0), buf_ptr_(0), buf_end_(0)
 {}
 
 template<class Val, class BV>
@@ -1750,15 +2302,52 @@ sparse_vector<Val, BV>::const_iterator::~const_iterator()
 template<class Val, class BV>
 sparse_vector<Val, BV>::const_iterator::const_iterator(
                         const typename sparse_vector<Val, BV>::const_iterator& it)
-: sv_(it.sv_), pos_(it.pos_), buf_(0), buf_ptr_(0)
-{}
+: sv_(it.sv_), pos_(it.pos_), buf_(0), buf_ptr_(0), buf_end_(0)
+{
+    copy_window(it);
+}
+
+//---------------------------------------------------------------------
+
+template<class Val, class BV>
+typename sparse_vector<Val, BV>::const_iterator&
+sparse_vector<Val, BV>::const_iterator::operator=(
+                        const typename sparse_vector<Val, BV>::const_iterator& it)
+{
+    if (this != &it)
+    {
+        sv_ = it.sv_;
+        pos_ = it.pos_;
+        buf_ptr_ = 0;
+        copy_window(it);
+    }
+    return *this;
+}
+
+//---------------------------------------------------------------------
+
+template<class Val, class BV>
+void sparse_vector<Val, BV>::const_iterator::copy_window(
+                        const typename sparse_vector<Val, BV>::const_iterator& it)
+{
+    if (!it.buf_ptr_)
+        return;
+    // a short head in the iterator itself keeps copies (postfix ++) 
+    // cheap, the window buffer is allocated when the rest gets decoded
+    size_type cnt = size_type(it.buf_end_ - it.buf_ptr_);
+    if (cnt > copy_size)
+        cnt = copy_size;
+    ::memcpy(head_, it.buf_ptr_, cnt * sizeof(value_type));
+    buf_ptr_ = head_;
+    buf_end_ = head_ + cnt;
+}
 
 //---------------------------------------------------------------------
 
 template<class Val, class BV>
 sparse_vector<Val, BV>::const_iterator::const_iterator(
   const typename sparse_vector<Val, BV>::const_iterator::sparse_vector_type* sv)
-: sv_(sv), buf_(0), buf_ptr_(0)
+: sv_(sv), buf_(0), buf_ptr_(0), buf_end_(0)
 {
     BM_ASSERT(sv_);
     pos_ = sv_->empty() ? bm::id_max : 0u;
@@ -1770,7 +2359,7 @@ template<class Val, class BV>
 sparse_vector<Val, BV>::const_iterator::const_iterator(
  const typename sparse_vector<Val, BV>::const_iterator::sparse_vector_type* sv,
  bm::id_t pos)
-: sv_(sv), buf_(0), buf_ptr_(0)
+: sv_(sv), buf_(0), buf_ptr_(0), buf_end_(0)
 {
     BM_ASSERT(sv_);
     this->go_to(pos);
@@ -1797,12 +2386,8 @@ void sparse_vector<Val, BV>::const_iterator::advance()
         pos_ = bm::id_max;
     else
     {
-        if (buf_ptr_)
-        {
-            ++buf_ptr_;
-            if (buf_ptr_ - buf_ >= buf_size)
-                buf_ptr_ = 0;
-        }
+        if (buf_ptr_ && ++buf_ptr_ == buf_end_) // end of the decode window
+            buf_ptr_ = 0;
     }
 }
 
@@ -1822,7 +2407,9 @@ sparse_vector<Val, BV>::const_iterator::value() const
             buf_ = (value_type*)::malloc(buf_size * sizeof(value_type));            
             BM_ASSERT_THROW(buf_, BM_ERR_BADALLOC);
         }
-        sv_->extract(buf_, buf_size, pos_, true, &pool_);
+        // window runs to the end of the current bit-block
+        size_type wlen = buf_size - (pos_ & (buf_size - 1));
+        buf_end_ = buf_ + sv_->decode(buf_, pos_, wlen, true);
         buf_ptr_ = buf_;
     }
     v = *buf_ptr_;
@@ -1840,6 +2427,140 @@ bool sparse_vector<Val, BV>::const_iterator::is_null() const
 }
 
 //---------------------------------------------------------------------
+//
+//---------------------------------------------------------------------
+
+template<class Val, class BV>
+sparse_vector<Val, BV>::back_insert_iterator::back_insert_iterator()
+: sv_(0), buf_(0), null_buf_(0), buf_cnt_(0), buf_cap_(0), any_null_(false)
+{}
+
+//---------------------------------------------------------------------
+
+template<class Val, class BV>
+sparse_vector<Val, BV>::back_insert_iterator::back_insert_iterator(
+   typename sparse_vector<Val, BV>::back_insert_iterator::sparse_vector_type* sv)
+: sv_(sv), buf_(0), null_buf_(0), buf_cnt_(0), buf_cap_(0), any_null_(false)
+{}
+
+//---------------------------------------------------------------------
+
+template<class Val, class BV>
+sparse_vector<Val, BV>::back_insert_iterator::back_insert_iterator(
+    const typename sparse_vector<Val, BV>::back_insert_iterator& bi)
+: sv_(bi.sv_), buf_(0), null_buf_(0), buf_cnt_(0), buf_cap_(0), 
+  any_null_(false)
+{
+    const_cast<back_insert_iterator&>(bi).flush();
+}
+
+//---------------------------------------------------------------------
+
+template<class Val, class BV>
+sparse_vector<Val, BV>::back_insert_iterator::~back_insert_iterator()
+{
+    this->flush();
+    if (buf_)
+        ::free(buf_);
+}
+
+//---------------------------------------------------------------------
+
+template<class Val, class BV>
+void sparse_vector<Val, BV>::back_insert_iterator::start_window()
+{
+    BM_ASSERT(sv_);
+    BM_ASSERT(!buf_cnt_);
+    if (!buf_)
+    {
+        size_t bytes = buf_size * sizeof(value_type) + buf_size / 8;
+        buf_ = (value_type*)::malloc(bytes);
+        BM_ASSERT_THROW(buf_, BM_ERR_BADALLOC);
+        null_buf_ = (bm::word_t*)(buf_ + buf_size);
+        ::memset(null_buf_, 0, buf_size / 8);
+    }
+    // window ends on the bit-block boundary for the block-wise import
+    buf_cap_ = buf_size - (sv_->size() & bm::set_block_mask);
+}
+
+//---------------------------------------------------------------------
+
+template<class Val, class BV>
+void sparse_vector<Val, BV>::back_insert_iterator::add(
+         typename sparse_vector<Val, BV>::back_insert_iterator::value_type v)
+{
+    if (!buf_cnt_)
+        start_window();
+    buf_[buf_cnt_++] = v;
+    if (buf_cnt_ == buf_cap_)
+        this->flush();
+}
+
+//---------------------------------------------------------------------
+
+template<class Val, class BV>
+void sparse_vector<Val, BV>::back_insert_iterator::add_null()
+{
+    if (!buf_cnt_)
+        start_window();
+    null_buf_[buf_cnt_ >> bm::set_word_shift] |= 
+                                    1u << (buf_cnt_ & bm::set_word_mask);
+    any_null_ = true;
+    buf_[buf_cnt_++] = 0;
+    if (buf_cnt_ == buf_cap_)
+        this->flush();
+}
+
+//---------------------------------------------------------------------
+
+template<class Val, class BV>
+void sparse_vector<Val, BV>::back_insert_iterator::add_null(
+    typename sparse_vector<Val, BV>::back_insert_iterator::size_type count)
+{
+    if (count < 256)
+    {
+        for (; count; --count)
+            this->add_null();
+        return;
+    }
+    // long NULL run: the vector tail is NULL (and 0) after resize
+    this->flush();
+    sv_->resize(sv_->size() + count);
+}
+
+//---------------------------------------------------------------------
+
+template<class Val, class BV>
+void sparse_vector<Val, BV>::back_insert_iterator::flush()
+{
+    if (!buf_cnt_)
+        return;
+    size_type offset = sv_->size();
+    sv_->import(buf_, buf_cnt_, offset);
+    if (any_null_)
+    {
+        bvector_type* bv_null = sv_->get_null_bvect();
+        unsigned wcnt = unsigned((buf_cnt_ + 31) >> bm::set_word_shift);
+        for (unsigned i = 0; i < wcnt; ++i)
+        {
+            bm::word_t w = null_buf_[i];
+            if (!w)
+                continue;
+            null_buf_[i] = 0;
+            if (!bv_null)
+                continue;
+            for (; w; w &= w - 1)
+            {
+                unsigned k = bm::word_bitcount((w & (0u - w)) - 1);
+                bv_null->clear_bit_no_check(offset + (i << bm::set_word_shift) + k);
+            }
+        } // for i
+        any_null_ = false;
+    }
+    buf_cnt_ = 0;
+}
+
+//---------------------------------------------------------------------
 
 
 
@@ -21,6 +21,11 @@ For more information please visit:  http://bitmagic.io
     \brief Algorithms for sparse_vector<>
 */
 
+#ifndef BM_NO_STL
+#include <vector>
+#include <algorithm>
+#endif
+
 #include "bmdef.h"
 #include "bmsparsevec.h"
 
@@ -206,6 +211,8 @@ class sparse_vector_scanner
 public:
     typedef typename SV::bvector_type       bvector_type;
     typedef typename SV::value_type         value_type;
+    typedef typename SV::unsigned_value_type unsigned_value_type;
+    typedef typename SV::value_traits_type  value_traits_type;
     typedef typename bvector_type::allocator_type::allocator_pool_type allocator_pool_type;
     
 public:
@@ -250,6 +257,10 @@ public:
 
     /**
         \brief find all values A IN (C, D, E, F)
+        
+        Single pass over the plains for the whole list (STL mode),
+        STL-free builds search values one by one.
+        
         \param  sv - input sparse vector
         \param  start - start iterator (set to search) 
         \param  end   - end iterator (set to search)
@@ -264,18 +275,123 @@ public:
         typename bvector_type::mem_pool_guard mp_guard;
         mp_guard.assign_if_not_set(pool_, bv_out); // set local memory pool
 
+#ifndef BM_NO_STL
+        // sorted unique values (plain codes) make a trie over the plains
+        std::vector<unsigned_value_type> vals;
+        for (; start != end; ++start)
+            vals.push_back(value_traits_type::s2u(*start));
+        if (!vals.empty())
+        {
+            std::sort(vals.begin(), vals.end());
+            vals.erase(std::unique(vals.begin(), vals.end()), vals.end());
+            find_eq_sorted(sv, &vals[0], unsigned(vals.size()), bv_out);
+        }
+#else
         bvector_type bv1;
         typename bvector_type::mem_pool_guard mp_guard1(pool_, bv1);
 
-        for (; start < end; ++start)
+        for (; start != end; ++start)
         {
             value_type v = *start;
             find_eq_with_nulls(sv, v, bv1);
             bv_out.bit_or(bv1);
         } // for
+#endif
         correct_nulls(sv, bv_out);
     }
 
+    /**
+        \brief find all sparse vector elements LT (less than) search value
+        \param sv - input sparse vector
+        \param value - value to compare with
+        \param bv_out - output bit-vector (search result masks 1 elements)
+    */
+    void find_lt(const SV&                  sv,
+                 typename SV::value_type    value,
+                 typename SV::bvector_type& bv_out);
+
+    /**
+        \brief find all sparse vector elements LE (less or equal) search value
+        \param sv - input sparse vector
+        \param value - value to compare with
+        \param bv_out - output bit-vector (search result masks 1 elements)
+    */
+    void find_le(const SV&                  sv,
+                 typename SV::value_type    value,
+                 typename SV::bvector_type& bv_out);
+
+    /**
+        \brief find all sparse vector elements GT (greater than) search value
+        \param sv - input sparse vector
+        \param value - value to compare with
+        \param bv_out - output bit-vector (search result masks 1 elements)
+    */
+    void find_gt(const SV&                  sv,
+                 typename SV::value_type    value,
+                 typename SV::bvector_type& bv_out);
+
+    /**
+        \brief find all sparse vector elements GE (greater or equal) search value
+        \param sv - input sparse vector
+        \param value - value to compare with
+        \param bv_out - output bit-vector (search result masks 1 elements)
+    */
+    void find_ge(const SV&                  sv,
+                 typename SV::value_type    value,
+                 typename SV::bvector_type& bv_out);
+
+    /**
+        \brief find all sparse vector elements in the closed range [from, to]
+        \param sv - input sparse vector
+        \param from - range start (included)
+        \param to - range end (included)
+        \param bv_out - output bit-vector (search result masks 1 elements)
+    */
+    void find_range(const SV&                  sv,
+                    typename SV::value_type    from,
+                    typename SV::value_type    to,
+                    typename SV::bvector_type& bv_out);
+
+    /**
+        \brief count sparse vector elements EQ to search value
+        (no result bit-vector is materialized)
+        \param sv - input sparse vector
+        \param value - value to search for
+        \return number of (not NULL) elements EQ to value
+    */
+    bm::id_t count_eq(const SV& sv, typename SV::value_type value);
+
+    /**
+        \brief check if any sparse vector element is EQ to search value
+        (stops on the first found block)
+        \param sv - input sparse vector
+        \param value - value to search for
+    */
+    bool any_eq(const SV& sv, typename SV::value_type value);
+
+    /**
+        \brief count sparse vector elements in a closed range [from..to]
+        (no result bit-vector is materialized)
+        \param sv - input sparse vector
+        \param from - range start (included)
+        \param to - range end (included)
+        \return number of (not NULL) elements in the range
+    */
+    bm::id_t count_range(const SV&               sv,
+                         typename SV::value_type from,
+                         typename SV::value_type to);
+
+    /**
+        \brief check if any sparse vector element is in a closed range 
+        [from..to] (stops on the first found block)
+        \param sv - input sparse vector
+        \param from - range start (included)
+        \param to - range end (included)
+    */
+    bool any_range(const SV&               sv,
+                   typename SV::value_type from,
+                   typename SV::value_type to);
+
     void find_eq_with_nulls(const SV&   sv,
         typename SV::value_type           value,
         typename SV::bvector_type&        bv_out);
@@ -285,6 +401,128 @@ public:
 
 
 protected:
+    /**
+        \brief all not NULL elements of the sparse vector
+    */
+    void find_all(const SV&                  sv,
+                  typename SV::bvector_type& bv_out);
+
+    /**
+        \brief block-wise EQ search, calls func(nb, blk) for every 
+        not empty block of the result, stops if func returns false
+        (NULL elements are excluded only for value 0)
+    */
+    template<class Func>
+    void find_eq_blocks(const SV& sv, unsigned_value_type value, Func& func);
+
+    /**
+        \brief block-wise range search, calls func(nb, blk) for every 
+        not empty block of the result, stops if func returns false
+        (signed range is split by sign into two ranges of plain codes)
+    */
+    template<class Func>
+    void find_range_blocks(const SV&  sv,
+                           value_type from,
+                           value_type to,
+                           Func&      func);
+
+    /**
+        \brief bit-sliced comparison of block nb with the search value
+        \param lt - [out] elements LT value (must be zero on entry)
+        \param eq - candidates on entry, elements EQ value on exit
+        \param tmp - GAP expand block
+        \return false if EQ is empty (eq content is then undefined)
+    */
+    bool find_lt_eq_block(const SV&           sv,
+                          unsigned            nb,
+                          unsigned_value_type value,
+                          bm::word_t*         lt,
+                          bm::word_t*         eq,
+                          bm::word_t*         tmp);
+
+    /**
+        \brief elements of block nb with plain codes in [from, to]
+        \param cand - candidates block
+        \param le - [out] result block
+        \param eq, lt, tmp - work blocks
+        \return false if the result is empty
+    */
+    bool find_range_block(const SV&           sv,
+                          unsigned            nb,
+                          const bm::word_t*   cand,
+                          unsigned_value_type from,
+                          unsigned_value_type to,
+                          bm::word_t*         le,
+                          bm::word_t*         eq,
+                          bm::word_t*         lt,
+                          bm::word_t*         tmp);
+
+    /// result block functor: OR into the target bit-vector
+    struct block_or_func
+    {
+        block_or_func(bvector_type& bv) : bv_(bv) {}
+        bool operator()(unsigned nb, const bm::word_t* blk)
+        {
+            bv_.combine_operation_with_block(nb, blk, false, BM_OR);
+            return true;
+        }
+        bvector_type& bv_;
+    };
+
+    /// result block functor: population count
+    struct block_count_func
+    {
+        block_count_func() : cnt_(0) {}
+        bool operator()(unsigned, const bm::word_t* blk)
+        {
+            cnt_ += bm::bit_block_calc_count(blk, blk + bm::set_block_size);
+            return true;
+        }
+        bm::id_t cnt_;
+    };
+
+    /// result block functor: first found block stops the search
+    struct block_any_func
+    {
+        block_any_func() : any_(false) {}
+        bool operator()(unsigned, const bm::word_t*)
+        {
+            any_ = true;
+            return false;
+        }
+        bool any_;
+    };
+
+    /// Per block state of the IN-list search
+    struct in_block_state
+    {
+        const bm::word_t* pblk[sizeof(value_type) * 8]; ///< plain blocks
+        bm::word_t*       gblk[sizeof(value_type) * 8]; ///< GAP expand blocks
+        bm::word_t*       tblk[sizeof(value_type) * 8]; ///< level temp blocks
+        bm::word_t*       res;                          ///< result block
+        bool              res_any;                      ///< result is not empty
+    };
+
+    /**
+        \brief OR all elements EQ to any of sorted unique values 
+        into the result (block by block, values as a trie over the plains)
+    */
+    void find_eq_sorted(const SV&                  sv,
+                        const unsigned_value_type* vals,
+                        unsigned                   vals_size,
+                        typename SV::bvector_type& bv_out);
+
+    /**
+        \brief search candidates block for values [lo, hi) 
+        which share all bits above plain i
+    */
+    void find_eq_in_block(in_block_state&            st,
+                          const unsigned_value_type* vals,
+                          unsigned                   lo,
+                          unsigned                   hi,
+                          unsigned                   i,
+                          bm::word_t*                cand);
+
     sparse_vector_scanner(const sparse_vector_scanner&) = delete;
     void operator=(const sparse_vector_scanner&) = delete;
 private:
@@ -346,51 +584,323 @@ void sparse_vector_scanner<SV>::find_eq_with_nulls(const SV&  sv,
         return;
     }
 
-    unsigned char bits[sizeof(value) * 8];
-    unsigned short bit_count_v = bm::bitscan(value, bits);
-    BM_ASSERT(bit_count_v);
+    bv_out.clear(true);
+    block_or_func func(bv_out);
+    find_eq_blocks(sv, value_traits_type::s2u(value), func);
+}
 
-    // aggregate AND all matching vectors
-    //
+//----------------------------------------------------------------------------
+
+template<typename SV> template<class Func>
+void sparse_vector_scanner<SV>::find_eq_blocks(const SV&           sv,
+                                               unsigned_value_type value,
+                                               Func&               func)
+{
+    if (sv.empty())
+        return;
+    
+    // all mandatory plains must be present, the highest one drives the scan
+    unsigned char bits[sizeof(value) * 8];
+    unsigned bit_count_v = value ? bm::bitscan(value, bits) : 0;
+    const bvector_type* bv_plains[sizeof(value) * 8];
+    for (unsigned i = 0; i < bit_count_v; ++i)
     {
-        const bvector_type* bv_plain = sv.get_plain(bits[--bit_count_v]);
-        if (bv_plain)
+        bv_plains[i] = sv.get_plain(bits[i]);
+        if (!bv_plains[i]) // mandatory plain not found - empty result!
+            return;
+    }
+    
+    bvector_type bv_all;
+    typename bvector_type::mem_pool_guard mp_guard(pool_, bv_all);
+    const bvector_type* bv_top;
+    if (bit_count_v)
+        bv_top = bv_plains[--bit_count_v];
+    else // 0 is searched in all not NULL elements
+    {
+        bv_top = sv.get_null_bvector();
+        if (!bv_top)
         {
-            bv_out = *bv_plain;
+            find_all(sv, bv_all);
+            bv_top = &bv_all;
         }
-        else // plain not found
+    }
+    
+    unsigned sv_plains = sv.effective_plains();
+    
+    bm::bit_blocks_buffer<typename bvector_type::allocator_type> 
+                                        bbuf(bv_top->get_allocator(), 1);
+    bm::word_t* blk = 0;
+    
+    unsigned nb_last = unsigned((sv.size() - 1) >> bm::set_block_shift);
+    for (unsigned nb = 0; nb <= nb_last; ++nb)
+    {
+        const bm::word_t* top_blk = bv_top->get_block(nb);
+        if (!top_blk) // block absent in the first mandatory plain
+            continue;
+        if (!blk)
+            blk = bbuf.block(0);
+        if (BM_IS_GAP(top_blk))
+            bm::gap_convert_to_bitset(blk, BMGAP_PTR(top_blk));
+        else
+            bm::bit_block_copy(blk, top_blk);
+        
+        // AND all other mandatory plain blocks
+        bool any = true;
+        for (unsigned i = 0; i < bit_count_v && any; ++i)
+        {
+            const bm::word_t* pb = bv_plains[i]->get_block(nb);
+            if (!pb)
+                any = false;
+            else
+            if (BM_IS_GAP(pb))
+            {
+                bm::gap_and_to_bitset(blk, BMGAP_PTR(pb));
+                any = !bm::bit_is_all_zero(blk, blk + bm::set_block_size);
+            }
+            else
+                any = bm::bit_block_and(blk, pb);
+        } // for i
+
+        // SUB all other plain blocks
+        for (unsigned i = 0; i < sv_plains && any; ++i)
         {
-            bv_out.clear(true);
+            if (value & (unsigned_value_type(1) << i))
+                continue;
+            const bvector_type* bv_plain = sv.get_plain(i);
+            const bm::word_t* pb = bv_plain ? bv_plain->get_block(nb) : 0;
+            if (!pb)
+                continue;
+            if (BM_IS_GAP(pb))
+            {
+                bm::gap_sub_to_bitset(blk, BMGAP_PTR(pb));
+                any = !bm::bit_is_all_zero(blk, blk + bm::set_block_size);
+            }
+            else
+                any = bm::bit_block_sub(blk, pb);
+        } // for i
+        
+        if (any && !func(nb, blk))
             return;
-        }
+    } // for nb
+}
+
+//----------------------------------------------------------------------------
+
+template<typename SV> template<class Func>
+void sparse_vector_scanner<SV>::find_range_blocks(const SV&  sv,
+                                                  value_type from,
+                                                  value_type to,
+                                                  Func&      func)
+{
+    if (sv.empty() || from > to)
+        return;
+    
+    // plain code ranges: unsigned values are searched as is,
+    // signed range is split into negatives [from..-1] (codes with 1 in 
+    // the sign plain, code grows with magnitude) and non-negatives [0..to]
+    unsigned_value_type ufrom[2], uto[2];
+    bool neg[2] = { false, false };
+    unsigned parts = 0;
+    unsigned_value_type cfrom = value_traits_type::s2u(from);
+    unsigned_value_type cto = value_traits_type::s2u(to);
+    if (!value_traits_type::is_signed)
+    {
+        ufrom[0] = cfrom; uto[0] = cto;
+        parts = 1;
     }
-    for (unsigned i = 0; i < bit_count_v; ++i)
+    else
     {
-        const bvector_type* bv_plain = sv.get_plain(bits[i]);
-        if (bv_plain)
+        if (cfrom & 1) // from < 0
         {
-            bv_out &= *bv_plain;
-            // TODO: better detect when accumulator is empty to break early
+            ufrom[parts] = (cto & 1) ? cto : 1u; // s2u(-1) == 1
+            uto[parts] = cfrom;
+            neg[parts++] = true;
         }
-        else // mandatory plain not found - empty result!
+        if (!(cto & 1)) // to >= 0
         {
-            bv_out.clear(true);
-            return;
+            ufrom[parts] = (cfrom & 1) ? 0u : cfrom;
+            uto[parts++] = cto;
         }
-    } // for i
+    }
+    
+    bvector_type bv_all;
+    typename bvector_type::mem_pool_guard mp_guard(pool_, bv_all);
+    const bvector_type* bv_cand = sv.get_null_bvector();
+    if (!bv_cand)
+    {
+        find_all(sv, bv_all);
+        bv_cand = &bv_all;
+    }
+    const bvector_type* bv_sign = sv.get_plain(0);
+    
+    // blocks: result, LE to, EQ, LT from, GAP expand
+    bm::bit_blocks_buffer<typename bvector_type::allocator_type> 
+                                        bbuf(bv_cand->get_allocator(), 5);
+    bm::word_t* res = bbuf.block(0);
+    bm::word_t* le = bbuf.block(1);
+    bm::word_t* eq = bbuf.block(2);
+    bm::word_t* lt = bbuf.block(3);
+    bm::word_t* tmp = bbuf.block(4);
+    
+    unsigned nb_last = unsigned((sv.size() - 1) >> bm::set_block_shift);
+    for (unsigned nb = 0; nb <= nb_last; ++nb)
+    {
+        const bm::word_t* cand = bv_cand->get_block(nb);
+        if (!cand)
+            continue;
+        bool any = false;
+        for (unsigned k = 0; k < parts; ++k)
+        {
+            bm::word_t* blk = any ? le : res;
+            if (!find_range_block(sv, nb, cand, ufrom[k], uto[k], 
+                                  blk, eq, lt, tmp))
+                continue;
+            if (value_traits_type::is_signed) // filter by the sign plain
+            {
+                const bm::word_t* sb = bv_sign ? bv_sign->get_block(nb) : 0;
+                if (BM_IS_GAP(sb))
+                {
+                    bm::gap_convert_to_bitset(tmp, BMGAP_PTR(sb));
+                    sb = tmp;
+                }
+                bool part_any = neg[k] ? (sb && bm::bit_block_and(blk, sb))
+                                       : (!sb || bm::bit_block_sub(blk, sb));
+                if (!part_any)
+                    continue;
+            }
+            if (any)
+                bm::bit_block_or(res, le);
+            any = true;
+        } // for k
+        if (any && !func(nb, res))
+            return;
+    } // for nb
+}
 
-    // SUB all other plains
+//----------------------------------------------------------------------------
+
+template<typename SV>
+bool sparse_vector_scanner<SV>::find_range_block(const SV&           sv,
+                                                 unsigned            nb,
+                                                 const bm::word_t*   cand,
+                                                 unsigned_value_type from,
+                                                 unsigned_value_type to,
+                                                 bm::word_t*         le,
+                                                 bm::word_t*         eq,
+                                                 bm::word_t*         lt,
+                                                 bm::word_t*         tmp)
+{
+    // LE to = LT to | EQ to
+    bm::bit_block_set(le, 0);
+    if (BM_IS_GAP(cand))
+        bm::gap_convert_to_bitset(eq, BMGAP_PTR(cand));
+    else
+        bm::bit_block_copy(eq, cand);
+    if (find_lt_eq_block(sv, nb, to, le, eq, tmp))
+        bm::bit_block_or(le, eq);
+    else
+    if (bm::bit_is_all_zero(le, le + bm::set_block_size))
+        return false;
+    
+    // SUB LT from
+    if (from)
+    {
+        bm::bit_block_set(lt, 0);
+        if (BM_IS_GAP(cand))
+            bm::gap_convert_to_bitset(eq, BMGAP_PTR(cand));
+        else
+            bm::bit_block_copy(eq, cand);
+        find_lt_eq_block(sv, nb, from, lt, eq, tmp);
+        return bm::bit_block_sub(le, lt);
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+bool sparse_vector_scanner<SV>::find_lt_eq_block(const SV&           sv,
+                                                 unsigned            nb,
+                                                 unsigned_value_type value,
+                                                 bm::word_t*         lt,
+                                                 bm::word_t*         eq,
+                                                 bm::word_t*         tmp)
+{
+    // classic bit-sliced index comparison: candidates EQ so far are split
+    // by every plain from the top, when search value has 1 in the plain
+    // candidates with 0 fall into LT
     //
-    unsigned sv_plains = sv.effective_plains();
-    for (unsigned i = 0; (i < sv_plains) && value; ++i)
+    for (unsigned i = sv.plains(); i-- > 0; )
     {
         const bvector_type* bv_plain = sv.get_plain(i);
-        if (bv_plain && !(value & (value_type(1) << i)))
+        const bm::word_t* pb = bv_plain ? bv_plain->get_block(nb) : 0;
+        if (BM_IS_GAP(pb))
+        {
+            bm::gap_convert_to_bitset(tmp, BMGAP_PTR(pb));
+            pb = tmp;
+        }
+        if (value & (unsigned_value_type(1) << i))
         {
-            // TODO: better detect when result is empty to break early
-            bv_out -= *bv_plain;
+            // LT |= EQ - plain; EQ &= plain
+            bm::bit_block_or(lt, eq);
+            if (!pb) // all candidates have 0 here
+                return false;
+            bool any = bm::bit_block_and(eq, pb);
+            bm::bit_block_sub(lt, eq);
+            if (!any)
+                return false;
         }
+        else
+        if (pb && !bm::bit_block_sub(eq, pb))
+            return false;
     } // for i
+    return true;
+}
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+bm::id_t sparse_vector_scanner<SV>::count_eq(const SV& sv, 
+                                             typename SV::value_type value)
+{
+    block_count_func func;
+    find_eq_blocks(sv, value_traits_type::s2u(value), func);
+    return func.cnt_;
+}
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+bool sparse_vector_scanner<SV>::any_eq(const SV& sv, 
+                                       typename SV::value_type value)
+{
+    block_any_func func;
+    find_eq_blocks(sv, value_traits_type::s2u(value), func);
+    return func.any_;
+}
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+bm::id_t sparse_vector_scanner<SV>::count_range(const SV&               sv,
+                                                typename SV::value_type from,
+                                                typename SV::value_type to)
+{
+    block_count_func func;
+    find_range_blocks(sv, from, to, func);
+    return func.cnt_;
+}
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+bool sparse_vector_scanner<SV>::any_range(const SV&               sv,
+                                          typename SV::value_type from,
+                                          typename SV::value_type to)
+{
+    block_any_func func;
+    find_range_blocks(sv, from, to, func);
+    return func.any_;
 }
 
 //----------------------------------------------------------------------------
@@ -438,6 +948,666 @@ void sparse_vector_scanner<SV>::find_nonzero(const SV& sv,
         bv_out.clear(true);
 }
 
+//----------------------------------------------------------------------------
+
+template<typename SV>
+void sparse_vector_scanner<SV>::find_all(const SV&                  sv,
+                                         typename SV::bvector_type& bv_out)
+{
+    const bvector_type* bv_null = sv.get_null_bvector();
+    if (bv_null)
+    {
+        bv_out = *bv_null;
+        return;
+    }
+    bv_out.clear(true);
+    if (sv.size())
+        bv_out.set_range(0, sv.size() - 1);
+}
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+void sparse_vector_scanner<SV>::find_eq_sorted(const SV&          sv,
+                                          const unsigned_value_type* vals,
+                                          unsigned                   vals_size,
+                                          typename SV::bvector_type& bv_out)
+{
+    if (sv.empty() || !vals_size)
+        return;
+    
+    const unsigned sv_plains = sv.plains();
+    
+    bvector_type bv_all;
+    typename bvector_type::mem_pool_guard mp_guard(pool_, bv_all);
+    find_all(sv, bv_all);
+    
+    // blocks: GAP expansions, level temps, top candidates, result
+    bm::bit_blocks_buffer<typename bvector_type::allocator_type> 
+                            bbuf(bv_out.get_allocator(), 2 * sv_plains + 2);
+    in_block_state st;
+    for (unsigned i = 0; i < sv_plains; ++i)
+    {
+        st.gblk[i] = bbuf.block(i);
+        st.tblk[i] = bbuf.block(sv_plains + i);
+    }
+    bm::word_t* cand = bbuf.block(2 * sv_plains);
+    st.res = bbuf.block(2 * sv_plains + 1);
+    bm::bit_block_set(st.res, 0);
+    
+    unsigned nb_last = unsigned((sv.size() - 1) >> bm::set_block_shift);
+    for (unsigned nb = 0; nb <= nb_last; ++nb)
+    {
+        const bm::word_t* blk = bv_all.get_block(nb);
+        if (!blk)
+            continue;
+        if (BM_IS_GAP(blk))
+            bm::gap_convert_to_bitset(cand, BMGAP_PTR(blk));
+        else
+            bm::bit_block_copy(cand, blk);
+        
+        for (unsigned i = 0; i < sv_plains; ++i)
+        {
+            const bvector_type* bv_plain = sv.get_plain(i);
+            st.pblk[i] = bv_plain ? bv_plain->get_block(nb) : 0;
+        }
+        st.res_any = false;
+        find_eq_in_block(st, vals, 0, vals_size, sv_plains - 1, cand);
+        if (st.res_any)
+        {
+            bv_out.combine_operation_with_block(nb, st.res, false, BM_OR);
+            bm::bit_block_set(st.res, 0);
+        }
+    } // for nb
+}
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+void sparse_vector_scanner<SV>::find_eq_in_block(in_block_state&   st,
+                                        const unsigned_value_type* vals,
+                                        unsigned                   lo,
+                                        unsigned                   hi,
+                                        unsigned                   i,
+                                        bm::word_t*                cand)
+{
+    BM_ASSERT(lo < hi);
+    for (;;)
+    {
+        const bm::word_t* pb = st.pblk[i];
+        if (BM_IS_GAP(pb)) // expand GAP plain block on first use
+        {
+            bm::gap_convert_to_bitset(st.gblk[i], BMGAP_PTR(pb));
+            pb = st.pblk[i] = st.gblk[i];
+        }
+        
+        // values with 1 in plain i are at the end of the range
+        const unsigned_value_type mask = 
+                            unsigned_value_type(unsigned_value_type(1) << i);
+        unsigned split = lo, cnt = hi - lo;
+        while (cnt)
+        {
+            unsigned half = cnt >> 1;
+            if (vals[split + half] & mask)
+                cnt = half;
+            else
+            {
+                split += half + 1; cnt -= half + 1;
+            }
+        }
+        
+        if (split < hi) // branch with 1 in plain i
+        {
+            if (pb)
+            {
+                if (split == lo) // no branching: narrow candidates in place
+                {
+                    if (!bm::bit_block_and(cand, pb))
+                        return;
+                    if (!i)
+                        break;
+                    --i;
+                    continue;
+                }
+                bm::word_t* cand1 = st.tblk[i];
+                bm::bit_block_copy(cand1, cand);
+                if (bm::bit_block_and(cand1, pb))
+                {
+                    if (i)
+                        find_eq_in_block(st, vals, split, hi, i - 1, cand1);
+                    else
+                    {
+                        bm::bit_block_or(st.res, cand1);
+                        st.res_any = true;
+                    }
+                }
+            }
+            else if (split == lo) // plain is empty, nothing has 1 here
+                return;
+            hi = split;
+        }
+        // branch with 0 in plain i
+        if (pb && !bm::bit_block_sub(cand, pb))
+            return;
+        if (!i)
+            break;
+        --i;
+    } // for
+    bm::bit_block_or(st.res, cand);
+    st.res_any = true;
+}
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+void sparse_vector_scanner<SV>::find_lt(const SV&                  sv,
+                                        typename SV::value_type    value,
+                                        typename SV::bvector_type& bv_out)
+{
+    if (value == value_traits_type::min_value())
+    {
+        bv_out.clear(true);
+        return;
+    }
+    find_range(sv, value_traits_type::min_value(), value_type(value - 1), bv_out);
+}
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+void sparse_vector_scanner<SV>::find_le(const SV&                  sv,
+                                        typename SV::value_type    value,
+                                        typename SV::bvector_type& bv_out)
+{
+    find_range(sv, value_traits_type::min_value(), value, bv_out);
+}
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+void sparse_vector_scanner<SV>::find_gt(const SV&                  sv,
+                                        typename SV::value_type    value,
+                                        typename SV::bvector_type& bv_out)
+{
+    if (value == value_traits_type::max_value())
+    {
+        bv_out.clear(true);
+        return;
+    }
+    find_range(sv, value_type(value + 1), value_traits_type::max_value(), bv_out);
+}
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+void sparse_vector_scanner<SV>::find_ge(const SV&                  sv,
+                                        typename SV::value_type    value,
+                                        typename SV::bvector_type& bv_out)
+{
+    find_range(sv, value, value_traits_type::max_value(), bv_out);
+}
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+void sparse_vector_scanner<SV>::find_range(const SV&                  sv,
+                                           typename SV::value_type    from,
+                                           typename SV::value_type    to,
+                                           typename SV::bvector_type& bv_out)
+{
+    bv_out.clear(true);
+    typename bvector_type::mem_pool_guard mp_guard;
+    mp_guard.assign_if_not_set(pool_, bv_out);
+    
+    block_or_func func(bv_out);
+    find_range_blocks(sv, from, to, func);
+}
+
+/**
+    \brief aggregate functions on sparse vector (bit-sliced)
+
+    Aggregates are computed from bit-plains without decoding values:
+    SUM is a weighted sum of plain bitcounts (AND with the filter mask),
+    MIN and MAX narrow down the candidates set plain by plain 
+    from the most significant one.
+    Signed values are handled via the sign plain of the zigzag code
+    (see bm::sv_value_traits), NULL elements are ignored.
+ 
+    @ingroup svalgo
+*/
+template<typename SV>
+class sparse_vector_aggregator
+{
+public:
+    typedef typename SV::bvector_type       bvector_type;
+    typedef typename SV::value_type         value_type;
+    typedef typename SV::unsigned_value_type unsigned_value_type;
+    typedef typename SV::value_traits_type  value_traits_type;
+    typedef typename bvector_type::allocator_type::allocator_pool_type allocator_pool_type;
+
+public:
+    sparse_vector_aggregator() {}
+
+    /**
+        \brief count of not NULL elements under the filter mask
+        \param sv - input sparse vector
+        \param bv_mask - filter mask (0 - all elements)
+    */
+    bm::id_t count(const SV& sv, const bvector_type* bv_mask = 0);
+
+    /**
+        \brief sum of elements under the filter mask
+        (computed modulo 2^64, for signed types it is a two's complement
+        of the sum: cast it to a signed 64-bit type)
+        \param sv - input sparse vector
+        \param bv_mask - filter mask (0 - all elements)
+    */
+    bm::id64_t sum(const SV& sv, const bvector_type* bv_mask = 0);
+
+    /**
+        \brief minimal element under the filter mask
+        \param sv - input sparse vector
+        \param bv_mask - filter mask (0 - all elements)
+        \param min_v - [out] minimal value
+        \return false if there are no not NULL elements under the mask
+    */
+    bool find_min(const SV& sv, const bvector_type* bv_mask, value_type& min_v);
+
+    /**
+        \brief maximal element under the filter mask
+        \param sv - input sparse vector
+        \param bv_mask - filter mask (0 - all elements)
+        \param max_v - [out] maximal value
+        \return false if there are no not NULL elements under the mask
+    */
+    bool find_max(const SV& sv, const bvector_type* bv_mask, value_type& max_v);
+
+    /**
+        \brief average of elements under the filter mask
+        \param sv - input sparse vector
+        \param bv_mask - filter mask (0 - all elements)
+        \param avg - [out] average value
+        \return false if there are no not NULL elements under the mask
+    */
+    bool average(const SV& sv, const bvector_type* bv_mask, double& avg);
+
+protected:
+    /// all not NULL elements under the mask
+    void find_candidates(const SV&           sv,
+                         const bvector_type* bv_mask,
+                         bvector_type&       bv_out);
+
+    /// narrow candidates down to the minimal plain code
+    unsigned_value_type find_min_code(const SV& sv, bvector_type& bv_cand);
+
+    /// narrow candidates down to the maximal plain code
+    unsigned_value_type find_max_code(const SV& sv, bvector_type& bv_cand);
+
+protected:
+    sparse_vector_aggregator(const sparse_vector_aggregator&) = delete;
+    void operator=(const sparse_vector_aggregator&) = delete;
+private:
+    allocator_pool_type  pool_;
+};
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+void sparse_vector_aggregator<SV>::find_candidates(const SV&           sv,
+                                                   const bvector_type* bv_mask,
+                                                   bvector_type&       bv_out)
+{
+    const bvector_type* bv_null = sv.get_null_bvector();
+    if (bv_null)
+    {
+        bv_out = *bv_null;
+    }
+    else
+    {
+        bv_out.clear(true);
+        if (sv.size())
+            bv_out.set_range(0, sv.size() - 1);
+    }
+    if (bv_mask)
+        bv_out.bit_and(*bv_mask);
+}
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+bm::id_t sparse_vector_aggregator<SV>::count(const SV&           sv,
+                                             const bvector_type* bv_mask)
+{
+    if (sv.empty())
+        return 0;
+    const bvector_type* bv_null = sv.get_null_bvector();
+    if (bv_null)
+        return bv_mask ? bm::count_and(*bv_null, *bv_mask) : bv_null->count();
+    return bv_mask ? bv_mask->count_range(0, sv.size() - 1) : sv.size();
+}
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+bm::id64_t sparse_vector_aggregator<SV>::sum(const SV&           sv,
+                                             const bvector_type* bv_mask)
+{
+    bm::id64_t acc = 0;
+    unsigned sv_plains = sv.effective_plains();
+    if (!value_traits_type::is_signed)
+    {
+        for (unsigned i = 0; i < sv_plains; ++i)
+        {
+            const bvector_type* bv_plain = sv.get_plain(i);
+            if (!bv_plain)
+                continue;
+            bm::id64_t cnt = bv_mask ? bm::count_and(*bv_plain, *bv_mask) 
+                                     : bv_plain->count();
+            acc += cnt << i;
+        } // for i
+        return acc;
+    }
+    
+    // zigzag code: v = m for non-negatives, v = -m - 1 for negatives
+    // (m - magnitude code in plains 1..N, plain 0 is the sign)
+    bvector_type bv_neg;
+    typename bvector_type::mem_pool_guard mp_guard(pool_, bv_neg);
+    const bvector_type* bv_sign = sv.get_plain(0);
+    if (bv_sign)
+    {
+        bv_neg = *bv_sign;
+        if (bv_mask)
+            bv_neg.bit_and(*bv_mask);
+    }
+    bool any_neg = bv_neg.any();
+    for (unsigned i = 1; i < sv_plains; ++i)
+    {
+        const bvector_type* bv_plain = sv.get_plain(i);
+        if (!bv_plain)
+            continue;
+        bm::id64_t cnt = bv_mask ? bm::count_and(*bv_plain, *bv_mask) 
+                                 : bv_plain->count();
+        bm::id64_t cnt_neg = any_neg ? bm::count_and(*bv_plain, bv_neg) : 0;
+        acc += (cnt - 2 * cnt_neg) << (i - 1);
+    } // for i
+    if (any_neg)
+        acc -= bv_neg.count();
+    return acc;
+}
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+typename sparse_vector_aggregator<SV>::unsigned_value_type 
+sparse_vector_aggregator<SV>::find_min_code(const SV& sv, bvector_type& bv_cand)
+{
+    // at every plain keep candidates with 0 if there are any
+    unsigned_value_type u = 0;
+    for (unsigned i = sv.effective_plains(); i-- > 0; )
+    {
+        const bvector_type* bv_plain = sv.get_plain(i);
+        if (!bv_plain)
+            continue;
+        if (bm::any_sub(bv_cand, *bv_plain))
+            bv_cand.bit_sub(*bv_plain);
+        else // all candidates have 1 in this plain
+            u |= unsigned_value_type(unsigned_value_type(1) << i);
+    } // for i
+    return u;
+}
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+typename sparse_vector_aggregator<SV>::unsigned_value_type 
+sparse_vector_aggregator<SV>::find_max_code(const SV& sv, bvector_type& bv_cand)
+{
+    // at every plain keep candidates with 1 if there are any
+    unsigned_value_type u = 0;
+    for (unsigned i = sv.effective_plains(); i-- > 0; )
+    {
+        const bvector_type* bv_plain = sv.get_plain(i);
+        if (!bv_plain)
+            continue;
+        if (bm::any_and(bv_cand, *bv_plain))
+        {
+            bv_cand.bit_and(*bv_plain);
+            u |= unsigned_value_type(unsigned_value_type(1) << i);
+        }
+    } // for i
+    return u;
+}
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+bool sparse_vector_aggregator<SV>::find_min(const SV&           sv,
+                                            const bvector_type* bv_mask,
+                                            value_type&         min_v)
+{
+    bvector_type bv_cand;
+    typename bvector_type::mem_pool_guard mp_guard(pool_, bv_cand);
+    find_candidates(sv, bv_mask, bv_cand);
+    if (!bv_cand.any())
+        return false;
+    
+    if (value_traits_type::is_signed)
+    {
+        // negative with the largest magnitude code wins
+        const bvector_type* bv_sign = sv.get_plain(0);
+        if (bv_sign && bm::any_and(bv_cand, *bv_sign))
+        {
+            bv_cand.bit_and(*bv_sign);
+            min_v = value_traits_type::u2s(find_max_code(sv, bv_cand));
+            return true;
+        }
+    }
+    min_v = value_traits_type::u2s(find_min_code(sv, bv_cand));
+    return true;
+}
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+bool sparse_vector_aggregator<SV>::find_max(const SV&           sv,
+                                            const bvector_type* bv_mask,
+                                            value_type&         max_v)
+{
+    bvector_type bv_cand;
+    typename bvector_type::mem_pool_guard mp_guard(pool_, bv_cand);
+    find_candidates(sv, bv_mask, bv_cand);
+    if (!bv_cand.any())
+        return false;
+    
+    if (value_traits_type::is_signed)
+    {
+        const bvector_type* bv_sign = sv.get_plain(0);
+        if (bv_sign)
+        {
+            // all negative: the smallest magnitude code wins
+            if (!bm::any_sub(bv_cand, *bv_sign))
+            {
+                max_v = value_traits_type::u2s(find_min_code(sv, bv_cand));
+                return true;
+            }
+            bv_cand.bit_sub(*bv_sign);
+        }
+    }
+    max_v = value_traits_type::u2s(find_max_code(sv, bv_cand));
+    return true;
+}
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+bool sparse_vector_aggregator<SV>::average(const SV&           sv,
+                                           const bvector_type* bv_mask,
+                                           double&             avg)
+{
+    bm::id_t cnt = count(sv, bv_mask);
+    if (!cnt)
+        return false;
+    bm::id64_t s = sum(sv, bv_mask);
+    double dsum = value_traits_type::is_signed ? double((long long)s) : double(s);
+    avg = dsum / double(cnt);
+    return true;
+}
+
+/**
+    \brief algorithms for str_sparse_vector scan/seach
+
+    Search runs block by block over character position plains
+    (the search string is converted to plain codes), no strings are decoded.
+
+    @ingroup svalgo
+*/
+template<typename SV>
+class str_sparse_vector_scanner
+{
+public:
+    typedef typename SV::bvector_type       bvector_type;
+    typedef typename SV::value_type         value_type;
+    typedef typename bvector_type::allocator_type::allocator_pool_type allocator_pool_type;
+
+public:
+    str_sparse_vector_scanner() {}
+
+    /**
+        \brief find all elements EQ to the search string
+        \param sv - input str sparse vector
+        \param str - zero terminated string to search for
+        \param bv_out - output bit-vector (search result masks 1 elements)
+    */
+    void find_eq(const SV&         sv,
+                 const value_type* str,
+                 bvector_type&     bv_out)
+    {
+        find_str(sv, str, false, bv_out);
+    }
+
+    /**
+        \brief find all elements starting with the prefix
+        (empty prefix finds all not NULL elements)
+        \param sv - input str sparse vector
+        \param prefix - zero terminated prefix to search for
+        \param bv_out - output bit-vector (search result masks 1 elements)
+    */
+    void find_prefix(const SV&         sv,
+                     const value_type* prefix,
+                     bvector_type&     bv_out)
+    {
+        find_str(sv, prefix, true, bv_out);
+    }
+
+protected:
+    /**
+        \brief block-wise string search: every character position narrows
+        down the candidates (AND plains with 1 in the code, SUB plains
+        with 0), EQ search also requires 0 code after the string
+    */
+    void find_str(const SV&         sv,
+                  const value_type* str,
+                  bool              prefix,
+                  bvector_type&     bv_out);
+
+protected:
+    str_sparse_vector_scanner(const str_sparse_vector_scanner&) = delete;
+    void operator=(const str_sparse_vector_scanner&) = delete;
+private:
+    allocator_pool_type  pool_;
+};
+
+//----------------------------------------------------------------------------
+
+template<typename SV>
+void str_sparse_vector_scanner<SV>::find_str(const SV&         sv,
+                                             const value_type* str,
+                                             bool              prefix,
+                                             bvector_type&     bv_out)
+{
+    bv_out.clear(true);
+    if (sv.empty())
+        return;
+    typename bvector_type::mem_pool_guard mp_guard;
+    mp_guard.assign_if_not_set(pool_, bv_out);
+
+    // plain codes of the search string (truncated as stored strings are)
+    unsigned char codes[SV::max_str_size + 1];
+    unsigned len = 0;
+    for (; len < unsigned(SV::max_str_size) && str[len]; ++len)
+    {
+        if (!sv.char_to_code(str[len], codes[len]))
+            return; // character is not in the vector
+    }
+    unsigned cmp_len = len;
+    if (!prefix && len < unsigned(SV::max_str_size))
+        codes[cmp_len++] = 0; // string terminator
+    
+    bvector_type bv_all;
+    typename bvector_type::mem_pool_guard mp_guard_all(pool_, bv_all);
+    const bvector_type* bv_cand = sv.get_null_bvector();
+    if (!bv_cand)
+    {
+        bv_all.set_range(0, sv.size() - 1);
+        bv_cand = &bv_all;
+    }
+
+    bm::bit_blocks_buffer<typename bvector_type::allocator_type> 
+                                        bbuf(bv_cand->get_allocator(), 1);
+    bm::word_t* blk = 0;
+
+    unsigned nb_last = unsigned((sv.size() - 1) >> bm::set_block_shift);
+    for (unsigned nb = 0; nb <= nb_last; ++nb)
+    {
+        const bm::word_t* cand = bv_cand->get_block(nb);
+        if (!cand)
+            continue;
+        if (!blk)
+            blk = bbuf.block(0);
+        if (BM_IS_GAP(cand))
+            bm::gap_convert_to_bitset(blk, BMGAP_PTR(cand));
+        else
+            bm::bit_block_copy(blk, cand);
+
+        bool any = true;
+        for (unsigned i = 0; i < cmp_len && any; ++i)
+        {
+            unsigned code = codes[i];
+            for (unsigned j = 0; j < 8 && any; ++j)
+            {
+                const bvector_type* bv_plain = sv.get_plain(i * 8 + j);
+                const bm::word_t* pb = bv_plain ? bv_plain->get_block(nb) : 0;
+                if (code & (1u << j))
+                {
+                    if (!pb)
+                        any = false;
+                    else
+                    if (BM_IS_GAP(pb))
+                    {
+                        bm::gap_and_to_bitset(blk, BMGAP_PTR(pb));
+                        any = !bm::bit_is_all_zero(blk, blk + bm::set_block_size);
+                    }
+                    else
+                        any = bm::bit_block_and(blk, pb);
+                }
+                else
+                if (pb)
+                {
+                    if (BM_IS_GAP(pb))
+                    {
+                        bm::gap_sub_to_bitset(blk, BMGAP_PTR(pb));
+                        any = !bm::bit_is_all_zero(blk, blk + bm::set_block_size);
+                    }
+                    else
+                        any = bm::bit_block_sub(blk, pb);
+                }
+            } // for j
+        } // for i
+        if (any)
+            bv_out.combine_operation_with_block(nb, blk, false, BM_OR);
+    } // for nb
+}
+
 //----------------------------------------------------------------------------
 //
 //----------------------------------------------------------------------------
@@ -130,7 +130,22 @@ protected:
 
  | HEADER | BITVECTRORS |
 
- Header structure:
+ Header structure (v2):
+   BYTE+BYTE: Magic-signature 'BM'
+   BYTE : Byte order ( 0 - Big Endian, 1 - Little Endian)
+   BYTE : 0 (format v2 marker, v1 keeps number of plains here)
+   BYTE : Format version (2)
+   BYTE : Number of Bit-vector plains (total)
+   VARINT: Vector size
+   BYTE[(plains+7)/8]: Plains bitmask (bit i is set if plain i is not empty)
+   VARINT: BLOB size of non-empty plain
+   VARINT: BLOB size of the next non-empty plain
+   ...
+ 
+ Plain BLOBs follow the header back to back in the order of plains.
+ VARINT is 7 bits per byte integer (byte-order independent).
+ 
+ Header structure (v1, deserialization only):
    BYTE+BYTE: Magic-signature 'BM'
    BYTE : Byte order ( 0 - Big Endian, 1 - Little Endian)
    BYTE : Number of Bit-vector plains (total)
@@ -148,6 +163,14 @@ protected:
                         (allocate with BM_DECLARE_TEMP_BLOCK(x) for speed)
     \param bv_serialization_flags - bit-vector serialization flags
     as defined in bm::serialization_flags    
+    (BM_NO_BYTE_ORDER, BM_XOR_REF - encode plain blocks as a reference 
+     or XOR difference with the previous non-empty plain, when it is shorter,
+     BM_CRC32C - add CRC32C checkpoints to every plain,
+     BM_SVB - Stream VByte coded GAP and array blocks (fast decode),
+     BM_AUTO_LEVEL - every plain uses compression level (3, 4 or 5) 
+     estimated to give the smallest BLOB, default is level 4;
+     each level estimate is a dry-run encoding of the plain, so
+     this mode costs about four serializations per plain)
     
     \ingroup svserial
     
@@ -157,104 +180,258 @@ template<class SV>
 void sparse_vector_serialize(
                 const SV&                        sv,
                 sparse_vector_serial_layout<SV>& sv_layout,
-                bm::word_t*                      temp_block = 0)
+                bm::word_t*                      temp_block = 0,
+                unsigned                         bv_serialization_flags = 0)
 {
     typename SV::statistics sv_stat;
     sv.calc_stat(&sv_stat);
     
     unsigned char* buf = sv_layout.reserve(sv_stat.max_serialize_mem);
-    bm::encoder enc(buf, (unsigned)sv_layout.capacity());
     unsigned plains = sv.stored_plains();
 
-    // calculate header size in bytes
-    unsigned h_size = 1 + 1 + 1 + 1 + 8 + (8 * plains) + 4;
+    // max header size in bytes (plain BLOB sizes take 5 bytes or less)
+    const unsigned h_max = 1 + 1 + 1 + 1 + 1 + 1 + 10 +
+                           ((SV::sv_plains + 7) / 8) + (5 * SV::sv_plains);
+    BM_ASSERT(h_max <= sv_stat.max_serialize_mem);
+    sv_stat.max_serialize_mem -= h_max;
 
     // ptr where bit-plains start
-    unsigned char* buf_ptr = buf + h_size;
+    unsigned char* buf_ptr = buf + h_max;
 
     bm::serializer<typename SV::bvector_type > bvs(temp_block);
     bvs.gap_length_serialization(false);
     bvs.set_compression_level(4);
+    if (bv_serialization_flags & BM_NO_BYTE_ORDER)
+        bvs.byte_order_serialization(false);
+    if (bv_serialization_flags & BM_CRC32C)
+        bvs.crc32c_serialization(true);
+    if (bv_serialization_flags & BM_SVB)
+        bvs.svb_serialization(true);
     
+    unsigned char plain_mask[(SV::sv_plains + 7) / 8] = {0, };
+    unsigned      plain_size[SV::sv_plains];
     unsigned i;
     for (i = 0; i < plains; ++i)
     {
-        const typename SV::bvector_type_ptr bv = sv.plain(i);
+        const typename SV::bvector_type* bv = sv.plain(i);
         if (!bv)  // empty plain
         {
             sv_layout.set_plain(i, 0, 0);
             continue;
         }
+        if (bv_serialization_flags & BM_AUTO_LEVEL)
+        {
+            unsigned level = 4;
+            bvs.set_compression_level(4);
+            size_t   best_size = bvs.estimate_serialized_size(*bv);
+            for (unsigned l = 3; l <= 5; l += 2)
+            {
+                bvs.set_compression_level(l);
+                size_t est_size = bvs.estimate_serialized_size(*bv);
+                if (est_size < best_size)
+                {
+                    best_size = est_size; level = l;
+                }
+            }
+            bvs.set_compression_level(level);
+        }
         
         unsigned buf_size =
             bvs.serialize(*bv, buf_ptr, sv_stat.max_serialize_mem);
+        if (bv_serialization_flags & BM_XOR_REF)
+            bvs.set_ref_vector(bv); // reference for the next plain
         
-        sv_layout.set_plain(i, buf_ptr, buf_size);
+        plain_mask[i >> 3] = (unsigned char)(plain_mask[i >> 3] | (1u << (i & 7)));
+        plain_size[i] = buf_size;
         buf_ptr += buf_size;
         sv_stat.max_serialize_mem -= buf_size;
         
     } // for i
     
-    sv_layout.resize(buf_ptr - buf);
-    
-    
     // save the header
+    unsigned char h_buf[h_max];
+    bm::encoder enc(h_buf, h_max);
     ByteOrder bo = globals<true>::byte_order();
     
     enc.put_8('B');
     enc.put_8('M');
     enc.put_8((unsigned char)bo);
+    enc.put_8(0);  // v2 marker
+    enc.put_8(2);  // version
     enc.put_8((unsigned char)plains);
-    enc.put_64(sv.size());
+    enc.put_varint(sv.size());
+    enc.memcpy(plain_mask, (plains + 7) / 8);
+    for (i = 0; i < plains; ++i)
+    {
+        if (plain_mask[i >> 3] & (1u << (i & 7)))
+            enc.put_varint(plain_size[i]);
+    }
+    unsigned h_size = enc.size();
+    BM_ASSERT(h_size <= h_max);
     
+    // move plains to the end of the actual header
+    size_t plains_size = size_t(buf_ptr - (buf + h_max));
+    ::memmove(buf + h_size, buf + h_max, plains_size);
+    ::memcpy(buf, h_buf, h_size);
+    sv_layout.resize(h_size + plains_size);
+    
+    buf_ptr = buf + h_size;
     for (i = 0; i < plains; ++i)
     {
-        const unsigned char* p = sv_layout.get_plain(i);
-        if (!p)
+        if (plain_mask[i >> 3] & (1u << (i & 7)))
         {
-            enc.put_64(0);
-            continue;
+            sv_layout.set_plain(i, buf_ptr, plain_size[i]);
+            buf_ptr += plain_size[i];
         }
-        size_t offset = p - buf;
-        enc.put_64(offset);
     }
 }
 
 // -------------------------------------------------------------------------
 
 /*!
-    \brief Deserialize svector<>
+    \brief Decode sparse vector BLOB header (v1 or v2)
+    \param buf      - source memory buffer
+    \param plains   - [out] number of plains
+    \param sv_size  - [out] vector size
+    \param offsets  - [out] offsets of plains (0 - empty plain), 
+                      array of max plains size (256)
+ 
+    \return error non-zero codes means failure
+    \internal
+    \ingroup svector
+*/
+template<class DEC>
+int sparse_vector_read_header(const unsigned char* buf,
+                              unsigned&            plains,
+                              bm::id64_t&          sv_size,
+                              size_t*              offsets)
+{
+    DEC dec(buf);
+    unsigned char h1 = dec.get_8();
+    unsigned char h2 = dec.get_8();
+
+    BM_ASSERT(h1 == 'B' && h2 == 'M');
+    if (h1 != 'B' || h2 != 'M')  // no magic header? issue...
+    {
+        return -1;
+    }
+    dec.get_8(); // byte order
+    plains = dec.get_8();
+    if (plains) // v1: INT64 offsets
+    {
+        sv_size = dec.get_64();
+        for (unsigned i = 0; i < plains; ++i)
+        {
+            offsets[i] = (size_t) dec.get_64();
+        }
+        return 0;
+    }
+    unsigned char version = dec.get_8();
+    if (version != 2)
+    {
+        return -2; // unknown format
+    }
+    plains = dec.get_8();
+    sv_size = dec.get_varint();
+    
+    unsigned char plain_mask[256 / 8];
+    unsigned mask_size = (plains + 7) / 8;
+    dec.memcpy(plain_mask, mask_size);
+    
+    for (unsigned i = 0; i < plains; ++i)
+    {
+        offsets[i] = (plain_mask[i >> 3] & (1u << (i & 7))) ?
+                                        (size_t) dec.get_varint() : 0;
+    }
+    // plain BLOBs start right after the header, convert sizes to offsets
+    size_t offset = dec.size();
+    for (unsigned i = 0; i < plains; ++i)
+    {
+        if (offsets[i])
+        {
+            size_t blob_size = offsets[i];
+            offsets[i] = offset;
+            offset += blob_size;
+        }
+    }
+    return 0;
+}
+
+// -------------------------------------------------------------------------
+
+/*!
+    \brief Deserialize svector<> partially: selected bit-plains and/or range
+ 
+    Restores only bit-plains selected by the mask (other plains stay empty)
+    and only elements in the range [from, to] (elements outside the range
+    come back as 0 or NULL), vector size is restored as serialized.
+    Plain offsets from the header are used to skip unselected plains,
+    bit-blocks outside the range are skipped in the BLOB without decoding.
+    Plains serialized as XOR/reference of the previous plain (BM_XOR_REF)
+    need the whole chain of reference plains, which is decoded
+    into temporary vectors.
+ 
     \param sv         - target sparse vector
     \param buf        - source memory buffer
+    \param plain_mask - value bit-plains to restore (bit i - plain i)
+    \param load_null  - restore NULL vector (if vector is nullable)
+    \param from       - range start
+    \param to         - range end (inclusive)
     \param temp_block - temporary block buffer to avoid re-allocations
  
     \return error non-zero codes means failure
+    
+    A plain failing its CRC32C check (BM_CRC32C) is reported as an
+    exception (std::logic_error, BM_ERR_CRC in STL-free mode),
+    the target vector is left partially restored.
  
+    @sa sparse_vector_deserialize
     \ingroup svector
 */
 template<class SV>
-int sparse_vector_deserialize(SV& sv,
-                              const unsigned char* buf,
-                              bm::word_t* temp_block=0)
+int sparse_vector_deserialize_partial(SV&                  sv,
+                                      const unsigned char* buf,
+                                      bm::id64_t           plain_mask,
+                                      bool                 load_null,
+                                      bm::id_t             from = 0,
+                                      bm::id_t             to = bm::id_max-1,
+                                      bm::word_t*          temp_block = 0)
 {
     typedef typename SV::bvector_type   bvector_type;
 
-    // TODO: implement correct processing of byte-order corect deserialization
-    //    ByteOrder bo_current = globals<true>::byte_order();
-
-    bm::decoder dec(buf);
-    unsigned char h1 = dec.get_8();
-    unsigned char h2 = dec.get_8();
-
-    BM_ASSERT(h1 == 'B' && h2 == 'M');
-    if (h1 != 'B' && h2 != 'M')  // no magic header? issue...
+    ByteOrder bo_current = globals<true>::byte_order();
+    ByteOrder bo = (ByteOrder) buf[2];
+    
+    unsigned   plains;
+    bm::id64_t sv_size;
+    size_t     offsets[256]; // plains count takes one byte
+    int res;
+    if (bo == bo_current)
     {
-        return -1;
+        res = sparse_vector_read_header<bm::decoder>(
+                                            buf, plains, sv_size, offsets);
+    }
+    else
+    {
+        switch (bo_current)
+        {
+        case BigEndian:
+            res = sparse_vector_read_header<bm::decoder_big_endian>(
+                                            buf, plains, sv_size, offsets);
+            break;
+        case LittleEndian:
+            res = sparse_vector_read_header<bm::decoder_little_endian>(
+                                            buf, plains, sv_size, offsets);
+            break;
+        default:
+            BM_ASSERT(0);
+            res = -2;
+        }
+    }
+    if (res)
+    {
+        return res;
     }
-    
-    //unsigned char bv_bo =
-        dec.get_8();
-    unsigned plains = dec.get_8();
     
     if (!plains || plains > sv.stored_plains())
     {
@@ -263,31 +440,108 @@ int sparse_vector_deserialize(SV& sv,
     
     sv.clear();
     
-    bm::id64_t sv_size = dec.get_64();
     if (sv_size == 0)
     {
         return 0;  // empty vector
     }
     sv.resize((unsigned)sv_size);
+
+    BM_ASSERT(from <= to);
+    if (from > to || from >= sv_size)
+    {
+        return 0; // nothing to restore
+    }
+    if (to >= sv_size)
+    {
+        to = bm::id_t(sv_size - 1);
+    }
+    bool range = (from != 0 || to != sv_size - 1);
+
+    bool   is_ref[SV::sv_plains]; // plain is a reference for the next plain
+    bool   need_ref = false;
+    unsigned i;
+    for (i = plains; i > 0; )
+    {
+        --i;
+        is_ref[i] = false;
+        if (offsets[i] == 0) // null vector
+        {
+            continue;
+        }
+        is_ref[i] = need_ref;
+        bool load = (i == sv.plains()) ? load_null
+                                           : bool((plain_mask >> i) & 1);
+        need_ref = (load || is_ref[i]) && (buf[offsets[i]] & BM_HM_REF);
+    } // for i
     
-    unsigned i = 0;
+    BM_DECLARE_TEMP_BLOCK(tb)
+    if (!temp_block)
+    {
+        temp_block = tb;
+    }
+
+    bvector_type  bv_chain[2]; // decoded reference plains not requested
+    unsigned      chain_idx = 0;
+    const bvector_type* bv_ref = 0; // previous non-empty plain
     for (i = 0; i < plains; ++i)
     {
-        size_t offset = (size_t) dec.get_64();
-        if (offset == 0) // null vector
+        if (offsets[i] == 0) // null vector
         {
             continue;
         }
-        const unsigned char* bv_buf_ptr = buf + offset;
-        bvector_type*  bv = sv.get_plain(i);
-        BM_ASSERT(bv);
+        bool load = (i == sv.plains()) ? load_null
+                                           : bool((plain_mask >> i) & 1);
+        if (!load && !is_ref[i])
+        {
+            continue;
+        }
+        const unsigned char* bv_buf_ptr = buf + offsets[i];
+        bvector_type*  bv = load ? sv.get_plain(i) : 0;
+        
+        if (load && !range)
+        {
+            bm::deserialize(*bv, bv_buf_ptr, temp_block, bv_ref);
+            bv_ref = bv;
+        }
+        else
+        if (is_ref[i]) // reference is needed in full
+        {
+            bvector_type& bv_c = bv_chain[chain_idx ^= 1];
+            bv_c.clear(true);
+            bm::deserialize(bv_c, bv_buf_ptr, temp_block, bv_ref);
+            bv_ref = &bv_c;
+            if (bv)
+            {
+                *bv = bv_c;
+            }
+        }
+        else // range of a plain
+        {
+            unsigned char header_flag = *bv_buf_ptr;
+            if (header_flag & (BM_HM_REF | BM_HM_CRC))
+            {
+                // reference and CRC check need the whole BLOB
+                bm::deserialize(*bv, bv_buf_ptr, temp_block, bv_ref);
+            }
+            else
+            {
+                // AND with range mask seeks over bit-blocks out of range
+                bv->set_range(from, to);
+                bm::operation_deserializer<bvector_type>::deserialize(
+                                *bv, bv_buf_ptr, temp_block, bm::set_AND);
+            }
+        }
         
-        bm::deserialize(*bv, bv_buf_ptr, temp_block);
-        if (!temp_block)
+        if (bv && range) // clear everything out of range
         {
-            typename bvector_type::blocks_manager_type& bv_bm =
-                                                bv->get_blocks_manager();
-            temp_block = bv_bm.check_allocate_tempblock();
+            if (from)
+            {
+                bv->set_range(0, from - 1, false);
+            }
+            if (to + 1 < bv->size())
+            {
+                bv->set_range(to + 1, bv->size() - 1, false);
+            }
         }
     } // for i
     return 0;
@@ -295,6 +549,34 @@ int sparse_vector_deserialize(SV& sv,
 
 // -------------------------------------------------------------------------
 
+/*!
+    \brief Deserialize svector<>
+    \param sv         - target sparse vector
+    \param buf        - source memory buffer
+    \param temp_block - temporary block buffer to avoid re-allocations
+ 
+    \return error non-zero codes means failure
+    
+    A plain failing its CRC32C check (BM_CRC32C) is reported as an
+    exception (std::logic_error, BM_ERR_CRC in STL-free mode),
+    the target vector is left partially restored.
+ 
+    @sa sparse_vector_deserialize_partial
+    \ingroup svector
+*/
+template<class SV>
+int sparse_vector_deserialize(SV& sv,
+                              const unsigned char* buf,
+                              bm::word_t* temp_block=0)
+{
+    return bm::sparse_vector_deserialize_partial(sv, buf, 
+                                                 ~bm::id64_t(0), true,
+                                                 0, bm::id_max-1,
+                                                 temp_block);
+}
+
+// -------------------------------------------------------------------------
+
 /**
     Seriaizer for compressed collections
 */
@@ -335,6 +617,143 @@ public:
 };
 
 
+/**
+    \brief Zero-copy reader for serialized compressed collections
+ 
+    Reader works on top of serialized compressed buffer collection BLOB
+    (as produced by compressed_collection_serializer) without loading 
+    buffers into RAM. Only the address resolver and the table of buffer
+    sizes are restored, buffers are returned as views into the BLOB memory, 
+    so the BLOB can be a memory mapped file (mapping is up to the caller),
+    pages are touched only for the requested buffers.
+ 
+    Optional LRU cache keeps last decoded bit-vectors.
+    Reader is not thread safe (cache and temp block are shared).
+ 
+    @sa compressed_collection_serializer
+    \ingroup svserial
+*/
+template<class CBC>
+class compressed_collection_reader
+{
+public:
+    typedef CBC                                  compressed_collection_type;
+    typedef typename CBC::bvector_type           bvector_type;
+    typedef typename CBC::address_resolver_type  address_resolver_type;
+    typedef typename CBC::key_type               key_type;
+    typedef typename CBC::address_type           address_type;
+    
+    /// zero-copy view of a serialized buffer inside the collection BLOB
+    struct buffer_view
+    {
+        const unsigned char* buf;  ///< buffer pointer (in BLOB memory)
+        size_t               size; ///< buffer size in bytes
+        
+        buffer_view() : buf(0), size(0) {}
+    };
+
+public:
+    /**
+        \param cache_size - number of decoded bit-vectors to keep (LRU),
+                            0 - no cache, get_bvector() re-decodes every
+                            call into one scratch vector
+    */
+    compressed_collection_reader(unsigned cache_size = 0);
+    ~compressed_collection_reader();
+    
+    /**
+        \brief Attach reader to the serialized collection BLOB
+        
+        BLOB memory is not copied and must stay valid while reader is used.
+        \param buf      - serialized collection BLOB (or mapped file)
+        \param buf_size - BLOB size for bounds check (0 - do not check)
+        \param temp_block - temporary block to avoid re-allocations
+        
+        \return 0 - success, 
+                 -1 - incorrect header, 
+                 -2 - buffer sizes do not match address vector,
+                 -3 - BLOB is truncated
+    */
+    int open(const unsigned char* buf, 
+             size_t               buf_size = 0,
+             bm::word_t*          temp_block = 0);
+    
+    /// number of buffers in the collection
+    size_t size() const { return coll_size_; }
+    
+    /// Get address resolver
+    const address_resolver_type& resolver() const { return addr_res_; }
+    
+    /**
+        \brief Get zero-copy view of the buffer associated with the key
+        \return true if key was found
+    */
+    bool get_view(key_type key, buffer_view& view) const;
+    
+    /**
+        \brief Get zero-copy view of the buffer by resolved address
+    */
+    void get_view_addr(address_type addr, buffer_view& view) const;
+    
+    /**
+        \brief Decode buffer associated with the key as a bit-vector
+        \param key - collection key
+        \param bv  - [out] target bit-vector
+        \return true if key was found
+    */
+    bool get_bvector(key_type key, bvector_type& bv) const;
+    
+    /**
+        \brief Get decoded bit-vector associated with the key via LRU cache
+        
+        Returned pointer stays valid until the next call 
+        (or until it is evicted from the cache).
+        \return pointer on decoded vector or NULL if key not found
+    */
+    const bvector_type* get_bvector(key_type key);
+    
+    /// Drop all cached bit-vectors
+    void clear_cache();
+
+private:
+    compressed_collection_reader(const compressed_collection_reader&);
+    void operator=(const compressed_collection_reader&);
+
+    /// decode the BLOB header with the byte-order of the BLOB
+    template<class DEC>
+    int read_header(const unsigned char* buf,
+                    size_t               buf_size,
+                    bm::word_t*          temp_block);
+
+    /// read buffer size from the sizes table (byte-order aware)
+    unsigned get_buf_size(address_type addr) const;
+    
+    struct cache_entry
+    {
+        key_type       key;
+        bvector_type*  bv;
+        bm::id64_t     tick; ///< last use
+    };
+    
+    /// offsets are sampled every (1 << offs_shift) buffers
+    enum { offs_shift = 6 };
+    
+private:
+    address_resolver_type     addr_res_;    ///< key to address translator
+    const unsigned char*      blob_;        ///< collection BLOB
+    const unsigned char*      sizes_;       ///< table of INT32 buffer sizes
+    ByteOrder                 bo_;          ///< BLOB byte order
+    size_t                    coll_size_;   ///< number of buffers
+    std::vector<size_t>       offs_sample_; ///< sampled offsets of buffers
+    
+    unsigned                  cache_size_;  ///< max cache size
+    std::vector<cache_entry>  cache_;       ///< LRU cache of decoded vectors
+    bm::id64_t                tick_;        ///< LRU clock
+    bm::word_t*               temp_block_;  ///< temp block for decoding
+};
+
+
+
 // -------------------------------------------------------------------------
 
 /**
@@ -507,6 +926,289 @@ int compressed_collection_deserializer<CBC>::deserialize(
     return 0;
 }
 
+// -------------------------------------------------------------------------
+
+template<class CBC>
+compressed_collection_reader<CBC>::compressed_collection_reader(
+                                                    unsigned cache_size)
+: blob_(0),
+  sizes_(0),
+  bo_(globals<true>::byte_order()),
+  coll_size_(0),
+  cache_size_(cache_size),
+  tick_(0),
+  temp_block_(0)
+{
+}
+
+// -------------------------------------------------------------------------
+
+template<class CBC>
+compressed_collection_reader<CBC>::~compressed_collection_reader()
+{
+    clear_cache();
+    if (temp_block_)
+    {
+        typename bvector_type::allocator_type alloc;
+        alloc.free_bit_block(temp_block_);
+    }
+}
+
+// -------------------------------------------------------------------------
+
+template<class CBC>
+void compressed_collection_reader<CBC>::clear_cache()
+{
+    for (size_t i = 0; i < cache_.size(); ++i)
+    {
+        delete cache_[i].bv;
+    }
+    cache_.resize(0);
+}
+
+// -------------------------------------------------------------------------
+
+template<class CBC>
+int compressed_collection_reader<CBC>::open(const unsigned char* buf,
+                                            size_t               buf_size,
+                                            bm::word_t*          temp_block)
+{
+    clear_cache();
+    blob_ = sizes_ = 0;
+    coll_size_ = 0;
+    offs_sample_.resize(0);
+    if (buf_size && buf_size < 3 + 8) // magic, byte order, address size
+    {
+        return -3; // truncated BLOB
+    }
+    
+    ByteOrder bo_current = globals<true>::byte_order();
+    bo_ = (ByteOrder) buf[2];
+    if (bo_ == bo_current)
+    {
+        return read_header<bm::decoder>(buf, buf_size, temp_block);
+    }
+    switch (bo_current)
+    {
+    case BigEndian:
+        return read_header<bm::decoder_big_endian>(buf, buf_size, temp_block);
+    case LittleEndian:
+        return read_header<bm::decoder_little_endian>(buf, buf_size, temp_block);
+    default:
+        BM_ASSERT(0);
+    };
+    return -1;
+}
+
+// -------------------------------------------------------------------------
+
+template<class CBC> template<class DEC>
+int compressed_collection_reader<CBC>::read_header(
+                                            const unsigned char* buf,
+                                            size_t               buf_size,
+                                            bm::word_t*          temp_block)
+{
+    DEC dec(buf);
+    unsigned char h1 = dec.get_8();
+    unsigned char h2 = dec.get_8();
+
+    BM_ASSERT(h1 == 'B' && h2 == 'C');
+    if (h1 != 'B' || h2 != 'C')  // no magic header? issue...
+    {
+        return -1;
+    }
+    dec.get_8(); // byte order
+    
+    // -----------------------------------------
+    // restore address resolver
+    //
+    bm::id64_t addr_bv_size = dec.get_64();
+    const unsigned char* bv_buf_ptr = dec.get_pos();
+    // address vector and the collection size must fit the buffer
+    if (buf_size && addr_bv_size + 8 > buf_size - dec.size())
+    {
+        return -3; // truncated BLOB
+    }
+    
+    bvector_type& bv = addr_res_.get_bvector();
+    bv.clear();
+    bm::deserialize(bv, bv_buf_ptr, temp_block, (const bvector_type*)0,
+                    buf_size ? (size_t)addr_bv_size : 0);
+    addr_res_.sync();
+    
+    unsigned addr_cnt = bv.count();
+    dec.seek((int)addr_bv_size);
+    
+    bm::id64_t coll_size = dec.get_64();
+    if (coll_size != addr_cnt)
+    {
+        return -2; // buffer size collection does not match address vector
+    }
+    // sizes table is read below, it must fit the buffer
+    if (buf_size && coll_size > (buf_size - dec.size()) / 4)
+    {
+        return -3; // truncated BLOB
+    }
+    
+    // -----------------------------------------
+    // sample buffer offsets (buffers follow the sizes table)
+    //
+    blob_ = buf;
+    sizes_ = dec.get_pos();
+    coll_size_ = (size_t) coll_size;
+    
+    size_t offset = dec.size() + coll_size_ * 4;
+    offs_sample_.reserve((coll_size_ >> offs_shift) + 1);
+    for (size_t i = 0; i < coll_size_; ++i)
+    {
+        if ((i & ((1u << offs_shift) - 1)) == 0)
+        {
+            offs_sample_.push_back(offset);
+        }
+        offset += dec.get_32();
+    }
+    if (buf_size && offset > buf_size)
+    {
+        coll_size_ = 0;
+        return -3; // truncated BLOB
+    }
+    return 0;
+}
+
+// -------------------------------------------------------------------------
+
+template<class CBC>
+unsigned 
+compressed_collection_reader<CBC>::get_buf_size(address_type addr) const
+{
+    const unsigned char* p = sizes_ + size_t(addr) * 4;
+    if (bo_ == globals<true>::byte_order())
+    {
+        bm::decoder dec(p);
+        return dec.get_32();
+    }
+    switch (globals<true>::byte_order())
+    {
+    case BigEndian:
+        {
+        bm::decoder_big_endian dec(p);
+        return dec.get_32();
+        }
+    case LittleEndian:
+        {
+        bm::decoder_little_endian dec(p);
+        return dec.get_32();
+        }
+    default:
+        BM_ASSERT(0);
+    };
+    return 0;
+}
+
+// -------------------------------------------------------------------------
+
+template<class CBC>
+void compressed_collection_reader<CBC>::get_view_addr(address_type addr,
+                                                      buffer_view& view) const
+{
+    BM_ASSERT(addr < coll_size_);
+    
+    // sampled offset + sizes of buffers in between
+    address_type i = address_type((addr >> offs_shift) << offs_shift);
+    size_t offset = offs_sample_[addr >> offs_shift];
+    for (; i < addr; ++i)
+    {
+        offset += get_buf_size(i);
+    }
+    view.buf = blob_ + offset;
+    view.size = get_buf_size(addr);
+}
+
+// -------------------------------------------------------------------------
+
+template<class CBC>
+bool compressed_collection_reader<CBC>::get_view(key_type     key,
+                                                 buffer_view& view) const
+{
+    address_type addr;
+    if (!addr_res_.resolve(key, &addr))
+    {
+        view.buf = 0; view.size = 0;
+        return false;
+    }
+    get_view_addr(addr - 1, view);
+    return true;
+}
+
+// -------------------------------------------------------------------------
+
+template<class CBC>
+bool compressed_collection_reader<CBC>::get_bvector(key_type      key,
+                                                    bvector_type& bv) const
+{
+    buffer_view view;
+    if (!get_view(key, view))
+    {
+        return false;
+    }
+    bv.clear();
+    bm::deserialize(bv, view.buf, temp_block_);
+    return true;
+}
+
+// -------------------------------------------------------------------------
+
+template<class CBC>
+const typename compressed_collection_reader<CBC>::bvector_type*
+compressed_collection_reader<CBC>::get_bvector(key_type key)
+{
+    ++tick_;
+    size_t lru_idx = 0;
+    for (size_t i = 0; cache_size_ && i < cache_.size(); ++i)
+    {
+        cache_entry& ce = cache_[i];
+        if (ce.key == key)
+        {
+            ce.tick = tick_;
+            return ce.bv;
+        }
+        if (ce.tick < cache_[lru_idx].tick)
+        {
+            lru_idx = i;
+        }
+    } // for i
+    
+    buffer_view view;
+    if (!get_view(key, view))
+    {
+        return 0;
+    }
+    if (!temp_block_)
+    {
+        typename bvector_type::allocator_type alloc;
+        temp_block_ = alloc.alloc_bit_block();
+    }
+    
+    // no cache: the only entry is a scratch vector, never looked up
+    bvector_type* bv;
+    if (cache_.size() < (cache_size_ ? cache_size_ : 1u))
+    {
+        cache_entry ce;
+        ce.bv = bv = new bvector_type();
+        cache_.push_back(ce);
+        lru_idx = cache_.size() - 1;
+    }
+    else // evict the least recently used
+    {
+        bv = cache_[lru_idx].bv;
+        bv->clear();
+    }
+    cache_[lru_idx].key = key;
+    cache_[lru_idx].tick = tick_;
+    bm::deserialize(*bv, view.buf, temp_block_);
+    return bv;
+}
+
 
 } // namespace bm
 
@@ -195,6 +195,453 @@ bool sse4_is_all_one(const __m128i* BMRESTRICT block,
 
 
 
+/*!
+    @brief CRC32C checksum using SSE4.2 crc32 instructions
+    @param buf - data buffer
+    @param len - buffer length in bytes
+    @param crc - CRC32C of the previous data chunk (0 - start)
+    @return CRC32C
+    @ingroup SSE4
+*/
+inline
+unsigned sse4_crc32c(const unsigned char* BMRESTRICT buf, 
+                     size_t len, 
+                     unsigned crc)
+{
+    unsigned c = ~crc;
+#ifdef BM64_SSE4
+    bm::id64_t c64 = c;
+    for (; len >= 8; len -= 8, buf += 8)
+        c64 = _mm_crc32_u64(c64, *(const bm::id64_t*)buf);
+    c = (unsigned)c64;
+#else
+    for (; len >= 4; len -= 4, buf += 4)
+        c = _mm_crc32_u32(c, *(const unsigned*)buf);
+#endif
+    for (; len; --len)
+        c = _mm_crc32_u8(c, *buf++);
+    return ~c;
+}
+
+
+/*!
+    @brief Stream VByte (16-bit) d-gap decoder (SSSE3 shuffle + prefix sum)
+    Decodes groups of 8 values (control byte per group, 1 or 2 bytes 
+    per value). Reads 16 bytes of data per group.
+    @param ctrl - control bytes
+    @param data - data bytes
+    @param dst  - target array
+    @param groups - number of groups to decode
+    @param prev - previous value (prefix sum base), updated
+    @return pointer on the data bytes of the next group
+    @ingroup SSE4
+*/
+inline
+const unsigned char* sse4_svb16_dgap_decode(const unsigned char* BMRESTRICT ctrl,
+                                           const unsigned char* BMRESTRICT data,
+                                           bm::gap_word_t*      BMRESTRICT dst,
+                                           unsigned                        groups,
+                                           bm::gap_word_t&                 prev)
+{
+    __m128i mprev = _mm_set1_epi16((short)prev);
+    const __m128i mbcast = _mm_set1_epi16(0x0F0E); // broadcast of the last
+    for (unsigned i = 0; i < groups; ++i, dst += 8)
+    {
+        unsigned c = ctrl[i];
+        __m128i v = _mm_loadu_si128((const __m128i*)data);
+        __m128i mshuf = _mm_loadu_si128(
+                (const __m128i*)bm::svb16_shuffle_table<true>::_shuf[c]);
+        v = _mm_shuffle_epi8(v, mshuf);
+        v = _mm_add_epi16(v, _mm_slli_si128(v, 2));
+        v = _mm_add_epi16(v, _mm_slli_si128(v, 4));
+        v = _mm_add_epi16(v, _mm_slli_si128(v, 8));
+        v = _mm_add_epi16(v, mprev);
+        _mm_storeu_si128((__m128i*)dst, v);
+        mprev = _mm_shuffle_epi8(v, mbcast);
+        data += 8 + _mm_popcnt_u32(c);
+    }
+    prev = (bm::gap_word_t)_mm_extract_epi16(mprev, 0);
+    return data;
+}
+
+/*!
+    @brief Bitcount of 64-bit word (two 32-bit counts in 32-bit builds)
+    \internal
+*/
+BMFORCEINLINE
+unsigned sse4_popcnt64(bm::id64_t w)
+{
+#ifdef BM64_SSE4
+    return unsigned(_mm_popcnt_u64(w));
+#else
+    return unsigned(_mm_popcnt_u32(unsigned(w >> 32)) + 
+                    _mm_popcnt_u32(unsigned(w)));
+#endif
+}
+
+/*!
+    @brief Unpacks 64-bit word into list of ON bit indexes
+    (table driven byte expansion, 8 indexes stored per byte)
+    @param w - value
+    @param bits - target array (64 bytes, tail can be overwritten)
+    @return number of bits in the list
+    @ingroup SSE4
+*/
+inline
+unsigned sse4_bitscan64(bm::id64_t w, unsigned char* BMRESTRICT bits)
+{
+    if (bm::sse4_popcnt64(w) < 4) // sparse word: popcnt scan is faster
+    {
+        unsigned cnt = 0;
+        for (; w; w &= w - 1)
+        {
+            bits[cnt++] = (unsigned char)bm::sse4_popcnt64((w & (0 - w)) - 1);
+        }
+        return cnt;
+    }
+    unsigned char* BMRESTRICT pos = bits;
+    __m128i moffs = _mm_setzero_si128();
+    const __m128i m8 = _mm_set1_epi8(8);
+    for (; w; w >>= 8, moffs = _mm_add_epi8(moffs, m8))
+    {
+        unsigned b = unsigned(w & 0xFFu);
+        __m128i v = _mm_loadl_epi64(
+                        (const __m128i*)bm::bit_idx_table<true>::_idx[b]);
+        _mm_storel_epi64((__m128i*)pos, _mm_add_epi8(v, moffs));
+        pos += _mm_popcnt_u32(b);
+    }
+    return unsigned(pos - bits);
+}
+
+/*!
+    @brief Unpacks 32-bit word into list of 16-bit ON bit indexes
+    (table driven byte expansion, 8 indexes stored per byte)
+    @param w - value
+    @param dst - target array (32 elements, tail can be overwritten)
+    @param base - index of the word bit 0
+    @return number of bits in the list
+    @ingroup SSE4
+*/
+inline
+unsigned sse4_bit_to_arr16(bm::word_t w, 
+                           bm::gap_word_t* BMRESTRICT dst, 
+                           unsigned base)
+{
+    bm::gap_word_t* BMRESTRICT pos = dst;
+    __m128i mbase = _mm_set1_epi16((short)base);
+    const __m128i m8 = _mm_set1_epi16(8);
+    for (; w; w >>= 8, mbase = _mm_add_epi16(mbase, m8))
+    {
+        unsigned b = w & 0xFFu;
+        __m128i v = _mm_cvtepu8_epi16(_mm_loadl_epi64(
+                        (const __m128i*)bm::bit_idx_table<true>::_idx[b]));
+        _mm_storeu_si128((__m128i*)pos, _mm_add_epi16(v, mbase));
+        pos += _mm_popcnt_u32(b);
+    }
+    return unsigned(pos - dst);
+}
+
+/*!
+    @brief Lane masks of 128-bit vector for bits [left, right] 
+    (left and right are bit positions within the vector)
+    \internal
+*/
+BMFORCEINLINE
+__m128i sse4_bit_range_mask(unsigned left, unsigned right)
+{
+    const __m128i midx = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128i ml = _mm_set1_epi32(int(left >> bm::set_word_shift));
+    const __m128i mr = _mm_set1_epi32(int(right >> bm::set_word_shift));
+    const __m128i mwl = _mm_set1_epi32(
+        int(bm::block_set_table<true>::_right[left & bm::set_word_mask]));
+    const __m128i mwr = _mm_set1_epi32(
+        int(bm::block_set_table<true>::_left[right & bm::set_word_mask]));
+    __m128i m1 = _mm_or_si128(_mm_cmpgt_epi32(midx, ml),
+                    _mm_and_si128(_mm_cmpeq_epi32(midx, ml), mwl));
+    __m128i m2 = _mm_or_si128(_mm_cmpgt_epi32(mr, midx),
+                    _mm_and_si128(_mm_cmpeq_epi32(midx, mr), mwr));
+    return _mm_and_si128(m1, m2);
+}
+
+/*!
+    @brief Bitcount of 128-bit vector
+    \internal
+*/
+BMFORCEINLINE
+unsigned sse4_popcnt128(__m128i v)
+{
+#ifdef BM64_SSE4
+    return unsigned(_mm_popcnt_u64((bm::id64_t)_mm_extract_epi64(v, 0)) + 
+                    _mm_popcnt_u64((bm::id64_t)_mm_extract_epi64(v, 1)));
+#else
+    return unsigned(_mm_popcnt_u32(_mm_extract_epi32(v, 0)) + 
+                    _mm_popcnt_u32(_mm_extract_epi32(v, 1)) +
+                    _mm_popcnt_u32(_mm_extract_epi32(v, 2)) +
+                    _mm_popcnt_u32(_mm_extract_epi32(v, 3)));
+#endif
+}
+
+/*!
+    @brief AND two bit blocks and test for any bit.
+    Blocks are scanned in 64-byte stripes, first non-empty stripe stops the scan.
+    @ingroup SSE4
+*/
+inline
+bool sse4_and_block_any(const __m128i* BMRESTRICT block,
+                        const __m128i* BMRESTRICT block_end,
+                        const __m128i* BMRESTRICT mask_block)
+{
+    do
+    {
+        __m128i w0 = _mm_and_si128(_mm_load_si128(block+0), _mm_load_si128(mask_block+0));
+        __m128i w1 = _mm_and_si128(_mm_load_si128(block+1), _mm_load_si128(mask_block+1));
+        __m128i w2 = _mm_and_si128(_mm_load_si128(block+2), _mm_load_si128(mask_block+2));
+        __m128i w3 = _mm_and_si128(_mm_load_si128(block+3), _mm_load_si128(mask_block+3));
+        
+        w0 = _mm_or_si128(_mm_or_si128(w0, w1), _mm_or_si128(w2, w3));
+        if (!_mm_testz_si128(w0, w0))
+            return true;
+        block += 4; mask_block += 4;
+    } while (block < block_end);
+    return false;
+}
+
+/*!
+    @brief AND bit count for two aligned bit-blocks with early exit.
+    Count is checked after every 64-byte stripe, scan stops as soon as
+    the limit is reached.
+    @return bit count (exact if less than limit, otherwise >= limit)
+    @ingroup SSE4
+*/
+inline
+bm::id_t sse4_bit_count_and_limit(const __m128i* BMRESTRICT block,
+                                  const __m128i* BMRESTRICT block_end,
+                                  const __m128i* BMRESTRICT mask_block,
+                                  bm::id_t                  limit)
+{
+    bm::id_t count = 0;
+    do
+    {
+        __m128i w0 = _mm_and_si128(_mm_load_si128(block+0), _mm_load_si128(mask_block+0));
+        __m128i w1 = _mm_and_si128(_mm_load_si128(block+1), _mm_load_si128(mask_block+1));
+        __m128i w2 = _mm_and_si128(_mm_load_si128(block+2), _mm_load_si128(mask_block+2));
+        __m128i w3 = _mm_and_si128(_mm_load_si128(block+3), _mm_load_si128(mask_block+3));
+        
+        count += sse4_popcnt128(w0) + sse4_popcnt128(w1) + 
+                 sse4_popcnt128(w2) + sse4_popcnt128(w3);
+        if (count >= limit)
+            break;
+        block += 4; mask_block += 4;
+    } while (block < block_end);
+    return count;
+}
+
+/*!
+    @brief 32x32 bit-matrix transposition: bit j of src[i] goes to bit i of dst[j].
+    Bytes of 16 words are regrouped into byte plains (pshufb + 4x4 dword
+    transpose), bits are taken out of byte plains with movemask.
+    @ingroup SSE4
+*/
+inline
+void sse4_bit_transpose_32x32(const bm::word_t* BMRESTRICT src,
+                              bm::word_t* BMRESTRICT dst)
+{
+    const __m128i bshuf = 
+        _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    for (unsigned h = 0; h < 2; ++h, src += 16)
+    {
+        __m128i v0 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)(src+0)), bshuf);
+        __m128i v1 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)(src+4)), bshuf);
+        __m128i v2 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)(src+8)), bshuf);
+        __m128i v3 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)(src+12)), bshuf);
+        
+        __m128i t0 = _mm_unpacklo_epi32(v0, v1);
+        __m128i t1 = _mm_unpackhi_epi32(v0, v1);
+        __m128i t2 = _mm_unpacklo_epi32(v2, v3);
+        __m128i t3 = _mm_unpackhi_epi32(v2, v3);
+        
+        __m128i bp[4];
+        bp[0] = _mm_unpacklo_epi64(t0, t2); // byte 0 of 16 words
+        bp[1] = _mm_unpackhi_epi64(t0, t2);
+        bp[2] = _mm_unpacklo_epi64(t1, t3);
+        bp[3] = _mm_unpackhi_epi64(t1, t3);
+        
+        const unsigned shift = h * 16;
+        for (unsigned b = 0; b < 4; ++b)
+        {
+            __m128i y = bp[b];
+            bm::word_t* d = dst + b * 8;
+            for (int k = 7; k >= 0; --k)
+            {
+                bm::word_t m = (bm::word_t)_mm_movemask_epi8(y) << shift;
+                d[k] = h ? (d[k] | m) : m;
+                y = _mm_add_epi8(y, y);
+            }
+        } // for b
+    } // for h
+}
+
+/*!
+    @brief Bitcount of bit block in the range [left, right] (borders included).
+    Edge vectors are counted with lane masks (masked prefix/suffix).
+    @param block - bit block (aligned)
+    @param left - left border
+    @param right - right border
+    @ingroup SSE4
+*/
+inline
+bm::id_t sse4_bit_block_calc_count_range(const bm::word_t* BMRESTRICT block,
+                                         unsigned left, unsigned right)
+{
+    BM_ASSERT(left <= right);
+    const __m128i* BMRESTRICT b = (const __m128i*) block;
+    const unsigned v_left = left >> 7;
+    const unsigned v_right = right >> 7;
+    if (v_left == v_right)
+    {
+        __m128i m = sse4_bit_range_mask(left & 127u, right & 127u);
+        return sse4_popcnt128(_mm_and_si128(_mm_loadu_si128(b + v_left), m));
+    }
+    bm::id_t count = 
+        sse4_popcnt128(_mm_and_si128(_mm_loadu_si128(b + v_left),
+                                     sse4_bit_range_mask(left & 127u, 127u)));
+    count += 
+        sse4_popcnt128(_mm_and_si128(_mm_loadu_si128(b + v_right),
+                                     sse4_bit_range_mask(0u, right & 127u)));
+    if (v_left + 1 < v_right)
+    {
+        count += sse4_bit_count(b + v_left + 1, b + v_right);
+    }
+    return count;
+}
+
+/*!
+    @brief Find the first 1 bit in bit block starting from nbit
+    (first vector is masked, next vectors are tested for all zero)
+    @param block - bit block (aligned)
+    @param nbit - bit position to start search from
+    @param pos - index of the first 1 bit (out)
+    @return true if found
+    @ingroup SSE4
+*/
+inline
+bool sse4_bit_find_first(const bm::word_t* BMRESTRICT block, 
+                         unsigned nbit, unsigned* BMRESTRICT pos)
+{
+    const __m128i* BMRESTRICT b = (const __m128i*) block;
+    const __m128i* BMRESTRICT b_end = b + bm::set_block_size / 4;
+    const __m128i mz = _mm_setzero_si128();
+    b += nbit >> 7;
+    __m128i v = 
+        _mm_and_si128(_mm_loadu_si128(b), sse4_bit_range_mask(nbit & 127u, 127u));
+    while (_mm_testz_si128(v, v))
+    {
+        if (++b == b_end)
+            return false;
+        v = _mm_loadu_si128(b);
+    }
+    unsigned zm = 
+        unsigned(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, mz))));
+    zm = ~zm & 0xFu; // non-zero lanes
+    unsigned nword = 
+        unsigned((const bm::word_t*)b - block) + _mm_popcnt_u32((zm & (0 - zm)) - 1);
+    bm::word_t w = block[nword];
+    if (nword == (nbit >> bm::set_word_shift))
+        w &= bm::block_set_table<true>::_right[nbit & bm::set_word_mask];
+    *pos = (nword << bm::set_word_shift) + _mm_popcnt_u32((w & (0 - w)) - 1);
+    return true;
+}
+
+/*!
+    @brief Hybrid binary search for the GAP where bit = pos located.
+    Branchless binary steps narrow the search down to 16 elements window,
+    window is resolved with two (overlapping) 8-element SIMD compares.
+    Short GAP buffers (less than 8 elements) are compared with one masked
+    load which can read past GAP length (within minimal GAP capacity).
+    @param buf - GAP buffer pointer.
+    @param pos - index of the element.
+    @param is_set - output. GAP value (0 or 1). 
+    @return GAP index.
+    @ingroup SSE4
+*/
+inline
+unsigned sse4_gap_bfind(const unsigned short* BMRESTRICT buf, 
+                        unsigned pos, unsigned* BMRESTRICT is_set)
+{
+    const __m128i mbias = _mm_set1_epi16((short)0x8000); // unsigned compare
+    const __m128i mp = _mm_set1_epi16((short)(pos ^ 0x8000));
+    unsigned start = 1;
+    unsigned n = ((*buf) >> 3); // search [start, start + n), last is >= pos
+    if (n < 8)
+    {
+        __m128i m1 = _mm_xor_si128(
+                        _mm_loadu_si128((const __m128i*)(buf + 1)), mbias);
+        unsigned mask = 
+            unsigned(_mm_movemask_epi8(_mm_cmpgt_epi16(mp, m1))) & ((1u << (n * 2)) - 1);
+        start += _mm_popcnt_u32(mask) >> 1;
+    }
+    else
+    {
+        while (n > 16)
+        {
+            unsigned half = n >> 1;
+            start = (buf[start + half - 1] < pos) ? start + half : start;
+            n -= half;
+        }
+        // elements are sorted: compare masks are prefixes
+        __m128i m1 = _mm_xor_si128(
+                        _mm_loadu_si128((const __m128i*)(buf + start)), mbias);
+        __m128i m2 = _mm_xor_si128(
+                        _mm_loadu_si128((const __m128i*)(buf + start + n - 8)), mbias);
+        unsigned c1 = 
+            _mm_popcnt_u32(_mm_movemask_epi8(_mm_cmpgt_epi16(mp, m1))) >> 1;
+        unsigned c2 = 
+            _mm_popcnt_u32(_mm_movemask_epi8(_mm_cmpgt_epi16(mp, m2))) >> 1;
+        start = (c1 < 8) ? start + c1 : start + n - 8 + c2;
+    }
+    *is_set = ((*buf) & 1) ^ ((start - 1) & 1);
+    return start;
+}
+
+/*!
+    @brief Lower bound rank of sorted GAP ends: for every a[i] computes
+    number of b elements less than a[i]. Each b element is broadcast
+    and compared against 8 a elements at once.
+    @param a - sorted array (GAP ends)
+    @param a_len - length of a
+    @param b - sorted array (GAP ends)
+    @param b_len - length of b
+    @param rank - target array (a_len elements)
+    @ingroup SSE4
+*/
+inline
+void sse4_gap_rank(const bm::gap_word_t* BMRESTRICT a, unsigned a_len,
+                   const bm::gap_word_t* BMRESTRICT b, unsigned b_len,
+                   bm::gap_word_t*       BMRESTRICT rank)
+{
+    const __m128i mbias = _mm_set1_epi16((short)0x8000); // unsigned compare
+    unsigned i = 0, j = 0;
+    for (; i + 8 <= a_len; i += 8)
+    {
+        __m128i ma = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(a + i)), mbias);
+        __m128i mr = _mm_set1_epi16((short)j);
+        const bm::gap_word_t a_last = a[i + 7];
+        for (; j < b_len && b[j] < a_last; ++j)
+        {
+            __m128i mb = _mm_set1_epi16((short)(b[j] ^ 0x8000));
+            mr = _mm_sub_epi16(mr, _mm_cmpgt_epi16(ma, mb)); // +1 if a > b
+        }
+        _mm_storeu_si128((__m128i*)(rank + i), mr);
+    }
+    for (; i < a_len; ++i)
+    {
+        for (; j < b_len && b[j] < a[i]; ++j) {}
+        rank[i] = (bm::gap_word_t)j;
+    }
+}
+
+
+
 #define VECT_XOR_ARR_2_MASK(dst, src, src_end, mask)\
     sse2_xor_arr_2_mask((__m128i*)(dst), (__m128i*)(src), (__m128i*)(src_end), (bm::word_t)mask)
 
@@ -243,6 +690,39 @@ bool sse4_is_all_one(const __m128i* BMRESTRICT block,
 #define VECT_IS_ONE_BLOCK(dst, dst_end) \
     sse4_is_all_one((__m128i*) dst, (__m128i*) (dst_end))
 
+#define VECT_CRC32C(buf, len, crc) \
+    sse4_crc32c((const unsigned char*)(buf), (len), (crc))
+
+#define VECT_SVB16_DGAP_DECODE(ctrl, data, dst, groups, prev) \
+    sse4_svb16_dgap_decode((ctrl), (data), (dst), (groups), (prev))
+
+#define VECT_BITSCAN64(w, bits) \
+    sse4_bitscan64((w), (bits))
+
+#define VECT_BIT_TO_ARR16(w, dst, base) \
+    sse4_bit_to_arr16((w), (dst), (base))
+
+#define VECT_GAP_RANK(a, a_len, b, b_len, rank) \
+    sse4_gap_rank((a), (a_len), (b), (b_len), (rank))
+
+#define VECT_GAP_BFIND(buf, pos, is_set) \
+    sse4_gap_bfind((buf), (pos), (is_set))
+
+#define VECT_BIT_COUNT_RANGE(block, left, right) \
+    sse4_bit_block_calc_count_range((block), (left), (right))
+
+#define VECT_BIT_FIND_FIRST(block, nbit, pos) \
+    sse4_bit_find_first((block), (nbit), (pos))
+
+#define VECT_AND_BLOCK_ANY(first, last, mask) \
+    sse4_and_block_any((__m128i*) (first), (__m128i*) (last), (__m128i*) (mask))
+
+#define VECT_BITCOUNT_AND_LIMIT(first, last, mask, limit) \
+    sse4_bit_count_and_limit((__m128i*) (first), (__m128i*) (last), (__m128i*) (mask), (limit))
+
+#define VECT_BIT_TRANSPOSE_32x32(src, dst) \
+    sse4_bit_transpose_32x32((src), (dst))
+
 
 
 /*!
@@ -0,0 +1,753 @@
+#ifndef BMSTRSPARSEVEC__H__INCLUDED__
+#define BMSTRSPARSEVEC__H__INCLUDED__
+/*
+Copyright(c) 2002-2017 Anatoliy Kuznetsov(anatoliy_kuznetsov at yahoo.com)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+For more information please visit:  http://bitmagic.io
+*/
+
+/*! \file bmstrsparsevec.h
+    \brief string sparse vector str_sparse_vector<> based on bit-transposition
+*/
+
+#include <memory.h>
+
+#include "bmsparsevec.h"
+#include "bmdef.h"
+
+namespace bm
+{
+
+/*!
+   \brief sparse vector for strings with bit-sliced storage of characters
+
+   Every character position (up to MAX_STR_SIZE) is a column
+   sparse_vector<unsigned char> of 8 bit-plains, so positions past the end
+   of the longest string take no memory and short categorical values
+   (country codes, SKU prefixes) compress like small integers.
+   Strings longer than MAX_STR_SIZE are truncated.
+
+   Characters are stored as plain codes. By default the code is the
+   character itself, remap() re-assigns codes in the order of character
+   frequency (most frequent characters get the smallest codes and use
+   fewer bit-plains).
+
+   CharType must be a single byte character type.
+
+   \ingroup sv
+*/
+template<typename CharType, typename BV, unsigned MAX_STR_SIZE>
+class str_sparse_vector
+{
+public:
+    typedef CharType                                 value_type;
+    typedef bm::id_t                                 size_type;
+    typedef BV                                       bvector_type;
+    typedef bvector_type*                            bvector_type_ptr;
+    typedef typename BV::allocator_type              allocator_type;
+    typedef typename bvector_type::allocation_policy allocation_policy_type;
+    typedef bm::sparse_vector<unsigned char, BV>     sparse_vector_type;
+
+    enum str_params
+    {
+        max_str_size = MAX_STR_SIZE,       ///< max string length (positions)
+        row_size = MAX_STR_SIZE + 1,       ///< extract() row size (with 0)
+        sv_plains = (MAX_STR_SIZE * 8)     ///< total number of bit-plains
+    };
+
+    /*! Statistical information about  memory allocation details. */
+    struct statistics : public bv_statistics
+    {};
+
+public:
+    /*!
+        \brief String sparse vector constructor
+
+        \param null_able - defines if vector supports NULL values flag
+            by default it is OFF, use bm::use_null to enable it
+        \param ap - allocation strategy for underlying bit-vectors
+        \param bv_max_size - maximum possible size of underlying bit-vectors
+        \param alloc - allocator for bit-vectors
+    */
+    str_sparse_vector(bm::null_support null_able = bm::no_null,
+                      allocation_policy_type ap = allocation_policy_type(),
+                      size_type bv_max_size = bm::id_max,
+                      const allocator_type&   alloc  = allocator_type());
+
+    /*! \brief content exchange
+    */
+    void swap(str_sparse_vector& sv) BMNOEXEPT;
+
+    // ------------------------------------------------------------
+    /*! @name Element access */
+    //@{
+
+    /*!
+        \brief set specified element with bounds checking and automatic resize
+        \param idx - element index
+        \param str - zero terminated string
+    */
+    void set(size_type idx, const value_type* str);
+
+    /*!
+        \brief push string back into the vector
+        \param str - zero terminated string
+    */
+    void push_back(const value_type* str) { set(size_, str); }
+
+    /*!
+        \brief get specified element without bounds checking
+        \param idx - element index
+        \param str - [out] string buffer
+        \param buf_size - buffer size (string is truncated to buf_size-1)
+        \return string length
+    */
+    size_type get(size_type idx, value_type* str, size_type buf_size) const;
+
+    /** \brief test if specified element is NULL
+        \param idx - element index
+        \return true if it is NULL false if it was assigned or container
+        is not configured to support assignment flags
+    */
+    bool is_null(size_type idx) const;
+
+    /** \brief set specified element to unassigned value (NULL)
+        \param idx - element index
+    */
+    void set_null(size_type idx);
+
+    //@}
+
+    // ------------------------------------------------------------
+    /*! @name Bulk import/export */
+    //@{
+
+    /*!
+        \brief Import list of strings (0 pointers are imported as empty strings)
+        \param strs - array of zero terminated strings
+        \param size - source size
+        \param offset - target index in the vector
+    */
+    void import(const value_type* const* strs, size_type size,
+                size_type offset = 0);
+
+    /*!
+        \brief Bulk export of elements to a matrix of zero terminated strings
+        \param arr - destination matrix, size rows of row_size characters
+        \param size - number of rows
+        \param offset - index in the vector to export from
+        \return number of exported elements
+    */
+    size_type extract(value_type* arr, size_type size, size_type offset = 0) const;
+
+    //@}
+
+    /*! \brief return size of the vector
+        \return size of sparse vector
+    */
+    size_type size() const { return size_; }
+
+    /*! \brief return true if vector is empty
+        \return true if empty
+    */
+    bool empty() const { return (size() == 0); }
+
+    /*! \brief resize vector
+        \param sz - new size
+    */
+    void resize(size_type sz);
+
+    /*! \brief resize to zero, free memory
+    */
+    void clear() BMNOEXEPT;
+
+    /**
+        \brief check if container supports NULL(unassigned) values
+    */
+    bool is_nullable() const { return nullable_; }
+
+    /**
+        \brief Get bit-vector of assigned values or NULL
+        (if not constructed that way)
+    */
+    const bvector_type* get_null_bvector() const
+                                { return nullable_ ? &bv_null_ : 0; }
+
+    /*!
+        \brief check if another vector has the same content, size
+        and character codes
+    */
+    bool equal(const str_sparse_vector& sv) const;
+
+    /*!
+        \brief re-assign character codes in the order of frequency
+        (most frequent characters get the smallest codes)
+    */
+    void remap();
+
+    /*!
+        \brief true if character codes were re-assigned by remap()
+    */
+    bool is_remapped() const { return remapped_; }
+
+    /*!
+        \brief run memory optimization for all vector plains
+        \param temp_block - pre-allocated memory block to avoid unnecessary re-allocs
+        \param opt_mode - requested compression depth
+        \param stat - memory allocation statistics after optimization
+    */
+    void optimize(bm::word_t* temp_block = 0,
+                  typename bvector_type::optmode opt_mode = bvector_type::opt_compress,
+                  statistics* stat = 0);
+
+    /*!
+       @brief Calculates memory statistics.
+       @param st - pointer on statistics structure to be filled in.
+    */
+    void calc_stat(statistics* st) const;
+
+    /*!
+        \brief get read-only access to bit-plain
+        (plain i is bit i%8 of the character position i/8)
+        \return bit-vector for the bit plain or NULL
+    */
+    const bvector_type* get_plain(unsigned i) const
+                            { return sv_[i >> 3].get_plain(i & 7); }
+
+    /*!
+        \brief get total number of bit-plains in the vector
+    */
+    static unsigned plains() { return sv_plains; }
+
+    /*!
+        \brief plain code of a character
+        \return false if the character has no code (not in the vector)
+    */
+    bool char_to_code(value_type ch, unsigned char& code) const
+    {
+        code = remapped_ ? remap_[(unsigned char)ch] : (unsigned char)ch;
+        return code || !ch;
+    }
+
+    /*!
+        \brief character of a plain code
+    */
+    value_type code_to_char(unsigned char code) const
+    {
+        return remapped_ ? unmap_[code] : value_type(code);
+    }
+
+private:
+    /*! \brief plain code of a character, new code is assigned if needed
+    */
+    unsigned char char_code(value_type ch);
+
+    /*! \brief clear character positions from pos of the element idx
+    */
+    void clear_tail(size_type idx, unsigned pos);
+
+private:
+    /// number of strings imported, extracted or re-coded at once
+    enum { chunk_size = bm::gap_max_bits };
+
+    size_type            size_;
+    sparse_vector_type   sv_[MAX_STR_SIZE];  ///< character position columns
+    bool                 nullable_;          ///< NULL support flag
+    bvector_type         bv_null_;           ///< NOT NULL flags
+    allocator_type       alloc_;
+    unsigned char        remap_[256];        ///< character -> plain code
+    value_type           unmap_[256];        ///< plain code -> character
+    unsigned             remap_cnt_;         ///< number of assigned codes
+    bool                 remapped_;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+
+template<typename CharType, typename BV, unsigned MAX_STR_SIZE>
+str_sparse_vector<CharType, BV, MAX_STR_SIZE>::str_sparse_vector(
+                                        bm::null_support null_able,
+                                        allocation_policy_type ap,
+                                        size_type bv_max_size,
+                                        const allocator_type& alloc)
+: size_(0),
+  nullable_(null_able == bm::use_null),
+  bv_null_(ap.strat, ap.glevel_len, bv_max_size, alloc),
+  alloc_(alloc),
+  remap_cnt_(0),
+  remapped_(false)
+{
+    for (unsigned i = 0; i < MAX_STR_SIZE; ++i)
+    {
+        sparse_vector_type sv(bm::no_null, ap, bv_max_size, alloc);
+        sv_[i].swap(sv);
+    }
+    ::memset(remap_, 0, sizeof(remap_));
+    ::memset(unmap_, 0, sizeof(unmap_));
+}
+
+//---------------------------------------------------------------------
+
+template<typename CharType, typename BV, unsigned MAX_STR_SIZE>
+void str_sparse_vector<CharType, BV, MAX_STR_SIZE>::swap(
+                                    str_sparse_vector& sv) BMNOEXEPT
+{
+    if (this == &sv)
+        return;
+    bm::xor_swap(size_, sv.size_);
+    for (unsigned i = 0; i < MAX_STR_SIZE; ++i)
+        sv_[i].swap(sv.sv_[i]);
+    bv_null_.swap(sv.bv_null_);
+    bool b = nullable_; nullable_ = sv.nullable_; sv.nullable_ = b;
+
+    allocator_type alloc_tmp = alloc_;
+    alloc_ = sv.alloc_;
+    sv.alloc_ = alloc_tmp;
+
+    for (unsigned i = 0; i < 256; ++i)
+    {
+        unsigned char c = remap_[i]; remap_[i] = sv.remap_[i]; sv.remap_[i] = c;
+        value_type ch = unmap_[i]; unmap_[i] = sv.unmap_[i]; sv.unmap_[i] = ch;
+    }
+    bm::xor_swap(remap_cnt_, sv.remap_cnt_);
+    bool r = remapped_; remapped_ = sv.remapped_; sv.remapped_ = r;
+}
+
+//---------------------------------------------------------------------
+
+template<typename CharType, typename BV, unsigned MAX_STR_SIZE>
+unsigned char
+str_sparse_vector<CharType, BV, MAX_STR_SIZE>::char_code(value_type ch)
+{
+    unsigned char code;
+    if (char_to_code(ch, code))
+        return code;
+    // new character in a remapped vector
+    BM_ASSERT(remap_cnt_ < 255);
+    code = (unsigned char)(++remap_cnt_);
+    remap_[(unsigned char)ch] = code;
+    unmap_[code] = ch;
+    return code;
+}
+
+//---------------------------------------------------------------------
+
+template<typename CharType, typename BV, unsigned MAX_STR_SIZE>
+void str_sparse_vector<CharType, BV, MAX_STR_SIZE>::clear_tail(size_type idx,
+                                                               unsigned  pos)
+{
+    // strings are contiguous: the first 0 ends the old value
+    for (; pos < MAX_STR_SIZE; ++pos)
+    {
+        sparse_vector_type& sv = sv_[pos];
+        if (idx >= sv.size() || !sv.get(idx))
+            break;
+        sv.set(idx, 0);
+    } // for pos
+}
+
+//---------------------------------------------------------------------
+
+template<typename CharType, typename BV, unsigned MAX_STR_SIZE>
+void str_sparse_vector<CharType, BV, MAX_STR_SIZE>::set(size_type         idx,
+                                                        const value_type* str)
+{
+    if (idx >= size_)
+        size_ = idx + 1;
+    unsigned i = 0;
+    for (; i < MAX_STR_SIZE && str[i]; ++i)
+        sv_[i].set(idx, char_code(str[i]));
+    clear_tail(idx, i);
+    if (nullable_)
+        bv_null_.set(idx);
+}
+
+//---------------------------------------------------------------------
+
+template<typename CharType, typename BV, unsigned MAX_STR_SIZE>
+typename str_sparse_vector<CharType, BV, MAX_STR_SIZE>::size_type
+str_sparse_vector<CharType, BV, MAX_STR_SIZE>::get(size_type   idx,
+                                                   value_type* str,
+                                                   size_type   buf_size) const
+{
+    BM_ASSERT(idx < size_);
+    BM_ASSERT(buf_size);
+    size_type i = 0;
+    for (; i < MAX_STR_SIZE && i + 1 < buf_size; ++i)
+    {
+        const sparse_vector_type& sv = sv_[i];
+        if (idx >= sv.size())
+            break;
+        unsigned char code = sv.get(idx);
+        if (!code)
+            break;
+        str[i] = code_to_char(code);
+    } // for i
+    str[i] = 0;
+    return i;
+}
+
+//---------------------------------------------------------------------
+
+template<typename CharType, typename BV, unsigned MAX_STR_SIZE>
+bool str_sparse_vector<CharType, BV, MAX_STR_SIZE>::is_null(size_type idx) const
+{
+    return nullable_ ? !bv_null_.test(idx) : false;
+}
+
+//---------------------------------------------------------------------
+
+template<typename CharType, typename BV, unsigned MAX_STR_SIZE>
+void str_sparse_vector<CharType, BV, MAX_STR_SIZE>::set_null(size_type idx)
+{
+    if (idx >= size_)
+        size_ = idx + 1;
+    clear_tail(idx, 0);
+    if (nullable_)
+        bv_null_.set(idx, false);
+}
+
+//---------------------------------------------------------------------
+
+template<typename CharType, typename BV, unsigned MAX_STR_SIZE>
+void str_sparse_vector<CharType, BV, MAX_STR_SIZE>::import(
+                                            const value_type* const* strs,
+                                            size_type                size,
+                                            size_type                offset)
+{
+    if (size == 0)
+    {
+        sv_[0].throw_range_error("str_sparse_vector range error (import size 0)");
+    }
+
+    // plain codes of one character position for a chunk of strings,
+    // position i continues only the strings not ended at i-1
+    bm::bit_blocks_buffer<allocator_type>
+            cbuf(alloc_, unsigned(chunk_size / sizeof(bm::word_t) / bm::set_block_size));
+    unsigned char* col = (unsigned char*) cbuf.block(0);
+
+    for (size_type base = 0; base < size; base += chunk_size)
+    {
+        size_type n = (size - base < size_type(chunk_size)) ?
+                                        size - base : size_type(chunk_size);
+        const value_type* const* cstrs = strs + base;
+        size_type from = offset + base;
+
+        unsigned i = 0;
+        for (; i < MAX_STR_SIZE; ++i)
+        {
+            bool any = false;
+            for (size_type k = 0; k < n; ++k)
+            {
+                unsigned char code = 0;
+                if ((i == 0 && cstrs[k]) || (i && col[k]))
+                {
+                    value_type ch = cstrs[k][i];
+                    code = ch ? char_code(ch) : 0;
+                }
+                col[k] = code;
+                any |= bool(code);
+            } // for k
+            if (!any)
+                break;
+            sv_[i].import(col, n, from);
+        } // for i
+
+        // positions past the end of all imported strings
+        for (; i < MAX_STR_SIZE; ++i)
+        {
+            sparse_vector_type& sv = sv_[i];
+            if (from >= sv.size())
+                break;
+            sv.clear_range(from, from + n - 1);
+        } // for i
+    } // for base
+
+    if (offset + size > size_)
+        size_ = offset + size;
+    if (nullable_)
+        bv_null_.set_range(offset, offset + size - 1);
+}
+
+//---------------------------------------------------------------------
+
+template<typename CharType, typename BV, unsigned MAX_STR_SIZE>
+typename str_sparse_vector<CharType, BV, MAX_STR_SIZE>::size_type
+str_sparse_vector<CharType, BV, MAX_STR_SIZE>::extract(value_type* arr,
+                                                       size_type   size,
+                                                       size_type   offset) const
+{
+    if (offset >= size_ || size == 0)
+        return 0;
+    if (size > size_ - offset)
+        size = size_ - offset;
+    ::memset(arr, 0, sizeof(value_type) * row_size * size);
+
+    bm::bit_blocks_buffer<allocator_type>
+            cbuf(alloc_, unsigned(chunk_size / sizeof(bm::word_t) / bm::set_block_size));
+    unsigned char* col = (unsigned char*) cbuf.block(0);
+
+    for (size_type base = 0; base < size; base += chunk_size)
+    {
+        size_type n = (size - base < size_type(chunk_size)) ?
+                                        size - base : size_type(chunk_size);
+        size_type from = offset + base;
+        value_type* rows = arr + base * row_size;
+        for (unsigned i = 0; i < MAX_STR_SIZE; ++i)
+        {
+            const sparse_vector_type& sv = sv_[i];
+            if (from >= sv.size())
+                break;
+            sv.decode(col, from, n);
+            bool any = false;
+            for (size_type k = 0; k < n; ++k)
+            {
+                unsigned char code = col[k];
+                if (code)
+                {
+                    rows[k * row_size + i] = code_to_char(code);
+                    any = true;
+                }
+            } // for k
+            if (!any) // all strings of the chunk ended
+                break;
+        } // for i
+    } // for base
+    return size;
+}
+
+//---------------------------------------------------------------------
+
+template<typename CharType, typename BV, unsigned MAX_STR_SIZE>
+void str_sparse_vector<CharType, BV, MAX_STR_SIZE>::resize(size_type sz)
+{
+    if (sz == size_)
+        return;
+    if (!sz)
+    {
+        clear();
+        return;
+    }
+    if (sz < size_)
+    {
+        for (unsigned i = 0; i < MAX_STR_SIZE; ++i)
+        {
+            if (sv_[i].size() > sz)
+                sv_[i].resize(sz);
+        }
+        if (nullable_)
+            bv_null_.set_range(sz, size_ - 1, false);
+    }
+    size_ = sz;
+}
+
+//---------------------------------------------------------------------
+
+template<typename CharType, typename BV, unsigned MAX_STR_SIZE>
+void str_sparse_vector<CharType, BV, MAX_STR_SIZE>::clear() BMNOEXEPT
+{
+    for (unsigned i = 0; i < MAX_STR_SIZE; ++i)
+        sv_[i].clear();
+    bv_null_.clear(true);
+    size_ = 0;
+    ::memset(remap_, 0, sizeof(remap_));
+    ::memset(unmap_, 0, sizeof(unmap_));
+    remap_cnt_ = 0;
+    remapped_ = false;
+}
+
+//---------------------------------------------------------------------
+
+template<typename CharType, typename BV, unsigned MAX_STR_SIZE>
+bool str_sparse_vector<CharType, BV, MAX_STR_SIZE>::equal(
+                                        const str_sparse_vector& sv) const
+{
+    if (size_ != sv.size_ || remapped_ != sv.remapped_)
+        return false;
+    if (remapped_ && ::memcmp(remap_, sv.remap_, sizeof(remap_)) != 0)
+        return false;
+    if (nullable_ != sv.nullable_)
+        return false;
+    if (nullable_ && bv_null_.compare(sv.bv_null_) != 0)
+        return false;
+    
+    // columns may differ in size, compare their bit-plains
+    for (unsigned i = 0; i < MAX_STR_SIZE; ++i)
+    {
+        for (unsigned j = 0; j < sparse_vector_type::plains(); ++j)
+        {
+            const bvector_type* bv = sv_[i].plain(j);
+            const bvector_type* arg_bv = sv.sv_[i].plain(j);
+            if (bv == arg_bv) // same NULL
+                continue;
+            if (!bv || !arg_bv) // NULL equals an empty plain
+            {
+                if ((bv ? bv : arg_bv)->any())
+                    return false;
+                continue;
+            }
+            if (bv->compare(*arg_bv) != 0)
+                return false;
+        } // for j
+    } // for i
+    return true;
+}
+
+//---------------------------------------------------------------------
+
+template<typename CharType, typename BV, unsigned MAX_STR_SIZE>
+void str_sparse_vector<CharType, BV, MAX_STR_SIZE>::remap()
+{
+    bm::bit_blocks_buffer<allocator_type>
+            cbuf(alloc_, unsigned(chunk_size / sizeof(bm::word_t) / bm::set_block_size));
+    unsigned char* col = (unsigned char*) cbuf.block(0);
+
+    // frequency of the current plain codes over all positions
+    bm::id64_t freq[256];
+    ::memset(freq, 0, sizeof(freq));
+    for (unsigned i = 0; i < MAX_STR_SIZE; ++i)
+    {
+        const sparse_vector_type& sv = sv_[i];
+        for (size_type base = 0; base < sv.size(); base += chunk_size)
+        {
+            size_type n = (sv.size() - base < size_type(chunk_size)) ?
+                                    sv.size() - base : size_type(chunk_size);
+            sv.decode(col, base, n);
+            for (size_type k = 0; k < n; ++k)
+                ++freq[col[k]];
+        } // for base
+    } // for i
+
+    // codes in descending frequency order (0 stays the terminator)
+    unsigned char order[255];
+    unsigned cnt = 0;
+    for (unsigned c = 1; c < 256; ++c)
+    {
+        if (!freq[c])
+            continue;
+        unsigned j = cnt++;
+        for (; j && freq[order[j-1]] < freq[c]; --j)
+            order[j] = order[j-1];
+        order[j] = (unsigned char) c;
+    } // for c
+
+    unsigned char tr[256]; // old code -> new code
+    unsigned char remap[256];
+    value_type    unmap[256];
+    ::memset(tr, 0, sizeof(tr));
+    ::memset(remap, 0, sizeof(remap));
+    ::memset(unmap, 0, sizeof(unmap));
+    for (unsigned j = 0; j < cnt; ++j)
+    {
+        unsigned char code = (unsigned char)(j + 1);
+        value_type ch = code_to_char(order[j]);
+        tr[order[j]] = code;
+        remap[(unsigned char)ch] = code;
+        unmap[code] = ch;
+    } // for j
+
+    // re-code character positions
+    for (unsigned i = 0; i < MAX_STR_SIZE; ++i)
+    {
+        sparse_vector_type& sv = sv_[i];
+        for (size_type base = 0; base < sv.size(); base += chunk_size)
+        {
+            size_type n = (sv.size() - base < size_type(chunk_size)) ?
+                                    sv.size() - base : size_type(chunk_size);
+            sv.decode(col, base, n);
+            for (size_type k = 0; k < n; ++k)
+                col[k] = tr[col[k]];
+            sv.import(col, n, base);
+        } // for base
+        sv.optimize();
+    } // for i
+
+    ::memcpy(remap_, remap, sizeof(remap_));
+    ::memcpy(unmap_, unmap, sizeof(unmap_));
+    remap_cnt_ = cnt;
+    remapped_ = true;
+}
+
+//---------------------------------------------------------------------
+
+template<typename CharType, typename BV, unsigned MAX_STR_SIZE>
+void str_sparse_vector<CharType, BV, MAX_STR_SIZE>::optimize(
+                                bm::word_t*                    temp_block,
+                                typename bvector_type::optmode opt_mode,
+                                statistics*                    st)
+{
+    if (st)
+        st->reset();
+    for (unsigned i = 0; i < MAX_STR_SIZE; ++i)
+    {
+        typename sparse_vector_type::statistics stsv;
+        sv_[i].optimize(temp_block, opt_mode, st ? &stsv : 0);
+        if (st)
+        {
+            st->bit_blocks += stsv.bit_blocks;
+            st->gap_blocks += stsv.gap_blocks;
+            st->max_serialize_mem += stsv.max_serialize_mem;
+            st->memory_used += stsv.memory_used;
+        }
+    } // for i
+    if (nullable_)
+    {
+        typename bvector_type::statistics stbv;
+        bv_null_.optimize(temp_block, opt_mode, &stbv);
+        if (st)
+        {
+            st->bit_blocks += stbv.bit_blocks;
+            st->gap_blocks += stbv.gap_blocks;
+            st->max_serialize_mem += stbv.max_serialize_mem;
+            st->memory_used += stbv.memory_used;
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+
+template<typename CharType, typename BV, unsigned MAX_STR_SIZE>
+void str_sparse_vector<CharType, BV, MAX_STR_SIZE>::calc_stat(
+                                                    statistics* st) const
+{
+    BM_ASSERT(st);
+    st->reset();
+    for (unsigned i = 0; i < MAX_STR_SIZE; ++i)
+    {
+        typename sparse_vector_type::statistics stsv;
+        sv_[i].calc_stat(&stsv);
+        st->bit_blocks += stsv.bit_blocks;
+        st->gap_blocks += stsv.gap_blocks;
+        st->max_serialize_mem += stsv.max_serialize_mem;
+        st->memory_used += stsv.memory_used;
+    } // for i
+    if (nullable_)
+    {
+        typename bvector_type::statistics stbv;
+        bv_null_.calc_stat(&stbv);
+        st->bit_blocks += stbv.bit_blocks;
+        st->gap_blocks += stbv.gap_blocks;
+        st->max_serialize_mem += stbv.max_serialize_mem;
+        st->memory_used += stbv.memory_used;
+    }
+}
+
+//---------------------------------------------------------------------
+
+} // namespace bm
+
+#include "bmundef.h"
+
+#endif
@@ -347,6 +347,39 @@ void vect_bit_trestore(const T  tmatrix[BPC][BPS],
 
 
 
+/**
+    32x32 bit-matrix transposition: bit j of src[i] goes to bit i of dst[j].
+    Transposition is its own inverse, so the same function converts
+    32 values into 32 bit-plain words and bit-plain words back into values.
+    
+    \param src - source 32 words
+    \param dst - destination 32 words
+    @internal
+*/
+inline
+void bit_transpose_32x32(const bm::word_t* BMRESTRICT src,
+                         bm::word_t* BMRESTRICT dst)
+{
+#ifdef VECT_BIT_TRANSPOSE_32x32
+    VECT_BIT_TRANSPOSE_32x32(src, dst);
+#else
+    for (unsigned i = 0; i < 32; ++i)
+        dst[i] = src[i];
+    // recursive swap of off-diagonal blocks: 16x16, 8x8, ... 1x1
+    bm::word_t m = 0x0000FFFFu;
+    for (unsigned j = 16; j != 0; j >>= 1, m ^= (m << j))
+    {
+        for (unsigned k = 0; k < 32; k = (k + j + 1) & ~j)
+        {
+            bm::word_t t = ((dst[k] >> j) ^ dst[k + j]) & m;
+            dst[k] ^= t << j;
+            dst[k + j] ^= t;
+        }
+    }
+#endif
+}
+
+
 /*!
     \brief Compute pairwise Row x Row Humming distances on plains(rows) of 
            the transposed bit block
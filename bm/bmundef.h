@@ -60,6 +60,17 @@ For more information please visit:  http://bitmagic.io
 #undef VECT_OR_ARR
 #undef VECT_SUB_ARR
 #undef VECT_XOR_ARR
+#undef VECT_CRC32C
+#undef VECT_SVB16_DGAP_DECODE
+#undef VECT_BITSCAN64
+#undef VECT_BIT_TO_ARR16
+#undef VECT_GAP_RANK
+#undef VECT_GAP_BFIND
+#undef VECT_BIT_COUNT_RANGE
+#undef VECT_BIT_FIND_FIRST
+#undef VECT_AND_BLOCK_ANY
+#undef VECT_BITCOUNT_AND_LIMIT
+#undef VECT_BIT_TRANSPOSE_32x32
 
 #undef VECT_COPY_BLOCK
 #undef VECT_SET_BLOCK
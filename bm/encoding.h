@@ -51,11 +51,13 @@ public:
     void put_32(bm::word_t  w);
     void put_32(const bm::word_t* w, unsigned count);
     void put_64(bm::id64_t w);
+    void put_varint(bm::id64_t w);
     void put_prefixed_array_32(unsigned char c, 
                                const bm::word_t* w, unsigned count);
     void put_prefixed_array_16(unsigned char c, 
                                const bm::short_t* s, unsigned count,
                                bool encode_count);
+    void put_svb16_dgap(const bm::short_t* s, unsigned count);
     void memcpy(const unsigned char* src, size_t count);
     unsigned size() const;
     unsigned char* get_pos() const;
@@ -87,6 +89,12 @@ public:
     
     /// read bytes from the decode buffer
     void memcpy(unsigned char* dst, size_t count);
+
+    /// read Stream VByte coded d-gaps (byte-order independent)
+    void get_svb16_dgap(bm::short_t* s, unsigned count);
+
+    /// read variable length (7 bits per byte) integer (byte-order independent)
+    bm::id64_t get_varint();
     
     /// Return current buffer pointer
     const unsigned char* get_pos() const { return buf_; }
@@ -138,6 +146,7 @@ public:
     decoder_little_endian(const unsigned char* buf);
     bm::short_t get_16();
     bm::word_t get_32();
+    bm::id64_t get_64();
     void get_32(bm::word_t* w, unsigned count);
     void get_16(bm::short_t* s, unsigned count);
 };
@@ -185,15 +194,15 @@ public:
         {  
             acc |= value << used;
 
-            unsigned free_bits = (sizeof(accum_) * 8) - used;
-            if (count <= free_bits)
+            unsigned free_bits = unsigned(sizeof(accum_) * 8) - used;
+            if (count < free_bits)
             {
                 used += count;
                 break;
             }
-            else
+            else // accumulator is full
             {
-                value >>= free_bits;
+                value = (free_bits == sizeof(accum_) * 8) ? 0 : (value >> free_bits);
                 count -= free_bits;
                 dest_.put_32(acc);
                 acc = used = 0;
@@ -435,6 +444,40 @@ public:
         return current;
     }
 
+    /// read number of bits (1..32)
+    unsigned get_bits(unsigned count)
+    {
+        BM_ASSERT(count && count <= 32);
+        const unsigned acc_bits = unsigned(sizeof(accum_) * 8);
+        unsigned acc = accum_;
+        unsigned used = used_bits_;
+        unsigned value;
+
+        if (used == acc_bits)
+        {
+            acc = src_.get_32();
+            used = 0;
+        }
+        unsigned free_bits = acc_bits - used;
+        if (count <= free_bits)
+        {
+            value = acc & block_set_table<true>::_left[count-1];
+            acc = (count == acc_bits) ? 0 : (acc >> count);
+            used += count;
+        }
+        else // value spans two words
+        {
+            value = acc;
+            acc = src_.get_32();
+            used = count - free_bits;
+            value |= (acc & block_set_table<true>::_left[used-1]) << free_bits;
+            acc >>= used;
+        }
+        accum_ = acc;
+        used_bits_ = used;
+        return value;
+    }
+
 
 private:
     bit_in(const bit_in&);
@@ -472,6 +515,170 @@ private:
     TBitIO&  bout_;
 };
 
+/**
+    Functor to compute size of Elias Gamma encoding (without output)
+    @ingroup gammacode
+*/
+template<typename T>
+class gamma_size_counter
+{
+public:
+    gamma_size_counter() : bits_(0)
+    {}
+
+    /**
+        Account word
+    */
+    BMFORCEINLINE
+    void operator()(T value)
+    {
+        BM_ASSERT(value);
+        bits_ += 2 * bm::ilog2_LUT<unsigned>(value) + 1;
+    }
+
+    /// Number of encoded bits
+    unsigned bits() const { return bits_; }
+
+    /// Encoded size in bytes (bit_out flushes 32-bit words)
+    unsigned size() const { return ((bits_ + 31) >> 5) << 2; }
+private:
+    unsigned bits_;
+};
+
+/**
+    Bit output stub to compute size of the bit stream (without output)
+    @ingroup gammacode
+*/
+class bit_out_counter
+{
+public:
+    bit_out_counter() : bits_(0)
+    {}
+
+    void put_bits(unsigned /*value*/, unsigned count) { bits_ += count; }
+
+    /// Number of encoded bits
+    unsigned bits() const { return bits_; }
+
+    /// Encoded size in bytes (bit_out flushes 32-bit words)
+    unsigned size() const { return ((bits_ + 31) >> 5) << 2; }
+private:
+    unsigned bits_;
+};
+
+/**
+    Encoder stub to compute size of the encoding (without output),
+    dry-run counterpart of the encoder with the same interface
+
+    @ingroup gammacode
+    @sa encoder
+*/
+class encoder_size_counter
+{
+public:
+    typedef size_t position_type;
+public:
+    encoder_size_counter() : pos_(0) {}
+
+    void put_8(unsigned char) { ++pos_; }
+    void put_16(bm::short_t) { pos_ += sizeof(bm::short_t); }
+    void put_16(const bm::short_t*, unsigned count)
+        { pos_ += count * sizeof(bm::short_t); }
+    void put_32(bm::word_t) { pos_ += sizeof(bm::word_t); }
+    void put_32(const bm::word_t*, unsigned count)
+        { pos_ += count * sizeof(bm::word_t); }
+    void put_prefixed_array_32(unsigned char, 
+                               const bm::word_t*, unsigned count)
+        { pos_ += 1 + count * sizeof(bm::word_t); }
+    void put_prefixed_array_16(unsigned char, 
+                               const bm::short_t*, unsigned count,
+                               bool encode_count)
+        { pos_ += 1 + (count + encode_count) * sizeof(bm::short_t); }
+    void put_svb16_dgap(const bm::short_t* s, unsigned count);
+    void memcpy(const unsigned char*, size_t count) { pos_ += count; }
+    unsigned size() const { return unsigned(pos_); }
+    position_type get_pos() const { return pos_; }
+    void set_pos(position_type pos) { pos_ = pos; }
+private:
+    size_t pos_;
+};
+
+/**
+    Binary Interpolative encoding of a sorted list of unique 16-bit values
+    (recursive: middle element is coded with minimal fixed number of bits
+    within the range implied by its neighbours; dense runs take no bits).
+
+    @param bout - bit output (bit_out or bit_out_counter)
+    @param arr - sorted array
+    @param sz - array size
+    @param lo - low bound of values (inclusive)
+    @param hi - high bound of values (inclusive)
+
+    @ingroup gammacode
+*/
+template<typename TBitIO>
+void bic_encode_u16(TBitIO&               bout,
+                    const bm::gap_word_t* arr,
+                    unsigned              sz,
+                    unsigned              lo,
+                    unsigned              hi)
+{
+    for (;sz;)
+    {
+        BM_ASSERT(hi + 1 >= lo + sz);
+        unsigned r = hi - lo - sz + 1;
+        if (!r) // dense run, all values are implied
+            return;
+        unsigned mid_idx = sz >> 1;
+        unsigned val = arr[mid_idx];
+        bout.put_bits(val - lo - mid_idx, bm::bit_scan_reverse32(r) + 1);
+
+        bm::bic_encode_u16(bout, arr, mid_idx, lo, val - 1);
+        arr += mid_idx + 1;
+        sz -= mid_idx + 1;
+        lo = val + 1;
+    }
+}
+
+/**
+    Binary Interpolative decoding of a sorted list of 16-bit values
+
+    @param bin - bit input
+    @param arr - target array
+    @param sz - number of values to decode
+    @param lo - low bound of values (inclusive)
+    @param hi - high bound of values (inclusive)
+
+    @ingroup gammacode
+*/
+template<typename TBitIO>
+void bic_decode_u16(TBitIO&         bin,
+                    bm::gap_word_t* arr,
+                    unsigned        sz,
+                    unsigned        lo,
+                    unsigned        hi)
+{
+    for (;sz;)
+    {
+        unsigned r = hi - lo - sz + 1;
+        if (!r) // dense run
+        {
+            for (unsigned i = 0; i < sz; ++i)
+                arr[i] = bm::gap_word_t(lo + i);
+            return;
+        }
+        unsigned mid_idx = sz >> 1;
+        unsigned val = lo + mid_idx + 
+                       bin.get_bits(bm::bit_scan_reverse32(r) + 1);
+        arr[mid_idx] = bm::gap_word_t(val);
+
+        bm::bic_decode_u16(bin, arr, mid_idx, lo, val - 1);
+        arr += mid_idx + 1;
+        sz -= mid_idx + 1;
+        lo = val + 1;
+    }
+}
+
 
 /**
     Elias Gamma decoder
@@ -551,6 +758,94 @@ inline void encoder::put_prefixed_array_16(unsigned char c,
     put_16(s, count);
 }
 
+/*!
+    \brief Size of Stream VByte (16-bit) encoding of d-gaps 
+    of a sorted array (first value is relative to 0)
+    \ingroup gammacode
+*/
+inline
+unsigned svb16_dgap_size(const bm::short_t* s, unsigned count)
+{
+    unsigned size = ((count + 7) >> 3) + count;
+    bm::short_t prev = 0;
+    for (unsigned k = 0; k < count; ++k)
+    {
+        size += (bm::short_t(s[k] - prev) > 255);
+        prev = s[k];
+    }
+    return size;
+}
+
+inline void encoder_size_counter::put_svb16_dgap(const bm::short_t* s, 
+                                                 unsigned count)
+{
+    pos_ += bm::svb16_dgap_size(s, count);
+}
+
+/*!
+    \brief Encode d-gaps of a sorted array as Stream VByte (16-bit):
+    control bytes (bit per value: 1 or 2 bytes), then data bytes.
+    Format is byte-order independent (little endian data).
+*/
+inline void encoder::put_svb16_dgap(const bm::short_t* s, unsigned count)
+{
+    unsigned char* ctrl = buf_;
+    unsigned char* data = buf_ + ((count + 7) >> 3);
+    ::memset(ctrl, 0, size_t(data - ctrl));
+    bm::short_t prev = 0;
+    for (unsigned k = 0; k < count; ++k)
+    {
+        bm::short_t v = bm::short_t(s[k] - prev);
+        prev = s[k];
+        *data++ = (unsigned char) v;
+        if (v > 255)
+        {
+            ctrl[k >> 3] = (unsigned char)(ctrl[k >> 3] | (1u << (k & 7)));
+            *data++ = (unsigned char)(v >> 8);
+        }
+    }
+    buf_ = data;
+}
+
+/*!
+    \brief Decode Stream VByte (16-bit) coded d-gaps into a sorted array
+    \param buf - source buffer
+    \param s - target array
+    \param count - number of values
+    \return pointer past the encoded data
+    \ingroup gammacode
+*/
+inline
+const unsigned char* svb16_dgap_decode(const unsigned char* buf, 
+                                       bm::short_t*         s, 
+                                       unsigned             count)
+{
+    const unsigned char* ctrl = buf;
+    const unsigned char* data = buf + ((count + 7) >> 3);
+    bm::short_t prev = 0;
+    unsigned k = 0;
+#ifdef VECT_SVB16_DGAP_DECODE
+    // SIMD loads 16 bytes per group, keep the last full group to stay
+    // within the encoded data
+    unsigned groups = count >> 3;
+    if (groups > 1)
+    {
+        --groups;
+        data = VECT_SVB16_DGAP_DECODE(ctrl, data, s, groups, prev);
+        k = groups << 3;
+    }
+#endif
+    for (; k < count; ++k)
+    {
+        bm::short_t v = *data++;
+        if (ctrl[k >> 3] & (1u << (k & 7)))
+            v = bm::short_t(v | (*data++ << 8));
+        prev = bm::short_t(prev + v);
+        s[k] = prev;
+    }
+    return data;
+}
+
 
 /*!
    \fn void encoder::put_8(unsigned char c) 
@@ -727,6 +1022,21 @@ void encoder::put_32(const bm::word_t* w, unsigned count)
 #endif
 }
 
+/*!
+   \fn void encoder::put_varint(bm::id64_t w)
+   \brief Puts variable length integer into encoding buffer
+   (7 bits per byte, high bit - continuation flag, byte-order independent).
+   \param w - word to encode.
+*/
+inline void encoder::put_varint(bm::id64_t w)
+{
+    for (; w >= 0x80; w >>= 7)
+    {
+        *buf_++ = (unsigned char)(w | 0x80);
+    }
+    *buf_++ = (unsigned char) w;
+}
+
 
 // ---------------------------------------------------------------------
 
@@ -742,6 +1052,33 @@ void decoder_base::memcpy(unsigned char* dst, size_t count)
     buf_ += count;
 }
 
+/*!
+    Load Stream VByte coded d-gaps from the decode buffer
+*/
+inline
+void decoder_base::get_svb16_dgap(bm::short_t* s, unsigned count)
+{
+    buf_ = bm::svb16_dgap_decode(buf_, s, count);
+}
+
+/*!
+    Load variable length integer from the decode buffer
+    @sa encoder::put_varint
+*/
+inline
+bm::id64_t decoder_base::get_varint()
+{
+    bm::id64_t w = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        unsigned char b = *buf_++;
+        w |= bm::id64_t(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            break;
+    }
+    return w;
+}
+
 /*!
    \fn decoder::decoder(const unsigned char* buf) 
    \brief Construction
@@ -792,7 +1129,7 @@ inline bm::id64_t decoder::get_64()
 #if (BM_UNALIGNED_ACCESS_OK == 1)
 	bm::id64_t a = *((bm::id64_t*)buf_);
 #else
-	bm::word_t a = buf_[0]+
+	bm::id64_t a = buf_[0]+
                    ((bm::id64_t)buf_[1] << 8)  +
                    ((bm::id64_t)buf_[2] << 16) +
                    ((bm::id64_t)buf_[3] << 24) +
@@ -896,6 +1233,16 @@ BMFORCEINLINE bm::word_t decoder_little_endian::get_32()
     return a;
 }
 
+inline bm::id64_t decoder_little_endian::get_64()
+{
+    bm::id64_t a = ((bm::id64_t)buf_[0] << 56) + ((bm::id64_t)buf_[1] << 48) +
+                   ((bm::id64_t)buf_[2] << 40) + ((bm::id64_t)buf_[3] << 32) +
+                   ((bm::id64_t)buf_[4] << 24) + ((bm::id64_t)buf_[5] << 16) +
+                   ((bm::id64_t)buf_[6] << 8)  +  (bm::id64_t)buf_[7];
+    buf_+=sizeof(a);
+    return a;
+}
+
 inline void decoder_little_endian::get_32(bm::word_t* w, unsigned count)
 {
     if (!w) 
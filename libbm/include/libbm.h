@@ -30,6 +30,7 @@ For more information please visit:  http://bitmagic.io
 #define BM_ERR_BADARG (2)
 #define BM_ERR_RANGE (3)
 #define BM_ERR_CPU   (4)
+#define BM_ERR_CRC   (5)
 
 /* Error codes for Java/JNI incapsulation */
 #define BM_ERR_DETACHED (101)
@@ -44,6 +45,7 @@ For more information please visit:  http://bitmagic.io
 #define BM_ERR_BADARG_MSG   "BM-02: Invalid or missing function argument"
 #define BM_ERR_RANGE_MSG    "BM-03: Incorrect range or index"
 #define BM_ERR_CPU_MSG      "BM-04: Incorrect CPU vectorization (SIMD) version"
+#define BM_ERR_CRC_MSG      "BM-05: Serialized BLOB checksum (CRC32C) mismatch"
 
 #define BM_ERR_DETACHED_MSG    "BM-101: Current thread no attached to JVM"
 #define BM_ERR_JVM_NOT_SUPPORTED_MSG    "BM-102: JVM version not supported"
@@ -67,6 +69,8 @@ For more information please visit:  http://bitmagic.io
 #define BM_BVHANDLE void*
 /* bit-vector enumerator handle */
 #define BM_BVEHANDLE void*
+/* sparse vector handle */
+#define BM_SVHANDLE void*
 
 
 /* arguments codes and values */
@@ -504,6 +508,18 @@ BM_API_EXPORT
 int BM_bvector_enumerator_goto(BM_BVEHANDLE eh, unsigned int pos,
                                int* pvalid, unsigned int* pvalue);
 
+/* Batch decode: copy current and next values into array and advance
+   enumerator past the copied values (bit-blocks are decoded in waves).
+   arr      - target array
+   arr_size - array capacity
+   pcount   - number of values copied (less than arr_size if traversal ended)
+*/
+BM_API_EXPORT
+int BM_bvector_enumerator_next_batch(BM_BVEHANDLE  eh,
+                                     unsigned int* arr,
+                                     size_t        arr_size,
+                                     size_t*       pcount);
+
 
 /* -------------------------------------------- */
 /* bvector serialization                        */
@@ -520,6 +536,19 @@ int BM_bvector_serialize(BM_BVHANDLE h,
                          char*       buf,
                          size_t      buf_size,
                          size_t*     pblob_size);
+
+/*  serialize bit vector with CRC32C checksums
+    (BLOB is verified by BM_bvector_deserialize, BM_ERR_CRC if corrupted)
+    buf - buffer pointer 
+      (should be allocated using BM_bvector_statistics.max_serialize_mem)
+    buf_size - size of the buffer in bytes
+    pblob_size - size of the serialized BLOB
+*/
+BM_API_EXPORT
+int BM_bvector_serialize_crc(BM_BVHANDLE h,
+                             char*       buf,
+                             size_t      buf_size,
+                             size_t*     pblob_size);
     
 /*  deserialize bit vector
     buf - buffer pointer 
@@ -530,6 +559,28 @@ BM_API_EXPORT
 int BM_bvector_deserialize(BM_BVHANDLE   h,
                            const char*   buf,
                            size_t        buf_size);
+
+/*  compute size of the serialized bit vector without producing the BLOB
+    (result matches BM_bvector_serialize BLOB size; the vector is encoded
+     without output, so it takes about as long as BM_bvector_serialize)
+    psize - estimated size of the serialized BLOB in bytes
+*/
+BM_API_EXPORT
+int BM_bvector_serialize_estimate(BM_BVHANDLE h,
+                                  size_t*     psize);
+
+/*  batch count of AND between bit vector and array of serialized BLOBs
+    (BLOBs are decoded block by block against the const vector,
+     safe to call from several threads on disjoint BLOB ranges)
+    blobs - array of serialized BLOBs (from BM_bvector_serialize*)
+    blob_count - number of BLOBs
+    pcounts - [out] array of blob_count results
+*/
+BM_API_EXPORT
+int BM_bvector_count_AND_blobs(BM_BVHANDLE        h,
+                               const char* const* blobs,
+                               size_t             blob_count,
+                               unsigned int*      pcounts);
     
     
 /* -------------------------------------------- */
@@ -547,6 +598,17 @@ BM_API_EXPORT int BM_bvector_count_AND(BM_BVHANDLE h1, BM_BVHANDLE h2, unsigned
 */
 BM_API_EXPORT int BM_bvector_any_AND(BM_BVHANDLE h1, BM_BVHANDLE h2, unsigned int* pany);
 
+/* compute population count of AND of two const bit vectors up to the limit
+   (computation stops when limit is reached, faster than count_AND
+    for threshold checks)
+   limit  - count limit
+   pcount - bit count of AND of two vectors or limit (if count >= limit)
+*/
+BM_API_EXPORT int BM_bvector_count_AND_limit(BM_BVHANDLE   h1,
+                                             BM_BVHANDLE   h2,
+                                             unsigned int  limit,
+                                             unsigned int* pcount);
+
 /* compute population count of XOR of two const bit vectors
    pcount - bit count of XOR of two vectors
 */
@@ -581,6 +643,94 @@ BM_API_EXPORT int BM_bvector_count_OR(BM_BVHANDLE h1, BM_BVHANDLE h2, unsigned i
 BM_API_EXPORT int BM_bvector_any_OR(BM_BVHANDLE h1, BM_BVHANDLE h2, unsigned int* pany);
 
 
+/* -------------------------------------------- */
+/* sparse vector (of unsigned int) methods      */
+/* -------------------------------------------- */
+
+/* construct sparse vector handle
+   null_mode - BM_TRUE to support NULL (not assigned) values
+*/
+BM_API_EXPORT int BM_svector_construct(BM_SVHANDLE* h, int null_mode);
+
+/* destroy sparse vector handle */
+BM_API_EXPORT int BM_svector_free(BM_SVHANDLE h);
+
+/* get sparse vector size
+   psize - return size of the vector
+*/
+BM_API_EXPORT int BM_svector_get_size(BM_SVHANDLE h, unsigned int* psize);
+
+/* set value
+   i - element index (vector is extended if needed)
+   val - value to set
+*/
+BM_API_EXPORT int BM_svector_set_value(BM_SVHANDLE h, unsigned int i, unsigned int val);
+
+/* get value
+   i - element index (BM_ERR_RANGE if out of size)
+   pval - return value (0 for NULL)
+*/
+BM_API_EXPORT int BM_svector_get_value(BM_SVHANDLE h, unsigned int i, unsigned int* pval);
+
+/* import values from array
+   arr - source array
+   arr_size - array size
+   offset - target index of the first element
+*/
+BM_API_EXPORT
+int BM_svector_import(BM_SVHANDLE         h,
+                      const unsigned int* arr,
+                      unsigned int        arr_size,
+                      unsigned int        offset);
+
+/* optimize sparse vector memory consumption
+*/
+BM_API_EXPORT int BM_svector_optimize(BM_SVHANDLE h);
+
+
+/* -------------------------------------------- */
+/* sparse vector search                         */
+/* -------------------------------------------- */
+
+/* find all elements EQ to the search value
+   hbv - [out] handle of result bit-vector
+*/
+BM_API_EXPORT
+int BM_svector_find_eq(BM_SVHANDLE h, unsigned int val, BM_BVHANDLE hbv);
+
+/* count elements EQ to the search value
+   (faster than find_eq, result bit-vector is not built)
+   pcount - number of elements found
+*/
+BM_API_EXPORT
+int BM_svector_count_eq(BM_SVHANDLE h, unsigned int val, unsigned int* pcount);
+
+/* check if any element is EQ to the search value
+   pany - non-zero if any elements were found
+*/
+BM_API_EXPORT
+int BM_svector_any_eq(BM_SVHANDLE h, unsigned int val, unsigned int* pany);
+
+/* count elements in a closed range of values [from..to]
+   (result bit-vector is not built)
+   pcount - number of elements found
+*/
+BM_API_EXPORT
+int BM_svector_count_range(BM_SVHANDLE   h,
+                           unsigned int  from,
+                           unsigned int  to,
+                           unsigned int* pcount);
+
+/* check if any element is in a closed range of values [from..to]
+   pany - non-zero if any elements were found
+*/
+BM_API_EXPORT
+int BM_svector_any_range(BM_SVHANDLE   h,
+                         unsigned int  from,
+                         unsigned int  to,
+                         unsigned int* pany);
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -32,11 +32,14 @@ static jmp_buf ex_buf__;
 #include "bmsimd.h"
 #include "bmcalloc.h"
 #include "bm.h"
+#include "bmsparsevec.h"
+#include "bmsparsevec_algo.h"
 
 #include <new>
 
 typedef libbm::standard_allocator              TBM_Alloc;
 typedef bm::bvector<libbm::standard_allocator> TBM_bvector;
+typedef bm::sparse_vector<unsigned int, TBM_bvector> TBM_svector;
 
 
 #include "libbm_impl.cpp"
@@ -27,7 +27,8 @@ typedef bm::bvector<libbm::standard_allocator>::enumerator TBM_bvector_enumerato
 #define BM_CATCH_ALL \
     CATCH (BM_ERR_BADALLOC) { return BM_ERR_BADALLOC; } \
     CATCH (BM_ERR_BADARG)   { return BM_ERR_BADARG; } \
-    CATCH (BM_ERR_RANGE)    { return BM_ERR_RANGE; }
+    CATCH (BM_ERR_RANGE)    { return BM_ERR_RANGE; } \
+    CATCH (BM_ERR_CRC)      { return BM_ERR_CRC; }
 
 
 // -------------------------------------------------------------------
@@ -141,6 +142,8 @@ const char* BM_error_msg(int errcode)
         return BM_ERR_RANGE_MSG;
     case BM_ERR_CPU:
         return BM_ERR_CPU_MSG;
+    case BM_ERR_CRC:
+        return BM_ERR_CRC_MSG;
     }
     return BM_UNK_MSG;
 }
@@ -918,12 +921,39 @@ int BM_bvector_serialize(BM_BVHANDLE h,
     return BM_OK;
 }
 
+// -----------------------------------------------------------------
+
+int BM_bvector_serialize_crc(BM_BVHANDLE h,
+                             char*       buf,
+                             size_t      buf_size,
+                             size_t*     pblob_size)
+{
+    if (!h || !pblob_size)
+        return BM_ERR_BADARG;
+    
+    BM_TRY
+    {
+        BM_DECLARE_TEMP_BLOCK(tb)
+    
+        const TBM_bvector* bv = (TBM_bvector*)h;
+        
+        bm::serializer<TBM_bvector> bvs(TBM_bvector::allocator_type(), tb);
+        bvs.set_compression_level(4);
+        bvs.crc32c_serialization(true);
+        
+        *pblob_size = bvs.serialize(*bv, (unsigned char*)buf, (unsigned)buf_size);
+    }
+    BM_CATCH_ALL
+    ETRY;
+    return BM_OK;
+}
+
 
 // -----------------------------------------------------------------
 
 int BM_bvector_deserialize(BM_BVHANDLE   h,
                            const char*   buf,
-                           size_t        /*buf_size*/)
+                           size_t        buf_size)
 {
     if (!h)
         return BM_ERR_BADARG;
@@ -931,7 +961,53 @@ int BM_bvector_deserialize(BM_BVHANDLE   h,
     BM_TRY
     {
         TBM_bvector* bv = (TBM_bvector*)h;
-        bm::deserialize(*bv, (const unsigned char*)buf);
+        bm::deserialize(*bv, (const unsigned char*)buf, 0,
+                        (const TBM_bvector*)0, buf_size);
+    }
+    BM_CATCH_ALL
+    ETRY;
+    return BM_OK;
+}
+
+// -----------------------------------------------------------------
+
+int BM_bvector_serialize_estimate(BM_BVHANDLE h,
+                                  size_t*     psize)
+{
+    if (!h || !psize)
+        return BM_ERR_BADARG;
+    
+    BM_TRY
+    {
+        const TBM_bvector* bv = (TBM_bvector*)h;
+        *psize = bv->estimate_serialized_size(4);
+    }
+    BM_CATCH_ALL
+    ETRY;
+    return BM_OK;
+}
+
+// -----------------------------------------------------------------
+
+int BM_bvector_count_AND_blobs(BM_BVHANDLE        h,
+                               const char* const* blobs,
+                               size_t             blob_count,
+                               unsigned int*      pcounts)
+{
+    if (!h || (blob_count && (!blobs || !pcounts)))
+        return BM_ERR_BADARG;
+    
+    BM_TRY
+    {
+        BM_DECLARE_TEMP_BLOCK(tb)
+        
+        const TBM_bvector* bv = (TBM_bvector*)h;
+        bm::operation_deserializer<TBM_bvector>::count_and_batch(
+                                *bv, 
+                                (const unsigned char* const*)blobs, 
+                                blob_count, 
+                                pcounts,
+                                tb);
     }
     BM_CATCH_ALL
     ETRY;
@@ -1083,6 +1159,39 @@ int BM_bvector_enumerator_goto(BM_BVEHANDLE eh, unsigned int pos,
 }
 
 
+// -----------------------------------------------------------------
+
+int BM_bvector_enumerator_next_batch(BM_BVEHANDLE  eh,
+                                     unsigned int* arr,
+                                     size_t        arr_size,
+                                     size_t*       pcount)
+{
+    if (!eh || !pcount || (arr_size && !arr))
+        return BM_ERR_BADARG;
+    
+    // copy survives longjmp() from BM_TRY (-Wclobbered)
+    volatile size_t arr_cap = arr_size;
+    BM_TRY
+    {
+        TBM_bvector_enumerator* bvenum = (TBM_bvector_enumerator*)eh;
+        size_t cnt = 0;
+        while (cnt < arr_cap)
+        {
+            size_t chunk = arr_cap - cnt;
+            if (chunk > bm::id_max)
+                chunk = bm::id_max;
+            unsigned dcnt = bvenum->decode(arr + cnt, unsigned(chunk));
+            cnt += dcnt;
+            if (dcnt < chunk) // traversal ended
+                break;
+        }
+        *pcount = cnt;
+    }
+    BM_CATCH_ALL
+    ETRY;
+    return BM_OK;
+}
+
 // -----------------------------------------------------------------
 
 int BM_bvector_count_AND(BM_BVHANDLE h1, BM_BVHANDLE h2, unsigned int* pcount)
@@ -1119,6 +1228,26 @@ int BM_bvector_any_AND(BM_BVHANDLE h1, BM_BVHANDLE h2, unsigned int* pany)
 
 // -----------------------------------------------------------------
 
+int BM_bvector_count_AND_limit(BM_BVHANDLE   h1,
+                               BM_BVHANDLE   h2,
+                               unsigned int  limit,
+                               unsigned int* pcount)
+{
+    if (!h1 || !h2 || !pcount)
+        return BM_ERR_BADARG;
+    BM_TRY
+    {
+        const TBM_bvector* bv1 = (TBM_bvector*)h1;
+        const TBM_bvector* bv2 = (TBM_bvector*)h2;
+        *pcount = bm::count_and_limit(*bv1, *bv2, limit);
+    }
+    BM_CATCH_ALL
+    ETRY;
+    return BM_OK;
+}
+
+// -----------------------------------------------------------------
+
 int BM_bvector_count_XOR(BM_BVHANDLE h1, BM_BVHANDLE h2, unsigned int* pcount)
 {
     if (!h1 || !h2 || !pcount)
@@ -1221,3 +1350,221 @@ int BM_bvector_any_OR(BM_BVHANDLE h1, BM_BVHANDLE h2, unsigned int* pany)
 
 // -----------------------------------------------------------------
 
+int BM_svector_construct(BM_SVHANDLE* h, int null_mode)
+{
+    if (h == 0)
+        return BM_ERR_BADARG;
+    // allocated before BM_TRY, so the catch block can free it
+    void* mem = ::malloc(sizeof(TBM_svector));
+    if (mem == 0)
+    {
+        *h = 0;
+        return BM_ERR_BADALLOC;
+    }
+    BM_TRY
+    {
+        // placement new just to call the constructor
+        TBM_svector* sv = new(mem) TBM_svector(null_mode ? bm::use_null 
+                                                         : bm::no_null);
+        *h = sv;
+    }
+    CATCH (BM_ERR_BADALLOC)
+    {
+        ::free(mem);
+        *h = 0;
+        return BM_ERR_BADALLOC;
+    }
+    ETRY;
+
+    return BM_OK;
+}
+
+// -----------------------------------------------------------------
+
+int BM_svector_free(BM_SVHANDLE h)
+{
+    if (!h)
+        return BM_ERR_BADARG;
+    TBM_svector* sv = (TBM_svector*)h;
+    sv->~TBM_svector();
+    ::free(h);
+
+    return BM_OK;
+}
+
+// -----------------------------------------------------------------
+
+int BM_svector_get_size(BM_SVHANDLE h, unsigned int* psize)
+{
+    if (!h || !psize)
+        return BM_ERR_BADARG;
+    const TBM_svector* sv = (TBM_svector*)h;
+    *psize = sv->size();
+    return BM_OK;
+}
+
+// -----------------------------------------------------------------
+
+int BM_svector_set_value(BM_SVHANDLE h, unsigned int i, unsigned int val)
+{
+    if (!h)
+        return BM_ERR_BADARG;
+    BM_TRY
+    {
+        TBM_svector* sv = (TBM_svector*)h;
+        sv->set(i, val);
+    }
+    BM_CATCH_ALL
+    ETRY;
+    return BM_OK;
+}
+
+// -----------------------------------------------------------------
+
+int BM_svector_get_value(BM_SVHANDLE h, unsigned int i, unsigned int* pval)
+{
+    if (!h || !pval)
+        return BM_ERR_BADARG;
+    const TBM_svector* sv = (TBM_svector*)h;
+    if (i >= sv->size())
+        return BM_ERR_RANGE;
+    BM_TRY
+    {
+        *pval = sv->get(i);
+    }
+    BM_CATCH_ALL
+    ETRY;
+    return BM_OK;
+}
+
+// -----------------------------------------------------------------
+
+int BM_svector_import(BM_SVHANDLE         h,
+                      const unsigned int* arr,
+                      unsigned int        arr_size,
+                      unsigned int        offset)
+{
+    if (!h || !arr || !arr_size)
+        return BM_ERR_BADARG;
+    BM_TRY
+    {
+        TBM_svector* sv = (TBM_svector*)h;
+        sv->import(arr, arr_size, offset);
+    }
+    BM_CATCH_ALL
+    ETRY;
+    return BM_OK;
+}
+
+// -----------------------------------------------------------------
+
+int BM_svector_optimize(BM_SVHANDLE h)
+{
+    if (!h)
+        return BM_ERR_BADARG;
+    BM_TRY
+    {
+        BM_DECLARE_TEMP_BLOCK(tb)
+        TBM_svector* sv = (TBM_svector*)h;
+        sv->optimize(tb);
+    }
+    BM_CATCH_ALL
+    ETRY;
+    return BM_OK;
+}
+
+// -----------------------------------------------------------------
+
+int BM_svector_find_eq(BM_SVHANDLE h, unsigned int val, BM_BVHANDLE hbv)
+{
+    if (!h || !hbv)
+        return BM_ERR_BADARG;
+    BM_TRY
+    {
+        const TBM_svector* sv = (TBM_svector*)h;
+        TBM_bvector* bv = (TBM_bvector*)hbv;
+        bm::sparse_vector_scanner<TBM_svector> scanner;
+        bv->clear(true);
+        scanner.find_eq(*sv, val, *bv);
+    }
+    BM_CATCH_ALL
+    ETRY;
+    return BM_OK;
+}
+
+// -----------------------------------------------------------------
+
+int BM_svector_count_eq(BM_SVHANDLE h, unsigned int val, unsigned int* pcount)
+{
+    if (!h || !pcount)
+        return BM_ERR_BADARG;
+    BM_TRY
+    {
+        const TBM_svector* sv = (TBM_svector*)h;
+        bm::sparse_vector_scanner<TBM_svector> scanner;
+        *pcount = scanner.count_eq(*sv, val);
+    }
+    BM_CATCH_ALL
+    ETRY;
+    return BM_OK;
+}
+
+// -----------------------------------------------------------------
+
+int BM_svector_any_eq(BM_SVHANDLE h, unsigned int val, unsigned int* pany)
+{
+    if (!h || !pany)
+        return BM_ERR_BADARG;
+    BM_TRY
+    {
+        const TBM_svector* sv = (TBM_svector*)h;
+        bm::sparse_vector_scanner<TBM_svector> scanner;
+        *pany = scanner.any_eq(*sv, val);
+    }
+    BM_CATCH_ALL
+    ETRY;
+    return BM_OK;
+}
+
+// -----------------------------------------------------------------
+
+int BM_svector_count_range(BM_SVHANDLE   h,
+                           unsigned int  from,
+                           unsigned int  to,
+                           unsigned int* pcount)
+{
+    if (!h || !pcount)
+        return BM_ERR_BADARG;
+    BM_TRY
+    {
+        const TBM_svector* sv = (TBM_svector*)h;
+        bm::sparse_vector_scanner<TBM_svector> scanner;
+        *pcount = scanner.count_range(*sv, from, to);
+    }
+    BM_CATCH_ALL
+    ETRY;
+    return BM_OK;
+}
+
+// -----------------------------------------------------------------
+
+int BM_svector_any_range(BM_SVHANDLE   h,
+                         unsigned int  from,
+                         unsigned int  to,
+                         unsigned int* pany)
+{
+    if (!h || !pany)
+        return BM_ERR_BADARG;
+    BM_TRY
+    {
+        const TBM_svector* sv = (TBM_svector*)h;
+        bm::sparse_vector_scanner<TBM_svector> scanner;
+        *pany = scanner.any_range(*sv, from, to);
+    }
+    BM_CATCH_ALL
+    ETRY;
+    return BM_OK;
+}
+
+// -----------------------------------------------------------------
+
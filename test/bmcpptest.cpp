@@ -0,0 +1,2382 @@
+/*
+     BitMagic Library C - C++ core unit test.
+*/
+
+
+/*
+Copyright(c) 2002-2018 Anatoliy Kuznetsov(anatoliy_kuznetsov at yahoo.com)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+For more information please visit:  http://bitmagic.io
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+
+#include "bm.h"
+#include "bmserial.h"
+#include "bmsparsevec.h"
+#include "bmsparsevec_serial.h"
+#include "bmsparsevec_util.h"
+#include "bmsparsevec_algo.h"
+#include "bmstrsparsevec.h"
+
+
+typedef bm::bvector<> bvect;
+typedef bm::sparse_vector<unsigned, bvect> svector_u32;
+typedef bm::sparse_vector<bm::id64_t, bvect> svector_u64;
+typedef bm::sparse_vector<int, bvect> svector_i32;
+typedef bm::compressed_buffer_collection<bvect> buffer_collection;
+
+
+static
+void FillTestVector(bvect& bv, unsigned k)
+{
+    unsigned i;
+    switch (k)
+    {
+    case 0: // sparse bits
+        for (i = 0; i < 1000000; i += 1000)
+            bv.set(i);
+        break;
+    case 1: // ranges
+        bv.set_range(2000000, 3500000);
+        bv.set_range(2000500, 2000700, false);
+        break;
+    case 2: // dense bits
+        for (i = 5000000; i < 5300000; i += 3)
+            bv.set(i);
+        break;
+    case 3: // islands of bits
+        for (i = 7000000; i < 7400000; i += 7)
+        {
+            if ((i / 4096) & 1)
+                bv.set(i);
+        }
+        break;
+    case 4: // clustered ids
+        for (i = 9000000; i < 9600000; i += 1 + (i % 61))
+            bv.set(i);
+        break;
+    }
+}
+
+static
+int SerializeRoundTrip(const bvect& bv, bm::serializer<bvect>& bvs,
+                       const bvect* bv_ref, const char* msg)
+{
+    bvect::statistics st;
+    bv.calc_stat(&st);
+    std::vector<unsigned char> buf(st.max_serialize_mem);
+
+    size_t est_size = bvs.estimate_serialized_size(bv);
+    unsigned blob_size = bvs.serialize(bv, &buf[0], buf.size());
+    if (est_size != blob_size)
+    {
+        printf("%s: estimate=%u serialized=%u\n",
+               msg, unsigned(est_size), blob_size);
+        return 1;
+    }
+    bvect bv2;
+    bm::deserialize(bv2, &buf[0], 0, bv_ref);
+    if (bv2 != bv)
+    {
+        printf("%s: deserialized vector mismatch\n", msg);
+        return 1;
+    }
+    return 0;
+}
+
+static
+int SerializerEstimateTest()
+{
+    int res = 0;
+    bvect bv, bv_ref;
+    char msg[128];
+
+    for (unsigned k = 0; k < 5; ++k)
+    {
+        FillTestVector(bv, k);
+        for (unsigned inv = 0; inv < 2; ++inv)
+        {
+            bv.optimize();
+            bv_ref = bv;
+            for (unsigned i = 1000; i < 300000; i += 5)
+                bv_ref.flip(i);
+            bv_ref.set_range(2100000, 2300000, false);
+
+            for (unsigned level = 0; level <= 5; ++level)
+            {
+                for (unsigned mode = 0; mode < 8; ++mode)
+                {
+                    bm::serializer<bvect> bvs;
+                    bvs.set_compression_level(level);
+                    bvs.crc32c_serialization(mode & 1);
+                    bvs.svb_serialization(mode & 4);
+                    bvs.set_ref_vector((mode & 2) ? &bv_ref : 0);
+                    sprintf(msg, "vector=%u inv=%u level=%u mode=%u",
+                            k, inv, level, mode);
+                    res = SerializeRoundTrip(bv, bvs,
+                                             (mode & 2) ? &bv_ref : 0, msg);
+                    if (res)
+                        return res;
+                    if (mode == 0 && bv.estimate_serialized_size(level) !=
+                                     bvs.estimate_serialized_size(bv))
+                    {
+                        printf("%s: bvector estimate mismatch\n", msg);
+                        return 1;
+                    }
+                }
+            }
+            bv.flip(); // dense (mostly ONE) variant
+        }
+    }
+    return res;
+}
+
+static
+int SerializerRefTest()
+{
+    bvect bv, bv_ref, bv2;
+    FillTestVector(bv_ref, 1);
+    FillTestVector(bv_ref, 3);
+    bv = bv_ref;
+    bv.set_range(2500000, 2600000, false); // XOR difference
+    bv.set(7000001);
+    FillTestVector(bv, 0);                  // blocks not in the reference
+    bv.optimize();
+
+    bm::serializer<bvect> bvs;
+    bvs.set_ref_vector(&bv_ref);
+    bm::serializer<bvect>::buffer buf;
+    bvs.serialize(bv, buf, 0);
+
+    bm::deserialize(bv2, buf.buf(), 0, &bv_ref);
+    if (bv2 != bv)
+    {
+        printf("Reference round trip mismatch\n");
+        return 1;
+    }
+
+    // reference BLOB without the reference vector must be rejected
+    int err_count = 0;
+    try
+    {
+        bvect bv3;
+        bm::deserialize(bv3, buf.buf());
+    }
+    catch (std::logic_error&)
+    {
+        ++err_count;
+    }
+    try
+    {
+        bvect bv3;
+        bm::operation_deserializer<bvect>::deserialize(bv3, buf.buf(), 0,
+                                                       bm::set_OR);
+    }
+    catch (std::logic_error&)
+    {
+        ++err_count;
+    }
+    try
+    {
+        const unsigned char* bufs[1] = { buf.buf() };
+        bm::id_t counts[1];
+        bm::operation_deserializer<bvect>::count_and_batch(bv, bufs, 1,
+                                                           counts);
+    }
+    catch (std::logic_error&)
+    {
+        ++err_count;
+    }
+    if (err_count != 3)
+    {
+        printf("Missing reference vector not detected (%i of 3)\n",
+               err_count);
+        return 1;
+    }
+    return 0;
+}
+
+static
+int SerializerCRCTest()
+{
+    bvect bv;
+    for (unsigned k = 0; k < 5; ++k)
+        FillTestVector(bv, k);
+    bv.optimize();
+
+    bm::serializer<bvect> bvs;
+    bvs.crc32c_serialization(true);
+    bm::serializer<bvect>::buffer sbuf;
+    bvs.serialize(bv, sbuf, 0);
+    if (sbuf.size() < 4 * bm::set_crc32c_chunk_size)
+    {
+        printf("CRC test BLOB is too small: %u\n", unsigned(sbuf.size()));
+        return 1;
+    }
+
+    // damaged chunk length may point past the BLOB (no size in the API)
+    std::vector<unsigned char> buf(sbuf.size() + 4 * bm::set_crc32c_chunk_size);
+    ::memcpy(&buf[0], sbuf.buf(), sbuf.size());
+
+    bvect bv2;
+    bm::deserialize(bv2, &buf[0]);
+    if (bv2 != bv)
+    {
+        printf("CRC round trip mismatch\n");
+        return 1;
+    }
+    {
+        const unsigned char* bufs[1] = { &buf[0] };
+        bm::id_t counts[1];
+        bm::operation_deserializer<bvect>::count_and_batch(bv, bufs, 1, counts);
+        if (counts[0] != bv.count())
+        {
+            printf("CRC count_and_batch mismatch\n");
+            return 1;
+        }
+    }
+
+    // truncated BLOB with known size: no read past the buffer end
+    for (size_t sz = 16; sz < sbuf.size(); sz += sbuf.size() / 7)
+    {
+        std::vector<unsigned char> tbuf(sbuf.buf(), sbuf.buf() + sz);
+        bool detected = false;
+        try
+        {
+            bvect bv3;
+            bm::deserialize(bv3, &tbuf[0], 0, (const bvect*)0, tbuf.size());
+        }
+        catch (std::logic_error&)
+        {
+            detected = true;
+        }
+        if (!detected)
+        {
+            printf("Truncated BLOB (%u of %u) not detected\n",
+                   unsigned(sz), unsigned(sbuf.size()));
+            return 1;
+        }
+    }
+    {
+        bvect bv3;
+        bm::deserialize(bv3, sbuf.buf(), 0, (const bvect*)0, sbuf.size());
+        if (bv3 != bv)
+        {
+            printf("CRC round trip with BLOB size mismatch\n");
+            return 1;
+        }
+    }
+
+    // every damaged byte (except header flag) must be detected
+    // before the damaged chunk gets decoded
+    for (size_t pos = 1; pos < sbuf.size(); pos += 1 + pos / 64)
+    {
+        buf[pos] ^= 0x10;
+        int err_count = 0;
+        try
+        {
+            bvect bv3;
+            bm::deserialize(bv3, &buf[0]);
+        }
+        catch (std::logic_error&)
+        {
+            ++err_count;
+        }
+        try
+        {
+            bvect bv3;
+            bv3.set_range(0, 10000000);
+            bm::operation_deserializer<bvect>::deserialize(bv3, &buf[0], 0,
+                                                           bm::set_AND);
+        }
+        catch (std::logic_error&)
+        {
+            ++err_count;
+        }
+        try
+        {
+            const unsigned char* bufs[1] = { &buf[0] };
+            bm::id_t counts[1];
+            bm::operation_deserializer<bvect>::count_and_batch(bv, bufs, 1,
+                                                               counts);
+        }
+        catch (std::logic_error&)
+        {
+            ++err_count;
+        }
+        buf[pos] ^= 0x10;
+        if (err_count != 3)
+        {
+            printf("Damaged byte %u of %u not detected (%i of 3)\n",
+                   unsigned(pos), unsigned(sbuf.size()), err_count);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static
+int SerializerSVBTest()
+{
+    bvect bv;
+    for (unsigned k = 0; k < 5; ++k)
+        FillTestVector(bv, k);
+    bv.optimize();
+
+    bm::serializer<bvect>::buffer buf_plain;
+    {
+        bm::serializer<bvect> bvs;
+        bvs.set_compression_level(3);
+        bvs.serialize(bv, buf_plain, 0);
+    }
+    for (unsigned level = 3; level <= 5; ++level)
+    {
+        bm::serializer<bvect> bvs;
+        bvs.set_compression_level(level);
+        bvs.svb_serialization(true);
+        bm::serializer<bvect>::buffer buf;
+        bvs.serialize(bv, buf, 0);
+        if (level == 3 && buf.size() >= buf_plain.size())
+        {
+            printf("Stream VByte is not used at level 3: %u >= %u\n",
+                   unsigned(buf.size()), unsigned(buf_plain.size()));
+            return 1;
+        }
+
+        bvect bv2;
+        bm::deserialize(bv2, buf.buf());
+        if (bv2 != bv)
+        {
+            printf("Stream VByte round trip mismatch (level %u)\n", level);
+            return 1;
+        }
+
+        // iterator (streaming) deserialization
+        bvect bv3;
+        bv3.set_range(0, 8000000);
+        bm::operation_deserializer<bvect>::deserialize(bv3, buf.buf(), 0,
+                                                       bm::set_AND);
+        bvect bv4(bv);
+        bv4.set_range(8000001, bm::id_max - 1, false);
+        if (bv3 != bv4)
+        {
+            printf("Stream VByte AND mismatch (level %u)\n", level);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static
+int SerializerBICTest()
+{
+    // clustered sparse ids: runs of adjacent ids with random gaps
+    bvect bv;
+    unsigned seed = 12345;
+    for (unsigned i = 0; i < 30000000; )
+    {
+        seed = seed * 1103515245u + 12345u;
+        unsigned run = (seed >> 16) % 9;
+        for (unsigned j = 0; j < run; ++j)
+            bv.set(i + j);
+        i += run + 1 + (seed >> 8) % 700;
+    }
+    bvect bv_inv(bv); // mostly ONE blocks with clustered holes
+    bv_inv.invert();
+    bv_inv.set_range(40000000, bm::id_max - 1, false);
+
+    const bvect* vects[2] = { &bv, &bv_inv };
+    for (unsigned k = 0; k < 2; ++k)
+    {
+        bvect bv1(*vects[k]);
+        bv1.optimize();
+
+        bm::serializer<bvect>::buffer buf4, buf5;
+        bm::serializer<bvect> bvs;
+        bvs.set_compression_level(4);
+        bvs.serialize(bv1, buf4, 0);
+        bvs.set_compression_level(5);
+        bvs.serialize(bv1, buf5, 0);
+        if (buf5.size() >= buf4.size())
+        {
+            printf("Level 5 is not smaller than level 4: %u >= %u\n",
+                   unsigned(buf5.size()), unsigned(buf4.size()));
+            return 1;
+        }
+
+        bvect bv2;
+        bm::deserialize(bv2, buf5.buf());
+        if (bv2 != bv1)
+        {
+            printf("Level 5 round trip mismatch (vector %u)\n", k);
+            return 1;
+        }
+
+        // iterator (streaming) deserialization: OR and COUNT_AND
+        bvect bv3;
+        bm::operation_deserializer<bvect>::deserialize(bv3, buf5.buf(), 0,
+                                                       bm::set_OR);
+        if (bv3 != bv1)
+        {
+            printf("Level 5 OR mismatch (vector %u)\n", k);
+            return 1;
+        }
+        bvect bv_q;
+        bv_q.set_range(1000000, 20000000);
+        unsigned cnt = bm::operation_deserializer<bvect>::deserialize(
+                                    bv_q, buf5.buf(), 0, bm::set_COUNT_AND);
+        if (cnt != bm::count_and(bv_q, bv1))
+        {
+            printf("Level 5 COUNT_AND mismatch (vector %u)\n", k);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static
+int CountAndBatchTest()
+{
+    bvect bv_q;
+    bv_q.set_range(0, 2500000);          // blocks before and after are NULL
+    bv_q.set_range(5100000, 5200000);
+    for (unsigned i = 6990000; i < 7100000; i += 5)
+        bv_q.set(i);
+    bv_q.optimize();
+
+    const unsigned blob_count = 5 * 4;
+    bm::serializer<bvect>::buffer bufs[blob_count];
+    const unsigned char* blobs[blob_count];
+    bm::id_t counts[blob_count];
+    bvect vects[5];
+    for (unsigned k = 0; k < 5; ++k)
+    {
+        FillTestVector(vects[k], k);
+        vects[k].optimize();
+        for (unsigned m = 0; m < 4; ++m) // level 3, 4, 5, Stream VByte
+        {
+            bm::serializer<bvect> bvs;
+            bvs.set_compression_level(m < 3 ? 3 + m : 4);
+            bvs.svb_serialization(m == 3);
+            bvs.serialize(vects[k], bufs[k * 4 + m], 0);
+            blobs[k * 4 + m] = bufs[k * 4 + m].buf();
+        }
+    }
+    bm::operation_deserializer<bvect>::count_and_batch(bv_q, blobs,
+                                                       blob_count, counts);
+    for (unsigned i = 0; i < blob_count; ++i)
+    {
+        bm::id_t cnt = bm::count_and(bv_q, vects[i / 4]);
+        if (counts[i] != cnt)
+        {
+            printf("count_and_batch mismatch BLOB %u: %u != %u\n",
+                   i, counts[i], cnt);
+            return 1;
+        }
+    }
+
+    // damaged BLOB (no CRC32C): no out of block access,
+    // format errors are reported
+    bvect bv_all;
+    bv_all.set_range(0, 10000000);
+    std::vector<unsigned char> buf(bufs[0].size() + 65536);
+    for (unsigned i = 0; i < blob_count; ++i)
+    {
+        size_t size = bufs[i].size();
+        ::memcpy(&buf[0], bufs[i].buf(), size);
+        for (size_t pos = 3; pos < size; pos += 1 + pos / 16)
+        {
+            unsigned char c = buf[pos];
+            buf[pos] = (unsigned char)(c ^ 0x5A);
+            const unsigned char* dblobs[1] = { &buf[0] };
+            try
+            {
+                bm::operation_deserializer<bvect>::count_and_batch(
+                                            bv_all, dblobs, 1, counts);
+            }
+            catch (std::logic_error&)
+            {
+            }
+            buf[pos] = c;
+        }
+    }
+    return 0;
+}
+
+static
+void FillSparseVector(svector_u32& sv, unsigned size, unsigned seed)
+{
+    for (unsigned i = 0; i < size; ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        switch ((i >> 14) & 3)
+        {
+        case 0: // small values
+            sv.set(i, (seed >> 16) & 0xFF);
+            break;
+        case 1: // zeros with rare large values
+            if ((seed >> 16) % 97 == 0)
+                sv.set(i, seed);
+            break;
+        case 2: // sorted run
+            sv.set(i, i * 3);
+            break;
+        default: // NULL (not set) for nullable vectors
+            break;
+        }
+    }
+    sv.resize(size);
+}
+
+static
+int SparseVectorSerialTest()
+{
+    const unsigned flags[6] = { 0, bm::BM_NO_BYTE_ORDER, bm::BM_XOR_REF, 
+                                bm::BM_CRC32C, bm::BM_AUTO_LEVEL, 
+                                bm::BM_SVB | bm::BM_XOR_REF | bm::BM_CRC32C };
+    for (unsigned nulls = 0; nulls < 2; ++nulls)
+    {
+        svector_u32 sv(nulls ? bm::use_null : bm::no_null);
+        FillSparseVector(sv, 200000, 7);
+        sv.optimize();
+
+        for (unsigned f = 0; f < 6; ++f)
+        {
+            bm::sparse_vector_serial_layout<svector_u32> sv_lay;
+            bm::sparse_vector_serialize(sv, sv_lay, 0, flags[f]);
+
+            // v2 header must be smaller than the v1 table of INT64 offsets
+            size_t hdr_size = sv_lay.size();
+            for (unsigned i = 0; i < sv.stored_plains(); ++i)
+            {
+                const unsigned char* p = sv_lay.get_plain(i);
+                if (p && size_t(p - sv_lay.buf()) < hdr_size)
+                    hdr_size = size_t(p - sv_lay.buf());
+            }
+            if (hdr_size >= 8 * sv.stored_plains())
+            {
+                printf("v2 header is too large: %u\n", unsigned(hdr_size));
+                return 1;
+            }
+
+            svector_u32 sv2(nulls ? bm::use_null : bm::no_null);
+            int res = bm::sparse_vector_deserialize(sv2, sv_lay.buf());
+            if (res != 0 || !sv.equal(sv2))
+            {
+                printf("sparse vector round trip failed flags=%u res=%i\n",
+                       flags[f], res);
+                return 1;
+            }
+        }
+    }
+
+    // v1 header (INT64 plain offsets) is still readable
+    {
+        svector_u32 sv;
+        FillSparseVector(sv, 100000, 3);
+        unsigned plains = sv.stored_plains();
+        std::vector<unsigned char> buf(1 + 1 + 1 + 1 + 8 + 8 * plains);
+        buf[0] = 'B'; buf[1] = 'M';
+        buf[2] = (unsigned char) bm::globals<true>::byte_order();
+        buf[3] = (unsigned char) plains;
+        bm::id64_t sz = sv.size();
+        ::memcpy(&buf[4], &sz, sizeof(sz));
+
+        bm::serializer<bvect> bvs;
+        bvs.gap_length_serialization(false);
+        for (unsigned i = 0; i < plains; ++i)
+        {
+            bm::id64_t offset = 0;
+            const bvect* bv = sv.plain(i);
+            if (bv)
+            {
+                offset = buf.size();
+                bm::serializer<bvect>::buffer pbuf;
+                bvs.serialize(*bv, pbuf, 0);
+                buf.insert(buf.end(), pbuf.buf(), pbuf.buf() + pbuf.size());
+            }
+            ::memcpy(&buf[12 + 8 * i], &offset, sizeof(offset));
+        }
+        svector_u32 sv2;
+        int res = bm::sparse_vector_deserialize(sv2, &buf[0]);
+        if (res != 0 || !sv.equal(sv2))
+        {
+            printf("v1 sparse vector BLOB is not restored, res=%i\n", res);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static
+int SparseVectorPartialTest()
+{
+    const unsigned flags[4] = { 0, bm::BM_XOR_REF, bm::BM_CRC32C,
+                                bm::BM_XOR_REF | bm::BM_CRC32C };
+    const bm::id64_t masks[4] = { ~0ull, 0xFFull, 0xF0F0ull, 0x80000001ull };
+    const unsigned ranges[4][2] = { {0, bm::id_max - 1}, {0, 30000},
+                                    {16000, 50001}, {70000, 300000} };
+
+    svector_u32 sv(bm::use_null);
+    FillSparseVector(sv, 150000, 11);
+    sv.optimize();
+
+    for (unsigned f = 0; f < 4; ++f)
+    {
+        bm::sparse_vector_serial_layout<svector_u32> sv_lay;
+        bm::sparse_vector_serialize(sv, sv_lay, 0, flags[f]);
+        for (unsigned m = 0; m < 4; ++m)
+        {
+            for (unsigned r = 0; r < 4; ++r)
+            {
+                for (unsigned ln = 0; ln < 2; ++ln)
+                {
+                    unsigned from = ranges[r][0], to = ranges[r][1];
+                    svector_u32 sv2(bm::use_null);
+                    int res = bm::sparse_vector_deserialize_partial(
+                                        sv2, sv_lay.buf(), masks[m], ln,
+                                        from, to);
+                    if (res != 0 || sv2.size() != sv.size())
+                    {
+                        printf("partial deserialization failed res=%i\n",
+                               res);
+                        return 1;
+                    }
+                    for (unsigned i = 0; i < sv.size(); ++i)
+                    {
+                        bool in_range = (i >= from && i <= to);
+                        unsigned v = in_range ? 
+                                        unsigned(sv.get(i) & masks[m]) : 0;
+                        bool is_null = !(ln && in_range && !sv.is_null(i));
+                        if (sv2.get(i) != v || sv2.is_null(i) != is_null)
+                        {
+                            printf("partial deserialization mismatch "
+                                   "flags=%u mask=%u range=%u null=%u "
+                                   "idx=%u %u!=%u\n", 
+                                   flags[f], m, r, ln, i, sv2.get(i), v);
+                            return 1;
+                        }
+                    }
+                }
+            }
+        }
+        if (!(flags[f] & bm::BM_CRC32C))
+            continue;
+        
+        // damaged plain is reported as an error, not restored silently
+        const unsigned char* p0 = sv_lay.get_plain(0);
+        const unsigned char* p1 = sv_lay.buf() + sv_lay.size();
+        for (unsigned i = 1; i < sv.stored_plains(); ++i)
+        {
+            if (sv_lay.get_plain(i))
+            {
+                p1 = sv_lay.get_plain(i);
+                break;
+            }
+        }
+        std::vector<unsigned char> buf(sv_lay.buf(),
+                                       sv_lay.buf() + sv_lay.size());
+        buf[(p0 - sv_lay.buf()) + (p1 - p0) / 2] ^= 0x21;
+        int err_count = 0;
+        for (unsigned r = 0; r < 2; ++r)
+        {
+            try
+            {
+                svector_u32 sv2(bm::use_null);
+                bm::sparse_vector_deserialize_partial(sv2, &buf[0], 1ull,
+                                                      false, ranges[r][0],
+                                                      ranges[r][1]);
+            }
+            catch (std::logic_error&)
+            {
+                ++err_count;
+            }
+        }
+        try
+        {
+            svector_u32 sv2(bm::use_null);
+            bm::sparse_vector_deserialize(sv2, &buf[0]);
+        }
+        catch (std::logic_error&)
+        {
+            ++err_count;
+        }
+        if (err_count != 3)
+        {
+            printf("damaged sparse vector BLOB not detected flags=%u (%i)\n",
+                   flags[f], err_count);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static
+void MakeKeyVector(bvect& bv, unsigned key)
+{
+    bv.clear();
+    bv.set_range(key * 10, key * 10 + (key % 50));
+    bv.set(key + 100000);
+}
+
+static
+int CompressedCollectionReaderTest()
+{
+    const unsigned keys_cnt = 200;
+    buffer_collection cbc;
+    bm::serializer<bvect> bvs;
+    for (unsigned i = 0; i < keys_cnt; ++i)
+    {
+        bvect bv;
+        MakeKeyVector(bv, i * 3);
+        bm::serializer<bvect>::buffer buf;
+        bvs.serialize(bv, buf, 0);
+        cbc.move_buffer(i * 3, buf);
+    }
+    cbc.sync();
+    
+    buffer_collection::buffer_type blob;
+    bm::compressed_collection_serializer<buffer_collection> cbcs;
+    cbcs.serialize(cbc, blob);
+    
+    for (unsigned cache_size = 0; cache_size < 3; ++cache_size)
+    {
+        bm::compressed_collection_reader<buffer_collection> rd(cache_size);
+        int res = rd.open(blob.buf(), blob.size());
+        if (res != 0 || rd.size() != keys_cnt)
+        {
+            printf("collection reader open failed res=%i\n", res);
+            return 1;
+        }
+        for (unsigned i = 0; i < keys_cnt; ++i)
+        {
+            bm::compressed_collection_reader<buffer_collection>::buffer_view v;
+            const buffer_collection::buffer_type& buf = cbc.at(i * 3);
+            if (!rd.get_view(i * 3, v) || v.size != buf.size() ||
+                ::memcmp(v.buf, buf.buf(), v.size) != 0)
+            {
+                printf("collection reader view mismatch key=%u\n", i * 3);
+                return 1;
+            }
+            bvect bv_ref, bv;
+            MakeKeyVector(bv_ref, i * 3);
+            const bvect* bv_c = rd.get_bvector(i * 3);
+            if (!rd.get_bvector(i * 3, bv) || bv != bv_ref || 
+                !bv_c || *bv_c != bv_ref)
+            {
+                printf("collection reader decode mismatch key=%u\n", i * 3);
+                return 1;
+            }
+        }
+        if (rd.get_bvector(1) || rd.get_bvector(keys_cnt * 3))
+        {
+            printf("collection reader found a missing key\n");
+            return 1;
+        }
+        rd.clear_cache();
+        
+        // LRU: A, B, A, C (evicts B), A
+        const unsigned ka = 3, kb = 6, kc = 9;
+        const bvect* pa = rd.get_bvector(ka);
+        const bvect* pb = rd.get_bvector(kb);
+        const bvect* pa2 = rd.get_bvector(ka);
+        const bvect* pc = rd.get_bvector(kc);
+        const bvect* pa3 = rd.get_bvector(ka);
+        bvect bv_ref;
+        MakeKeyVector(bv_ref, ka);
+        if (*pa3 != bv_ref)
+        {
+            printf("collection reader LRU decode mismatch\n");
+            return 1;
+        }
+        bool ok;
+        switch (cache_size)
+        {
+        case 0: // one scratch vector, re-decoded every time
+            ok = (pa == pb && pb == pa2 && pa2 == pc && pc == pa3);
+            break;
+        case 1: // every new key evicts the previous one
+            ok = (pa == pb && pa == pc && pa == pa3);
+            break;
+        default: // A stays cached, C takes the slot of B
+            ok = (pa != pb && pa == pa2 && pc == pb && pa3 == pa);
+            break;
+        }
+        if (!ok)
+        {
+            printf("collection reader LRU eviction failed cache=%u\n",
+                   cache_size);
+            return 1;
+        }
+    }
+    
+    // truncated BLOB is rejected before the tables are read past its end
+    for (size_t sz = 1; sz < blob.size(); sz += 1 + sz / 3)
+    {
+        std::vector<unsigned char> tbuf(blob.buf(), blob.buf() + sz);
+        bm::compressed_collection_reader<buffer_collection> rd;
+        int res = rd.open(&tbuf[0], tbuf.size());
+        if (res != -3 || rd.size() != 0)
+        {
+            printf("truncated collection BLOB (%u of %u) res=%i\n",
+                   unsigned(sz), unsigned(blob.size()), res);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static
+int EnumeratorDecodeTest()
+{
+    const unsigned batch[4] = { 1, 7, 100, 70000 };
+    for (unsigned k = 0; k < 6; ++k)
+    {
+        bvect bv;
+        if (k < 5)
+        {
+            FillTestVector(bv, k);
+        }
+        else // bits in the last block
+        {
+            bv.set(bm::id_max - 1);
+            bv.set_range(bm::id_max - 70000, bm::id_max - 60000);
+        }
+        for (unsigned opt = 0; opt < 2; ++opt)
+        {
+            if (opt)
+                bv.optimize(); // GAP blocks
+            std::vector<unsigned> ref;
+            for (bvect::enumerator en = bv.first(); en.valid(); ++en)
+            {
+                ref.push_back(*en);
+            }
+            for (unsigned b = 0; b < 4; ++b)
+            {
+                std::vector<unsigned> arr(batch[b]);
+                bvect::enumerator en = bv.first();
+                size_t pos = 0;
+                for (;;)
+                {
+                    unsigned cnt = en.decode(&arr[0], batch[b]);
+                    for (unsigned i = 0; i < cnt; ++i, ++pos)
+                    {
+                        if (pos >= ref.size() || arr[i] != ref[pos])
+                        {
+                            printf("enumerator decode mismatch k=%u opt=%u "
+                                   "batch=%u pos=%u\n", 
+                                   k, opt, batch[b], unsigned(pos));
+                            return 1;
+                        }
+                    }
+                    if (cnt < batch[b])
+                        break;
+                }
+                if (pos != ref.size() || en.valid())
+                {
+                    printf("enumerator decode count mismatch k=%u opt=%u "
+                           "batch=%u\n", k, opt, batch[b]);
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static
+void FillGapRuns(bvect& bv, std::vector<char>& bits, 
+                 unsigned max_run, unsigned seed)
+{
+    bool val = (seed & 1);
+    for (unsigned i = 0; i < bits.size(); )
+    {
+        seed = seed * 1103515245u + 12345u;
+        unsigned run = 1 + (seed >> 16) % max_run;
+        for (; run && i < bits.size(); --run, ++i)
+        {
+            bits[i] = val;
+            if (val)
+                bv.set(i);
+        }
+        val = !val;
+    }
+    bv.optimize();
+}
+
+static
+int GapOperationsTest()
+{
+    // from a few dozens to about a thousand run ends per block
+    const unsigned max_runs[5] = { 2000, 700, 150, 100, 60 };
+    const unsigned bits_size = bm::gap_max_bits * 3;
+    for (unsigned r1 = 0; r1 < 5; ++r1)
+    {
+        for (unsigned r2 = 0; r2 < 5; ++r2)
+        {
+            std::vector<char> b1(bits_size), b2(bits_size);
+            bvect bv1, bv2;
+            FillGapRuns(bv1, b1, max_runs[r1], r1 * 31 + r2);
+            FillGapRuns(bv2, b2, max_runs[r2], r2 * 17 + r1 + 1);
+            
+            unsigned cnt[4] = { 0, 0, 0, 0 };
+            for (unsigned i = 0; i < bits_size; ++i)
+            {
+                cnt[0] += (b1[i] & b2[i]);
+                cnt[1] += (b1[i] | b2[i]);
+                cnt[2] += (b1[i] ^ b2[i]);
+                cnt[3] += (b1[i] & !b2[i]);
+            }
+            if (bm::count_and(bv1, bv2) != cnt[0] ||
+                bm::count_or(bv1, bv2)  != cnt[1] ||
+                bm::count_xor(bv1, bv2) != cnt[2] ||
+                bm::count_sub(bv1, bv2) != cnt[3])
+            {
+                printf("GAP bitcount mismatch runs=%u,%u\n", r1, r2);
+                return 1;
+            }
+            
+            for (unsigned op = 0; op < 4; ++op)
+            {
+                bvect bv(bv1);
+                switch (op)
+                {
+                case 0: bv &= bv2; break;
+                case 1: bv |= bv2; break;
+                case 2: bv ^= bv2; break;
+                default: bv -= bv2; break;
+                }
+                for (unsigned i = 0; i < bits_size; ++i)
+                {
+                    bool v;
+                    switch (op)
+                    {
+                    case 0: v = b1[i] && b2[i]; break;
+                    case 1: v = b1[i] || b2[i]; break;
+                    case 2: v = b1[i] != b2[i]; break;
+                    default: v = b1[i] && !b2[i]; break;
+                    }
+                    if (bv.test(i) != v)
+                    {
+                        printf("GAP operation %u mismatch runs=%u,%u "
+                               "bit=%u\n", op, r1, r2, i);
+                        return 1;
+                    }
+                }
+                if (bv.count() != cnt[op])
+                {
+                    printf("GAP operation %u count mismatch\n", op);
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static
+int GapSearchTest()
+{
+    // GAP blocks from a couple of run ends (masked load) to ~1000
+    const unsigned max_runs[6] = { 60000, 20000, 5000, 700, 150, 100 };
+    const unsigned bits_size = bm::gap_max_bits * 2;
+    for (unsigned r = 0; r < 6; ++r)
+    {
+        std::vector<char> bits(bits_size);
+        bvect bv;
+        FillGapRuns(bv, bits, max_runs[r], r + 5);
+        
+        for (unsigned i = 0; i < bits_size; ++i)
+        {
+            if (bv.test(i) != bool(bits[i]))
+            {
+                printf("GAP test mismatch runs=%u bit=%u\n", r, i);
+                return 1;
+            }
+        }
+        unsigned seed = r;
+        for (unsigned k = 0; k < 200; ++k)
+        {
+            seed = seed * 1103515245u + 12345u;
+            unsigned from = (seed >> 8) % bits_size;
+            seed = seed * 1103515245u + 12345u;
+            unsigned to = from + (seed >> 8) % (bits_size - from);
+            unsigned cnt = 0;
+            for (unsigned i = from; i <= to; ++i)
+                cnt += bits[i];
+            if (bv.count_range(from, to) != cnt)
+            {
+                printf("GAP range count mismatch runs=%u [%u, %u]\n",
+                       r, from, to);
+                return 1;
+            }
+        }
+        // set_bit() / gap_set_value() on GAP blocks
+        for (unsigned k = 0; k < 500; ++k)
+        {
+            seed = seed * 1103515245u + 12345u;
+            unsigned i = (seed >> 8) % bits_size;
+            bits[i] = !bits[i];
+            bv.set(i, bits[i]);
+        }
+        for (unsigned i = 0; i < bits_size; ++i)
+        {
+            if (bv.test(i) != bool(bits[i]))
+            {
+                printf("GAP set_bit mismatch runs=%u bit=%u\n", r, i);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static
+int BitBlockRangeTest()
+{
+    // word (32/64-bit), SSE (128-bit) and AVX (256-bit) lane edges
+    const unsigned edges[] = { 0, 1, 31, 32, 33, 63, 64, 65, 127, 128, 129,
+                               255, 256, 257, 383, 384, 511, 512, 4095, 4096,
+                               65407, 65408, 65471, 65503, 65504, 65534,
+                               65535 };
+    const unsigned edges_cnt = unsigned(sizeof(edges) / sizeof(edges[0]));
+    
+    BM_DECLARE_TEMP_BLOCK(tb)
+    bm::word_t* blk = tb;
+    std::vector<unsigned> prefix(bm::gap_max_bits + 1);
+    unsigned seed = 17;
+    for (unsigned k = 0; k < 5; ++k)
+    {
+        for (unsigned i = 0; i < bm::set_block_size; ++i)
+        {
+            seed = seed * 1103515245u + 12345u;
+            bm::word_t w = seed ^ (seed << 13);
+            switch (k)
+            {
+            case 0: blk[i] = w; break;                      // dense
+            case 1: blk[i] = (i % 9) ? 0 : (w & (w >> 7)); break; // sparse
+            case 2: blk[i] = ~(w & (w >> 3) & (w >> 11)); break;  // mostly 1
+            case 3: blk[i] = 0; break;                      // edges only
+            case 4: blk[i] = ~0u; break;                    // full
+            }
+        }
+        if (k == 3)
+        {
+            for (unsigned e = 0; e < edges_cnt; e += 2)
+                blk[edges[e] >> 5] |= 1u << (edges[e] & 31);
+        }
+        prefix[0] = 0;
+        for (unsigned i = 0; i < bm::gap_max_bits; ++i)
+            prefix[i + 1] = prefix[i] + ((blk[i >> 5] >> (i & 31)) & 1);
+        
+        for (unsigned a = 0; a < edges_cnt + 100; ++a)
+        {
+            unsigned left = (a < edges_cnt) ? edges[a]
+                                    : (seed = seed * 1103515245u + 12345u,
+                                       (seed >> 8) % bm::gap_max_bits);
+            for (unsigned b = 0; b < edges_cnt + 20; ++b)
+            {
+                unsigned right = (b < edges_cnt) ? edges[b]
+                                    : (seed = seed * 1103515245u + 12345u,
+                                       left + (seed >> 8) %
+                                                (bm::gap_max_bits - left));
+                if (right < left)
+                    continue;
+                unsigned cnt = prefix[right + 1] - prefix[left];
+                if (bm::bit_block_calc_count_range(blk, left, right) != cnt)
+                {
+                    printf("count_range mismatch block=%u [%u, %u]\n",
+                           k, left, right);
+                    return 1;
+                }
+            }
+            if (bm::bit_block_calc_count_to(blk, left) != prefix[left + 1])
+            {
+                printf("count_to mismatch block=%u right=%u\n", k, left);
+                return 1;
+            }
+            // next 1 bit from left
+            unsigned next = left;
+            while (next < bm::gap_max_bits && 
+                   !((blk[next >> 5] >> (next & 31)) & 1))
+                ++next;
+            bm::id_t prev = left;
+            int found = bm::bit_find_in_block(blk, left, &prev);
+            if (bool(found) != (next < bm::gap_max_bits) ||
+                (found && prev != next))
+            {
+                printf("find_in_block mismatch block=%u from=%u\n", k, left);
+                return 1;
+            }
+        }
+        
+        // first bit at every edge
+        for (unsigned e = 0; e < edges_cnt; ++e)
+        {
+            BM_DECLARE_TEMP_BLOCK(tb2)
+            bm::word_t* blk2 = tb2;
+            for (unsigned i = 0; i < bm::set_block_size; ++i)
+                blk2[i] = (i < (edges[e] >> 5)) ? 0 : blk[i];
+            blk2[edges[e] >> 5] &= ~0u << (edges[e] & 31);
+            blk2[edges[e] >> 5] |= 1u << (edges[e] & 31);
+            unsigned first = ~0u;
+            if (!bm::bit_find_first(blk2, &first) || first != edges[e])
+            {
+                printf("bit_find_first mismatch block=%u %u != %u\n",
+                       k, first, edges[e]);
+                return 1;
+            }
+            for (unsigned i = 0; i < bm::set_block_size; ++i)
+                blk2[i] = 0;
+            if (bm::bit_find_first(blk2, &first))
+            {
+                printf("bit_find_first on empty block\n");
+                return 1;
+            }
+        }
+        
+        // bvector over the same bit block: count_range, enumerator go_to
+        {
+            const unsigned base = bm::gap_max_bits * 3;
+            const unsigned tail = bm::gap_max_bits * 5 + 7;
+            bvect bv;
+            for (unsigned i = 0; i < bm::gap_max_bits; ++i)
+            {
+                if ((blk[i >> 5] >> (i & 31)) & 1)
+                    bv.set_bit(base + i);
+            }
+            bv.set_bit(tail);
+            for (unsigned a = 0; a < edges_cnt; ++a)
+            {
+                for (unsigned b = a; b < edges_cnt; ++b)
+                {
+                    unsigned cnt = prefix[edges[b] + 1] - prefix[edges[a]];
+                    if (bv.count_range(base + edges[a], base + edges[b]) != cnt)
+                    {
+                        printf("bvector count_range mismatch block=%u "
+                               "[%u, %u]\n", k, edges[a], edges[b]);
+                        return 1;
+                    }
+                }
+                unsigned next = edges[a];
+                while (next < bm::gap_max_bits && 
+                       !((blk[next >> 5] >> (next & 31)) & 1))
+                    ++next;
+                unsigned exp = (next < bm::gap_max_bits) ? base + next : tail;
+                bvect::enumerator en = bv.first();
+                en.go_to(base + edges[a]);
+                if (!en.valid() || *en != exp)
+                {
+                    printf("enumerator go_to mismatch block=%u pos=%u\n",
+                           k, edges[a]);
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+template<class SV>
+int CheckImportExtract(const std::vector<typename SV::value_type>& vals,
+                       unsigned offset)
+{
+    typedef typename SV::value_type value_type;
+    SV sv;
+    sv.import(&vals[0], unsigned(vals.size()), offset);
+    if (sv.size() != offset + vals.size())
+    {
+        printf("import size mismatch %u\n", unsigned(sv.size()));
+        return 1;
+    }
+    for (unsigned i = 0; i < sv.size(); ++i)
+    {
+        value_type v = (i < offset) ? 0 : vals[i - offset];
+        if (sv.get(i) != v)
+        {
+            printf("import mismatch offset=%u idx=%u\n", offset, i);
+            return 1;
+        }
+    }
+    
+    const unsigned windows[5][2] = { {0, 10}, {5, 1500}, {65500, 100},
+                                     {1000, 70000}, {0, 500000} };
+    for (unsigned opt = 0; opt < 2; ++opt)
+    {
+        if (opt)
+            sv.optimize(); // GAP plains
+        for (unsigned w = 0; w < 5; ++w)
+        {
+            unsigned from = windows[w][0], size = windows[w][1];
+            std::vector<value_type> arr(size, value_type(7));
+            unsigned cnt = unsigned(sv.extract(&arr[0], size, from));
+            unsigned exp_cnt = (from >= sv.size()) ? 0 : 
+                         unsigned(size < sv.size() - from ? size 
+                                                          : sv.size() - from);
+            if (cnt != exp_cnt)
+            {
+                printf("extract count mismatch %u != %u\n", cnt, exp_cnt);
+                return 1;
+            }
+            for (unsigned i = 0; i < cnt; ++i)
+            {
+                if (arr[i] != sv.get(from + i))
+                {
+                    printf("extract mismatch opt=%u from=%u idx=%u\n",
+                           opt, from, from + i);
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static
+int SparseVectorImportExtractTest()
+{
+    // the transposition is its own inverse
+    {
+        bm::word_t src[32], dst[32], src2[32];
+        unsigned seed = 1;
+        for (unsigned i = 0; i < 32; ++i)
+        {
+            seed = seed * 1103515245u + 12345u;
+            src[i] = seed ^ (seed << 13);
+        }
+        bm::bit_transpose_32x32(src, dst);
+        for (unsigned i = 0; i < 32; ++i)
+        {
+            for (unsigned j = 0; j < 32; ++j)
+            {
+                if (((src[i] >> j) & 1u) != ((dst[j] >> i) & 1u))
+                {
+                    printf("bit transpose mismatch %u, %u\n", i, j);
+                    return 1;
+                }
+            }
+        }
+        bm::bit_transpose_32x32(dst, src2);
+        if (::memcmp(src, src2, sizeof(src)) != 0)
+        {
+            printf("bit transpose is not inverse\n");
+            return 1;
+        }
+    }
+    
+    const unsigned sizes[3] = { 100, 1000, 300000 };
+    const unsigned offsets[3] = { 0, 7, 65530 };
+    for (unsigned s = 0; s < 3; ++s)
+    {
+        std::vector<unsigned> v32(sizes[s]);
+        std::vector<bm::id64_t> v64(sizes[s]);
+        unsigned seed = s + 1;
+        for (unsigned i = 0; i < sizes[s]; ++i)
+        {
+            seed = seed * 1103515245u + 12345u;
+            v32[i] = (i & 1024) ? (seed >> (seed & 31)) : 0; // zero runs
+            v64[i] = (bm::id64_t(seed) << 29) ^ i;
+        }
+        for (unsigned o = 0; o < 3; ++o)
+        {
+            int res = CheckImportExtract<svector_u32>(v32, offsets[o]);
+            if (res == 0)
+                res = CheckImportExtract<svector_u64>(v64, offsets[o]);
+            if (res)
+            {
+                printf("size=%u offset=%u\n", sizes[s], offsets[o]);
+                return res;
+            }
+        }
+    }
+    return 0;
+}
+
+static
+int SparseVectorRangeScanTest()
+{
+    const unsigned probes[7] = { 0, 1, 100, 128, 255, 60000, ~0u };
+    for (unsigned nulls = 0; nulls < 2; ++nulls)
+    {
+        svector_u32 sv(nulls ? bm::use_null : bm::no_null);
+        FillSparseVector(sv, 70000, 5);
+        sv.set(69999, ~0u);
+        bm::sparse_vector_scanner<svector_u32> scanner;
+        for (unsigned opt = 0; opt < 2; ++opt)
+        {
+            if (opt)
+                sv.optimize();
+            for (unsigned a = 0; a < 7; ++a)
+            {
+                for (unsigned b = 0; b < 7; ++b)
+                {
+                    unsigned from = probes[a], to = probes[b];
+                    bvect bv_lt, bv_le, bv_gt, bv_ge, bv_range;
+                    bool one_sided = (b == 0);
+                    if (one_sided)
+                    {
+                        scanner.find_lt(sv, from, bv_lt);
+                        scanner.find_le(sv, from, bv_le);
+                        scanner.find_gt(sv, from, bv_gt);
+                        scanner.find_ge(sv, from, bv_ge);
+                    }
+                    scanner.find_range(sv, from, to, bv_range);
+                    for (unsigned i = 0; i < sv.size(); ++i)
+                    {
+                        bool not_null = !sv.is_null(i);
+                        unsigned v = sv.get(i);
+                        if ((one_sided && 
+                             (bv_lt.test(i) != (not_null && v < from) ||
+                              bv_le.test(i) != (not_null && v <= from) ||
+                              bv_gt.test(i) != (not_null && v > from) ||
+                              bv_ge.test(i) != (not_null && v >= from))) ||
+                            bv_range.test(i) != 
+                                (not_null && v >= from && v <= to))
+                        {
+                            printf("range scan mismatch nulls=%u opt=%u "
+                                   "[%u, %u] idx=%u\n", 
+                                   nulls, opt, from, to, i);
+                            return 1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static
+int SparseVectorAggregatorTest()
+{
+    for (unsigned nulls = 0; nulls < 2; ++nulls)
+    {
+        svector_u32 sv(nulls ? bm::use_null : bm::no_null);
+        FillSparseVector(sv, 70000, 9);
+        sv.optimize();
+        bm::sparse_vector_aggregator<svector_u32> agg;
+        
+        for (unsigned m = 0; m < 4; ++m)
+        {
+            bvect bv_mask;
+            switch (m)
+            {
+            case 0: break; // no mask
+            case 1: // every 3rd row
+                for (unsigned i = 0; i < 80000; i += 3)
+                    bv_mask.set(i);
+                break;
+            case 2: // rows never set (NULL or 0)
+                bv_mask.set_range(49152, 65535);
+                break;
+            default: // empty mask
+                break;
+            }
+            const bvect* mask = (m == 0) ? 0 : &bv_mask;
+            
+            bm::id_t cnt = 0;
+            bm::id64_t sum = 0;
+            unsigned min_v = ~0u, max_v = 0;
+            for (unsigned i = 0; i < sv.size(); ++i)
+            {
+                if (sv.is_null(i) || (mask && !mask->test(i)))
+                    continue;
+                unsigned v = sv.get(i);
+                ++cnt; sum += v;
+                if (v < min_v) min_v = v;
+                if (v > max_v) max_v = v;
+            }
+            unsigned a_min = 0, a_max = 0;
+            double avg = 0;
+            bool found_min = agg.find_min(sv, mask, a_min);
+            bool found_max = agg.find_max(sv, mask, a_max);
+            bool found_avg = agg.average(sv, mask, avg);
+            if (agg.count(sv, mask) != cnt || agg.sum(sv, mask) != sum ||
+                found_min != (cnt != 0) || found_max != (cnt != 0) ||
+                found_avg != (cnt != 0))
+            {
+                printf("aggregator count/sum mismatch nulls=%u mask=%u\n",
+                       nulls, m);
+                return 1;
+            }
+            if (cnt && (a_min != min_v || a_max != max_v || 
+                        avg != double(sum) / cnt))
+            {
+                printf("aggregator min/max/avg mismatch nulls=%u mask=%u "
+                       "%u/%u %u/%u\n", nulls, m, a_min, min_v, a_max, max_v);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static
+int SparseVectorFindEqTest()
+{
+    const unsigned probes[8] = { 0, 1, 7, 200, 3000, 98307, 1u << 31, ~0u };
+    for (unsigned nulls = 0; nulls < 2; ++nulls)
+    {
+        svector_u32 sv(nulls ? bm::use_null : bm::no_null);
+        FillSparseVector(sv, 70000, 21);
+        sv.set(69999, ~0u);
+        sv.set(200000, 1u << 31); // high plains have one block
+        bm::sparse_vector_scanner<svector_u32> scanner;
+        for (unsigned opt = 0; opt < 2; ++opt)
+        {
+            if (opt)
+                sv.optimize();
+            for (unsigned k = 0; k < 8; ++k)
+            {
+                bvect bv_res;
+                scanner.find_eq(sv, probes[k], bv_res);
+                for (unsigned i = 0; i < sv.size(); ++i)
+                {
+                    bool eq = !sv.is_null(i) && sv.get(i) == probes[k];
+                    if (bv_res.test(i) != eq)
+                    {
+                        printf("find_eq mismatch nulls=%u opt=%u value=%u "
+                               "idx=%u\n", nulls, opt, probes[k], i);
+                        return 1;
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static
+int SparseVectorCountSearchTest()
+{
+    const unsigned probes[6] = { 0, 7, 200, 3000, 98307, ~0u };
+    for (unsigned nulls = 0; nulls < 2; ++nulls)
+    {
+        svector_u32 sv(nulls ? bm::use_null : bm::no_null);
+        FillSparseVector(sv, 70000, 23);
+        sv.set(69999, ~0u);
+        sv.optimize();
+        bm::sparse_vector_scanner<svector_u32> scanner;
+        for (unsigned a = 0; a < 6; ++a)
+        {
+            for (unsigned b = a; b < 6; ++b)
+            {
+                unsigned from = probes[a], to = probes[b];
+                bm::id_t cnt_eq = 0, cnt_range = 0;
+                for (unsigned i = 0; i < sv.size(); ++i)
+                {
+                    if (sv.is_null(i))
+                        continue;
+                    unsigned v = sv.get(i);
+                    cnt_eq += (v == from);
+                    cnt_range += (v >= from && v <= to);
+                }
+                if (scanner.count_eq(sv, from) != cnt_eq ||
+                    scanner.any_eq(sv, from) != (cnt_eq != 0) ||
+                    scanner.count_range(sv, from, to) != cnt_range ||
+                    scanner.any_range(sv, from, to) != (cnt_range != 0))
+                {
+                    printf("count/any search mismatch nulls=%u [%u, %u]\n",
+                           nulls, from, to);
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static
+int SparseVectorGatherTest()
+{
+    svector_u32 sv;
+    FillSparseVector(sv, 200000, 29);
+    for (unsigned i = 131072; i < 196608; ++i) // full plain blocks
+        sv.set(i, ~0u);
+    
+    const unsigned sizes[3] = { 10, 5000, 150000 };
+    for (unsigned opt = 0; opt < 2; ++opt)
+    {
+        if (opt)
+            sv.optimize();
+        for (unsigned s = 0; s < 3; ++s)
+        {
+            std::vector<unsigned> idx(sizes[s]);
+            unsigned seed = s + 3;
+            for (unsigned order = 0; order < 3; ++order)
+            {
+                for (unsigned i = 0; i < sizes[s]; ++i)
+                {
+                    if (order == 0) // sorted, with repeats
+                        idx[i] = unsigned((bm::id64_t(i) * sv.size()) / sizes[s]);
+                    else // random
+                    {
+                        seed = seed * 1103515245u + 12345u;
+                        idx[i] = (seed >> 4) % sv.size();
+                    }
+                }
+                bm::sort_order so = (order == 0) ? bm::BM_SORTED : 
+                        (order == 1 ? bm::BM_UNSORTED : bm::BM_UNKNOWN);
+                std::vector<unsigned> arr(sizes[s]);
+                if (sv.gather(&arr[0], &idx[0], sizes[s], so) != sizes[s])
+                {
+                    printf("gather count mismatch\n");
+                    return 1;
+                }
+                for (unsigned i = 0; i < sizes[s]; ++i)
+                {
+                    if (arr[i] != sv.get(idx[i]))
+                    {
+                        printf("gather mismatch opt=%u size=%u order=%u "
+                               "idx=%u\n", opt, sizes[s], order, idx[i]);
+                        return 1;
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static
+int SparseVectorBackInserterTest()
+{
+    for (unsigned start = 0; start < 3; ++start)
+    {
+        const unsigned pre_size[3] = { 0, 1000, 70000 };
+        svector_u32 sv(bm::use_null), sv_ref(bm::use_null);
+        for (unsigned i = 0; i < pre_size[start]; ++i)
+        {
+            sv.set(i, i * 7);
+            sv_ref.set(i, i * 7);
+        }
+        {
+            svector_u32::back_insert_iterator bi = sv.get_back_inserter();
+            unsigned idx = sv_ref.size();
+            unsigned seed = start;
+            for (unsigned k = 0; k < 100000; ++k)
+            {
+                seed = seed * 1103515245u + 12345u;
+                unsigned r = (seed >> 16) % 100;
+                if (k == 50000)
+                    r = 99;
+                if (r < 80)
+                {
+                    unsigned v = (k & 4096) ? (seed >> 3) : (k & 0xFF);
+                    bi = v;
+                    sv_ref.set(idx++, v);
+                }
+                else if (r < 98)
+                {
+                    bi.add_null();
+                    sv_ref.resize(++idx);
+                }
+                else // runs of NULLs, one longer than a block
+                {
+                    unsigned cnt = (k == 50000) ? 70000 : 100;
+                    bi.add_null(cnt);
+                    idx += cnt;
+                    sv_ref.resize(idx);
+                }
+            }
+            // std::copy through a copy of the iterator keeps the order
+            std::vector<unsigned> tail(5000);
+            for (unsigned i = 0; i < 5000; ++i)
+            {
+                tail[i] = i ^ 0x55;
+                sv_ref.set(idx++, tail[i]);
+            }
+            std::copy(tail.begin(), tail.end(), bi);
+            bi.flush();
+        }
+        if (sv.size() != sv_ref.size())
+        {
+            printf("back inserter size mismatch %u != %u\n", 
+                   unsigned(sv.size()), unsigned(sv_ref.size()));
+            return 1;
+        }
+        for (unsigned i = 0; i < sv.size(); ++i)
+        {
+            if (sv.is_null(i) != sv_ref.is_null(i) || sv[i] != sv_ref[i])
+            {
+                printf("back inserter mismatch start=%u idx=%u\n", start, i);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static
+int SparseVectorIteratorTest()
+{
+    svector_u32 sv(bm::use_null);
+    FillSparseVector(sv, 150001, 31); // ends inside a block
+    sv.optimize();
+    
+    // prefix and postfix increments
+    {
+        unsigned i = 0;
+        svector_u32::const_iterator it = sv.begin();
+        svector_u32::const_iterator it_end = sv.end();
+        for (; it != it_end; ++i)
+        {
+            bool is_null = it.is_null();
+            unsigned v = (i & 1) ? *it++ : *it;
+            if (v != sv.get(i) || is_null != sv.is_null(i))
+            {
+                printf("iterator mismatch idx=%u\n", i);
+                return 1;
+            }
+            if (!(i & 1))
+                ++it;
+        }
+        if (i != sv.size())
+        {
+            printf("iterator count mismatch %u\n", i);
+            return 1;
+        }
+    }
+    
+    // copies and assignments of decoded iterators walk on their own
+    const unsigned starts[4] = { 0, 65000, 65535, 149000 };
+    for (unsigned k = 0; k < 4; ++k)
+    {
+        svector_u32::const_iterator it(&sv, starts[k]);
+        if (*it != sv.get(starts[k])) // decode the window
+            return 1;
+        ++it;
+        svector_u32::const_iterator it_copy(it);
+        svector_u32::const_iterator it_asgn;
+        it_asgn = it;
+        svector_u32::const_iterator it_cc(it_copy); // copy of a copy
+        for (unsigned n = 0; n < 3000; ++n) // the source goes first
+        {
+            if (!it.valid())
+                break;
+            ++it;
+        }
+        unsigned i = starts[k] + 1;
+        for (; it_copy.valid() && i < starts[k] + 3000; ++i, ++it_copy)
+        {
+            if (*it_copy != sv.get(i) || *it_asgn != sv.get(i) ||
+                *it_cc != sv.get(i))
+            {
+                printf("iterator copy mismatch start=%u idx=%u\n", 
+                       starts[k], i);
+                return 1;
+            }
+            ++it_asgn; ++it_cc;
+        }
+        if (it_copy.valid() != (i < sv.size()))
+        {
+            printf("iterator copy end mismatch start=%u\n", starts[k]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static
+int SparseVectorSignedTest()
+{
+    const unsigned sv_size = 70000;
+    std::vector<int> vals(sv_size);
+    unsigned seed = 37;
+    for (unsigned i = 0; i < sv_size; ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        if (i < 30000) // small values around 0
+            vals[i] = int((seed >> 16) % 200) - 100;
+        else if (i < 60000)
+            vals[i] = int(seed);
+        else
+            vals[i] = (i & 1) ? (-2147483647 - 1) : 2147483647;
+    }
+    
+    // small values of both signs use few plains
+    {
+        svector_i32 sv;
+        sv.import(&vals[0], 30000);
+        for (unsigned p = 8; p < sv.plains(); ++p)
+        {
+            if (sv.plain(p))
+            {
+                printf("signed vector uses plain %u\n", p);
+                return 1;
+            }
+        }
+    }
+    
+    // plain char follows the platform signedness
+    {
+        bm::sparse_vector<char, bvect> sv_c;
+        for (int v = -60; v <= 60; ++v)
+            sv_c.push_back(char(v));
+        bool plain7 = (sv_c.plain(7) != 0);
+        if (plain7 != (CHAR_MIN == 0))
+        {
+            printf("char vector plain 7 use is wrong: %i\n", int(plain7));
+            return 1;
+        }
+        for (unsigned i = 0; i < sv_c.size(); ++i)
+        {
+            if (sv_c.get(i) != char(int(i) - 60))
+            {
+                printf("char vector mismatch idx=%u\n", i);
+                return 1;
+            }
+        }
+        bm::sparse_vector_scanner<bm::sparse_vector<char, bvect> > scanner;
+        bvect bv_found;
+        scanner.find_eq(sv_c, char(-5), bv_found);
+        if (bv_found.count() != 1 || !bv_found.test(55))
+        {
+            printf("char vector search failed\n");
+            return 1;
+        }
+    }
+    
+    svector_i32 sv(bm::use_null);
+    sv.import(&vals[0], sv_size);
+    sv.set_null(100);
+    sv.optimize();
+    
+    // access paths
+    {
+        std::vector<int> arr(sv_size);
+        sv.decode(&arr[0], 0, sv_size);
+        std::vector<unsigned> idx(5000);
+        for (unsigned i = 0; i < 5000; ++i)
+            idx[i] = (i * 7919u) % sv_size;
+        std::vector<int> garr(5000);
+        sv.gather(&garr[0], &idx[0], 5000, bm::BM_UNSORTED);
+        svector_i32::const_iterator it = sv.begin();
+        for (unsigned i = 0; i < sv_size; ++i, ++it)
+        {
+            int v = (i == 100) ? 0 : vals[i];
+            if (sv.get(i) != v || arr[i] != v || *it != v)
+            {
+                printf("signed access mismatch idx=%u\n", i);
+                return 1;
+            }
+        }
+        for (unsigned i = 0; i < 5000; ++i)
+        {
+            if (garr[i] != sv.get(idx[i]))
+            {
+                printf("signed gather mismatch idx=%u\n", idx[i]);
+                return 1;
+            }
+        }
+    }
+    
+    // searches
+    {
+        bm::sparse_vector_scanner<svector_i32> scanner;
+        const int probes[6] = { -2147483647 - 1, -100, -1, 0, 5, 2147483647 };
+        for (unsigned a = 0; a < 6; ++a)
+        {
+            for (unsigned b = a; b < 6; ++b)
+            {
+                bvect bv_eq, bv_range, bv_in;
+                scanner.find_eq(sv, probes[a], bv_eq);
+                scanner.find_range(sv, probes[a], probes[b], bv_range);
+                scanner.find_eq(sv, &probes[a], &probes[b] + 1, bv_in);
+                for (unsigned i = 0; i < sv_size; ++i)
+                {
+                    bool not_null = !sv.is_null(i);
+                    int v = sv.get(i);
+                    bool in_list = false;
+                    for (unsigned j = a; j <= b; ++j)
+                        in_list |= (v == probes[j]);
+                    if (bv_eq.test(i) != (not_null && v == probes[a]) ||
+                        bv_range.test(i) != 
+                            (not_null && v >= probes[a] && v <= probes[b]) ||
+                        bv_in.test(i) != (not_null && in_list))
+                    {
+                        printf("signed search mismatch [%i, %i] idx=%u\n",
+                               probes[a], probes[b], i);
+                        return 1;
+                    }
+                }
+            }
+        }
+    }
+    
+    // aggregates
+    {
+        bm::sparse_vector_aggregator<svector_i32> agg;
+        bvect bv_mask;
+        bv_mask.set_range(0, 29999);
+        for (unsigned m = 0; m < 2; ++m)
+        {
+            const bvect* mask = m ? &bv_mask : 0;
+            bm::id64_t sum = 0;
+            int min_v = 2147483647, max_v = -2147483647 - 1;
+            for (unsigned i = 0; i < sv_size; ++i)
+            {
+                if (sv.is_null(i) || (mask && !mask->test(i)))
+                    continue;
+                int v = sv.get(i);
+                sum += bm::id64_t((long long)v);
+                if (v < min_v) min_v = v;
+                if (v > max_v) max_v = v;
+            }
+            int a_min = 0, a_max = 0;
+            if (agg.sum(sv, mask) != sum ||
+                !agg.find_min(sv, mask, a_min) || a_min != min_v ||
+                !agg.find_max(sv, mask, a_max) || a_max != max_v)
+            {
+                printf("signed aggregate mismatch mask=%u\n", m);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+typedef bm::str_sparse_vector<char, bvect, 16> str_svector;
+
+static
+int CheckStrVector(const str_svector& sv,
+                   const std::vector<std::string>& ref,
+                   const std::vector<bool>& nulls,
+                   const char* msg)
+{
+    if (sv.size() != ref.size())
+    {
+        printf("%s: size mismatch %u\n", msg, sv.size());
+        return 1;
+    }
+    char buf[str_svector::row_size];
+    for (unsigned i = 0; i < ref.size(); ++i)
+    {
+        unsigned len = sv.get(i, buf, sizeof(buf));
+        if (ref[i] != buf || len != ref[i].size() || sv.is_null(i) != nulls[i])
+        {
+            printf("%s: mismatch idx=%u '%s' != '%s'\n",
+                   msg, i, buf, ref[i].c_str());
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static
+int StrSparseVectorTest()
+{
+    const unsigned sv_size = 150000; // more than two import/extract chunks
+    std::vector<std::string> src(sv_size);
+    unsigned seed = 11;
+    for (unsigned i = 0; i < sv_size; ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        unsigned len = (seed >> 16) % 21; // some are longer than 16
+        if (i >= 70000 && i < 80000)
+            len = 0;
+        for (unsigned j = 0; j < len; ++j)
+            src[i] += char('a' + ((seed >> (j % 13)) + j) % 4);
+    }
+    std::vector<std::string> ref(sv_size);
+    std::vector<bool> nulls(sv_size, false);
+    for (unsigned i = 0; i < sv_size; ++i)
+        ref[i] = src[i].substr(0, 16);
+    
+    str_svector sv(bm::use_null);
+    for (unsigned i = 0; i < sv_size; ++i)
+        sv.push_back(src[i].c_str());
+    for (unsigned i = 0; i < sv_size; i += 997)
+    {
+        sv.set_null(i);
+        ref[i].clear();
+        nulls[i] = true;
+    }
+    if (CheckStrVector(sv, ref, nulls, "set"))
+        return 1;
+    
+    // overwrite with shorter strings leaves empty plains behind
+    {
+        str_svector sv1, sv2;
+        sv1.set(0, "abcdefghijk");
+        sv1.set(0, "ab");
+        sv2.set(0, "ab");
+        if (!sv1.equal(sv2) || !sv2.equal(sv1))
+        {
+            printf("str equal failed on empty plains\n");
+            return 1;
+        }
+        sv2.set(1, "");
+        if (sv1.equal(sv2) || sv2.equal(sv1))
+        {
+            printf("str equal failed on size\n");
+            return 1;
+        }
+        sv1.set(1, "x");
+        if (sv1.equal(sv2))
+        {
+            printf("str equal failed on content\n");
+            return 1;
+        }
+    }
+    
+    // import / extract
+    {
+        std::vector<const char*> strs(sv_size);
+        for (unsigned i = 0; i < sv_size; ++i)
+            strs[i] = nulls[i] ? 0 : src[i].c_str();
+        str_svector sv_imp(bm::use_null);
+        sv_imp.import(&strs[0], sv_size);
+        for (unsigned i = 0; i < sv_size; ++i)
+        {
+            if (nulls[i])
+                sv_imp.set_null(i);
+        }
+        if (CheckStrVector(sv_imp, ref, nulls, "import"))
+            return 1;
+        if (!sv_imp.equal(sv) || !sv.equal(sv_imp))
+        {
+            printf("str equal failed after import\n");
+            return 1;
+        }
+        
+        const unsigned offset = 1000;
+        std::vector<char> arr((sv_size - offset) * str_svector::row_size);
+        unsigned cnt = sv_imp.extract(&arr[0], sv_size, offset);
+        if (cnt != sv_size - offset)
+        {
+            printf("str extract size %u\n", cnt);
+            return 1;
+        }
+        for (unsigned i = 0; i < cnt; ++i)
+        {
+            if (ref[i + offset] != &arr[i * str_svector::row_size])
+            {
+                printf("str extract mismatch idx=%u\n", i + offset);
+                return 1;
+            }
+        }
+        
+        sv_imp.set(5, "zz");
+        if (sv_imp.equal(sv))
+        {
+            printf("str equal failed after set\n");
+            return 1;
+        }
+    }
+    
+    // searches
+    {
+        bm::str_sparse_vector_scanner<str_svector> scanner;
+        const char* probes[5] = { "", "a", "ab", "dcba", ref[12345].c_str() };
+        for (unsigned k = 0; k < 5; ++k)
+        {
+            bvect bv_eq, bv_prefix;
+            scanner.find_eq(sv, probes[k], bv_eq);
+            scanner.find_prefix(sv, probes[k], bv_prefix);
+            size_t plen = strlen(probes[k]);
+            for (unsigned i = 0; i < sv_size; ++i)
+            {
+                bool eq = !nulls[i] && ref[i] == probes[k];
+                bool prefix = !nulls[i] &&
+                              ref[i].compare(0, plen, probes[k]) == 0;
+                if (bv_eq.test(i) != eq || bv_prefix.test(i) != prefix)
+                {
+                    printf("str search mismatch '%s' idx=%u\n",
+                           probes[k], i);
+                    return 1;
+                }
+            }
+        }
+    }
+    
+    // remap / optimize
+    {
+        str_svector sv_r(sv);
+        sv_r.remap();
+        if (!sv_r.is_remapped())
+        {
+            printf("str remap failed\n");
+            return 1;
+        }
+        sv_r.optimize();
+        if (CheckStrVector(sv_r, ref, nulls, "remap"))
+            return 1;
+        str_svector sv_r2(sv);
+        sv_r2.optimize();
+        sv_r2.remap();
+        if (!sv_r.equal(sv_r2))
+        {
+            printf("str equal failed after remap\n");
+            return 1;
+        }
+        
+        unsigned j = 1;
+        while (ref[j].size() < 3)
+            ++j;
+        std::string prefix = ref[j].substr(0, 2);
+        bm::str_sparse_vector_scanner<str_svector> scanner;
+        bvect bv1, bv2;
+        scanner.find_prefix(sv, prefix.c_str(), bv1);
+        scanner.find_prefix(sv_r, prefix.c_str(), bv2);
+        if (bv1.compare(bv2) != 0 || !bv1.any())
+        {
+            printf("str search failed after remap\n");
+            return 1;
+        }
+    }
+    
+    // resize
+    {
+        str_svector sv_t(sv);
+        sv_t.resize(100);
+        ref.resize(100);
+        nulls.resize(100);
+        if (CheckStrVector(sv_t, ref, nulls, "resize"))
+            return 1;
+        sv_t.clear();
+        if (!sv_t.empty())
+        {
+            printf("str clear failed\n");
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/// block allocator which counts allocations
+class counting_block_allocator
+{
+public:
+    static bm::word_t* allocate(size_t n, const void* p)
+    {
+        ++alloc_cnt;
+        return bm::block_allocator::allocate(n, p);
+    }
+    static void deallocate(bm::word_t* p, size_t n)
+    {
+        bm::block_allocator::deallocate(p, n);
+    }
+    static unsigned alloc_cnt;
+};
+unsigned counting_block_allocator::alloc_cnt = 0;
+
+typedef bm::alloc_pool<counting_block_allocator, bm::ptr_allocator> 
+                                                        counting_alloc_pool;
+typedef bm::mem_alloc<counting_block_allocator, bm::ptr_allocator, 
+                      counting_alloc_pool>              counting_allocator;
+typedef bm::bvector<counting_allocator>                 bvect_cnt;
+typedef bm::sparse_vector<unsigned, bvect_cnt>          svector_cnt;
+
+static
+int SparseVectorFindEqListTest()
+{
+    for (unsigned nulls = 0; nulls < 2; ++nulls)
+    {
+        svector_u32 sv(nulls ? bm::use_null : bm::no_null);
+        FillSparseVector(sv, 70000, 13);
+        sv.set(69999, ~0u);
+        sv.optimize();
+        bm::sparse_vector_scanner<svector_u32> scanner;
+        
+        std::vector<unsigned> vals; // lists grow from case to case
+        for (unsigned k = 0; k < 5; ++k)
+        {
+            switch (k)
+            {
+            case 0: break; // empty list
+            case 1: vals.push_back(0); break;
+            case 2: // duplicates and absent values
+                vals.push_back(7); vals.push_back(7); vals.push_back(1000);
+                vals.push_back(~0u); vals.push_back(3u << 30);
+                break;
+            case 3: // sorted run values
+                for (unsigned v = 98304; v < 98304 + 3000; v += 3)
+                    vals.push_back(v);
+                break;
+            default: // descending (unsorted) small values
+                for (unsigned v = 256; v > 0; v -= 2)
+                    vals.push_back(v);
+                break;
+            }
+            bvect bv_res;
+            scanner.find_eq(sv, vals.begin(), vals.end(), bv_res);
+            for (unsigned i = 0; i < sv.size(); ++i)
+            {
+                bool found = false;
+                if (!sv.is_null(i))
+                {
+                    unsigned v = sv.get(i);
+                    for (size_t j = 0; j < vals.size() && !found; ++j)
+                        found = (vals[j] == v);
+                }
+                if (bv_res.test(i) != found)
+                {
+                    printf("IN-list search mismatch nulls=%u list=%u "
+                           "idx=%u\n", nulls, k, i);
+                    return 1;
+                }
+            }
+        }
+    }
+    
+    // extract() takes its temporary blocks from the pool
+    {
+        svector_cnt sv;
+        for (unsigned i = 0; i < 70000; ++i)
+            sv.set(i, (i / 100) & 0xFFFF);
+        sv.optimize(); // GAP plains
+        std::vector<unsigned> arr(70000);
+        counting_alloc_pool pool;
+        
+        sv.extract(&arr[0], 70000, 0, true, &pool);
+        counting_block_allocator::alloc_cnt = 0;
+        sv.extract(&arr[0], 70000, 0, true, &pool);
+        if (counting_block_allocator::alloc_cnt != 0)
+        {
+            printf("extract() ignores the memory pool\n");
+            return 1;
+        }
+        for (unsigned i = 0; i < 70000; ++i)
+        {
+            if (arr[i] != ((i / 100) & 0xFFFF))
+            {
+                printf("extract() with pool mismatch idx=%u\n", i);
+                return 1;
+            }
+        }
+        sv.extract(&arr[0], 70000, 0, true);
+        if (counting_block_allocator::alloc_cnt == 0)
+        {
+            printf("extract() without pool allocates no blocks\n");
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+
+int main(void)
+{
+    int res = 0;
+
+    res = SerializerEstimateTest();
+    if (res != 0)
+    {
+        printf("\nSerializerEstimateTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- SerializerEstimateTest OK\n");
+
+    res = SerializerRefTest();
+    if (res != 0)
+    {
+        printf("\nSerializerRefTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- SerializerRefTest OK\n");
+
+    res = SerializerCRCTest();
+    if (res != 0)
+    {
+        printf("\nSerializerCRCTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- SerializerCRCTest OK\n");
+
+    res = SerializerSVBTest();
+    if (res != 0)
+    {
+        printf("\nSerializerSVBTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- SerializerSVBTest OK\n");
+
+    res = SerializerBICTest();
+    if (res != 0)
+    {
+        printf("\nSerializerBICTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- SerializerBICTest OK\n");
+
+    res = CountAndBatchTest();
+    if (res != 0)
+    {
+        printf("\nCountAndBatchTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- CountAndBatchTest OK\n");
+
+    res = SparseVectorSerialTest();
+    if (res != 0)
+    {
+        printf("\nSparseVectorSerialTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- SparseVectorSerialTest OK\n");
+
+    res = SparseVectorPartialTest();
+    if (res != 0)
+    {
+        printf("\nSparseVectorPartialTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- SparseVectorPartialTest OK\n");
+
+    res = CompressedCollectionReaderTest();
+    if (res != 0)
+    {
+        printf("\nCompressedCollectionReaderTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- CompressedCollectionReaderTest OK\n");
+
+    res = EnumeratorDecodeTest();
+    if (res != 0)
+    {
+        printf("\nEnumeratorDecodeTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- EnumeratorDecodeTest OK\n");
+
+    res = GapOperationsTest();
+    if (res != 0)
+    {
+        printf("\nGapOperationsTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- GapOperationsTest OK\n");
+
+    res = GapSearchTest();
+    if (res != 0)
+    {
+        printf("\nGapSearchTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- GapSearchTest OK\n");
+
+    res = BitBlockRangeTest();
+    if (res != 0)
+    {
+        printf("\nBitBlockRangeTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- BitBlockRangeTest OK\n");
+
+    res = SparseVectorImportExtractTest();
+    if (res != 0)
+    {
+        printf("\nSparseVectorImportExtractTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- SparseVectorImportExtractTest OK\n");
+
+    res = SparseVectorRangeScanTest();
+    if (res != 0)
+    {
+        printf("\nSparseVectorRangeScanTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- SparseVectorRangeScanTest OK\n");
+
+    res = SparseVectorAggregatorTest();
+    if (res != 0)
+    {
+        printf("\nSparseVectorAggregatorTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- SparseVectorAggregatorTest OK\n");
+
+    res = SparseVectorFindEqListTest();
+    if (res != 0)
+    {
+        printf("\nSparseVectorFindEqListTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- SparseVectorFindEqListTest OK\n");
+
+    res = SparseVectorFindEqTest();
+    if (res != 0)
+    {
+        printf("\nSparseVectorFindEqTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- SparseVectorFindEqTest OK\n");
+
+    res = SparseVectorCountSearchTest();
+    if (res != 0)
+    {
+        printf("\nSparseVectorCountSearchTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- SparseVectorCountSearchTest OK\n");
+
+    res = SparseVectorGatherTest();
+    if (res != 0)
+    {
+        printf("\nSparseVectorGatherTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- SparseVectorGatherTest OK\n");
+
+    res = SparseVectorBackInserterTest();
+    if (res != 0)
+    {
+        printf("\nSparseVectorBackInserterTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- SparseVectorBackInserterTest OK\n");
+
+    res = SparseVectorIteratorTest();
+    if (res != 0)
+    {
+        printf("\nSparseVectorIteratorTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- SparseVectorIteratorTest OK\n");
+
+    res = SparseVectorSignedTest();
+    if (res != 0)
+    {
+        printf("\nSparseVectorSignedTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- SparseVectorSignedTest OK\n");
+
+    res = StrSparseVectorTest();
+    if (res != 0)
+    {
+        printf("\nStrSparseVectorTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- StrSparseVectorTest OK\n");
+
+
+
+    printf("\nbm C++ unit test OK\n");
+
+    return 0;
+}
@@ -1041,6 +1041,512 @@ int SerializationTest()
 }
 
 
+static
+int SerializationEstimateTest()
+{
+    int res = 0;
+    BM_BVHANDLE bmh = 0;
+    char* sbuf = 0;
+    unsigned int i, k;
+    struct BM_bvector_statistics bv_stat;
+    size_t blob_size, est_size;
+
+    res = BM_bvector_construct(&bmh, 0);
+    BMERR_CHECK(res, "BM_bvector_construct()");
+
+    for (k = 0; k < 4; ++k)
+    {
+        switch (k)
+        {
+        case 0: // sparse bits
+            for (i = 0; i < 1000000; i += 1000)
+            {
+                res = BM_bvector_set_bit(bmh, i, BM_TRUE);
+                BMERR_CHECK_GOTO(res, "BM_bvector_set_bit()", free_mem);
+            }
+            break;
+        case 1: // ranges
+            res = BM_bvector_set_range(bmh, 2000000, 3500000, BM_TRUE);
+            BMERR_CHECK_GOTO(res, "BM_bvector_set_range()", free_mem);
+            res = BM_bvector_set_range(bmh, 2000500, 2000700, BM_FALSE);
+            BMERR_CHECK_GOTO(res, "BM_bvector_set_range()", free_mem);
+            break;
+        case 2: // dense bits
+            for (i = 5000000; i < 5300000; i += 3)
+            {
+                res = BM_bvector_set_bit(bmh, i, BM_TRUE);
+                BMERR_CHECK_GOTO(res, "BM_bvector_set_bit()", free_mem);
+            }
+            break;
+        case 3: // islands of bits
+            for (i = 7000000; i < 7400000; i += 7)
+            {
+                if ((i / 4096) & 1)
+                {
+                    res = BM_bvector_set_bit(bmh, i, BM_TRUE);
+                    BMERR_CHECK_GOTO(res, "BM_bvector_set_bit()", free_mem);
+                }
+            }
+            break;
+        }
+
+        res = BM_bvector_optimize(bmh, 3, &bv_stat);
+        BMERR_CHECK_GOTO(res, "BM_bvector_optimize()", free_mem);
+
+        res = BM_bvector_serialize_estimate(bmh, &est_size);
+        BMERR_CHECK_GOTO(res, "BM_bvector_serialize_estimate()", free_mem);
+
+        sbuf = (char*) malloc(bv_stat.max_serialize_mem);
+        if (sbuf == 0)
+        {
+            printf("Failed to allocate serialization buffer.\n");
+            res = 1; goto free_mem;
+        }
+        res = BM_bvector_serialize(bmh, sbuf, bv_stat.max_serialize_mem, &blob_size);
+        BMERR_CHECK_GOTO(res, "BM_bvector_serialize()", free_mem);
+
+        if (est_size != blob_size)
+        {
+            printf("Serialization size estimate error: %u %u\n",
+                   (unsigned)est_size, (unsigned)blob_size);
+            res = 1; goto free_mem;
+        }
+        free(sbuf); sbuf = 0;
+    } // for k
+
+    free_mem:
+        if(sbuf) free(sbuf);
+        BM_bvector_free(bmh);
+
+    return res;
+}
+
+
+
+
+static
+int SerializationCRCTest()
+{
+    int res = 0;
+    BM_BVHANDLE bmh1 = 0;
+    BM_BVHANDLE bmh2 = 0;
+    BM_BVHANDLE bmh3 = 0;
+    char* sbuf = 0;
+    unsigned int i;
+    int cmp;
+    struct BM_bvector_statistics bv_stat;
+    size_t blob_size;
+
+    res = BM_bvector_construct(&bmh1, 0);
+    BMERR_CHECK(res, "BM_bvector_construct()");
+    res = BM_bvector_construct(&bmh2, 0);
+    BMERR_CHECK(res, "BM_bvector_construct()");
+    res = BM_bvector_construct(&bmh3, 0);
+    BMERR_CHECK(res, "BM_bvector_construct()");
+
+    for (i = 0; i < 3000000; i += 3)
+    {
+        res = BM_bvector_set_bit(bmh1, i, BM_TRUE);
+        BMERR_CHECK_GOTO(res, "BM_bvector_set_bit()", free_mem);
+    }
+    res = BM_bvector_set_range(bmh1, 4000000, 5000000, BM_TRUE);
+    BMERR_CHECK_GOTO(res, "BM_bvector_set_range()", free_mem);
+
+    res = BM_bvector_optimize(bmh1, 3, &bv_stat);
+    BMERR_CHECK_GOTO(res, "BM_bvector_optimize()", free_mem);
+
+    sbuf = (char*) malloc(bv_stat.max_serialize_mem);
+    if (sbuf == 0)
+    {
+        printf("Failed to allocate serialization buffer.\n");
+        res = 1; goto free_mem;
+    }
+    res = BM_bvector_serialize_crc(bmh1, sbuf, bv_stat.max_serialize_mem, &blob_size);
+    BMERR_CHECK_GOTO(res, "BM_bvector_serialize_crc()", free_mem);
+
+    res = BM_bvector_deserialize(bmh2, sbuf, blob_size);
+    BMERR_CHECK_GOTO(res, "BM_bvector_deserialize()", free_mem);
+
+    res = BM_bvector_compare(bmh1, bmh2, &cmp);
+    BMERR_CHECK_GOTO(res, "BM_bvector_compare()", free_mem);
+    if (cmp != 0)
+    {
+        printf("CRC serialization comparison failed!\n");
+        res = 1; goto free_mem;
+    }
+
+    // damage the BLOB, deserialization should detect it
+    //
+    sbuf[blob_size / 2] ^= 0x10;
+    res = BM_bvector_deserialize(bmh3, sbuf, blob_size);
+    if (res != BM_ERR_CRC)
+    {
+        printf("CRC check failed to detect corrupted BLOB! %i\n", res);
+        res = 1; goto free_mem;
+    }
+    sbuf[blob_size / 2] ^= 0x10;
+
+    // truncated BLOB is rejected without reading past the buffer size
+    //
+    res = BM_bvector_deserialize(bmh3, sbuf, blob_size / 2);
+    if (res != BM_ERR_CRC)
+    {
+        printf("CRC check failed to detect truncated BLOB! %i\n", res);
+        res = 1; goto free_mem;
+    }
+    res = 0;
+
+    free_mem:
+        if(sbuf) free(sbuf);
+        BM_bvector_free(bmh1);
+        BM_bvector_free(bmh2);
+        BM_bvector_free(bmh3);
+
+    return res;
+}
+
+
+
+
+int CountANDBlobsTest()
+{
+    int res = 0;
+    BM_BVHANDLE bmh_q = 0;
+    BM_BVHANDLE bmh[3] = {0, 0, 0};
+    char* sbuf[3] = {0, 0, 0};
+    const char* blobs[3];
+    unsigned int counts[3];
+    unsigned int count;
+    unsigned int i, j;
+    struct BM_bvector_statistics bv_stat;
+    size_t blob_size;
+
+    res = BM_bvector_construct(&bmh_q, 0);
+    BMERR_CHECK(res, "BM_bvector_construct()");
+    for (j = 0; j < 3; ++j)
+    {
+        res = BM_bvector_construct(&bmh[j], 0);
+        BMERR_CHECK_GOTO(res, "BM_bvector_construct()", free_mem);
+    }
+
+    res = BM_bvector_set_range(bmh_q, 100, 300000, BM_TRUE);
+    BMERR_CHECK_GOTO(res, "BM_bvector_set_range()", free_mem);
+    for (i = 1000000; i < 2000000; i += 7)
+    {
+        res = BM_bvector_set_bit(bmh_q, i, BM_TRUE);
+        BMERR_CHECK_GOTO(res, "BM_bvector_set_bit()", free_mem);
+    }
+
+    for (i = 0; i < 3000000; i += 5)
+    {
+        res = BM_bvector_set_bit(bmh[0], i, BM_TRUE);
+        BMERR_CHECK_GOTO(res, "BM_bvector_set_bit()", free_mem);
+    }
+    res = BM_bvector_set_range(bmh[1], 200000, 1500000, BM_TRUE);
+    BMERR_CHECK_GOTO(res, "BM_bvector_set_range()", free_mem);
+    res = BM_bvector_set_bit(bmh[2], 5000000, BM_TRUE);
+    BMERR_CHECK_GOTO(res, "BM_bvector_set_bit()", free_mem);
+
+    for (j = 0; j < 3; ++j)
+    {
+        res = BM_bvector_optimize(bmh[j], 3, &bv_stat);
+        BMERR_CHECK_GOTO(res, "BM_bvector_optimize()", free_mem);
+        sbuf[j] = (char*) malloc(bv_stat.max_serialize_mem);
+        if (sbuf[j] == 0)
+        {
+            printf("Failed to allocate serialization buffer.\n");
+            res = 1; goto free_mem;
+        }
+        res = BM_bvector_serialize(bmh[j], sbuf[j], bv_stat.max_serialize_mem, &blob_size);
+        BMERR_CHECK_GOTO(res, "BM_bvector_serialize()", free_mem);
+        blobs[j] = sbuf[j];
+    }
+
+    res = BM_bvector_count_AND_blobs(bmh_q, blobs, 3, counts);
+    BMERR_CHECK_GOTO(res, "BM_bvector_count_AND_blobs()", free_mem);
+
+    for (j = 0; j < 3; ++j)
+    {
+        res = BM_bvector_count_AND(bmh_q, bmh[j], &count);
+        BMERR_CHECK_GOTO(res, "BM_bvector_count_AND()", free_mem);
+        if (count != counts[j])
+        {
+            printf("count_AND_blobs mismatch %u: %u != %u\n", j, counts[j], count);
+            res = 1; goto free_mem;
+        }
+    }
+
+    free_mem:
+        BM_bvector_free(bmh_q);
+        for (j = 0; j < 3; ++j)
+        {
+            if (sbuf[j]) free(sbuf[j]);
+            BM_bvector_free(bmh[j]);
+        }
+
+    return res;
+}
+
+
+
+int EnumeratorBatchTest()
+{
+    int res = 0;
+    BM_BVHANDLE bmh1 = 0;
+    BM_BVEHANDLE bmeh1 = 0;
+    BM_BVEHANDLE bmeh2 = 0;
+    unsigned int arr[100];
+    size_t cnt, k;
+    size_t total = 0;
+    int valid;
+    unsigned int pos, i;
+
+    res = BM_bvector_construct(&bmh1, 0);
+    BMERR_CHECK(res, "BM_bvector_construct()");
+
+    for (i = 10; i < 200000; i += 3)
+    {
+        res = BM_bvector_set_bit(bmh1, i, BM_TRUE);
+        BMERR_CHECK_GOTO(res, "BM_bvector_set_bit()", free_mem);
+    }
+    res = BM_bvector_set_range(bmh1, 300000, 301000, BM_TRUE);
+    BMERR_CHECK_GOTO(res, "BM_bvector_set_range()", free_mem);
+
+    res = BM_bvector_enumerator_construct(bmh1, &bmeh1);
+    BMERR_CHECK_GOTO(res, "BM_bvector_enumerator_construct()", free_mem);
+    res = BM_bvector_enumerator_construct(bmh1, &bmeh2);
+    BMERR_CHECK_GOTO(res, "BM_bvector_enumerator_construct()", free_mem);
+
+    res = BM_bvector_enumerator_is_valid(bmeh2, &valid);
+    BMERR_CHECK_GOTO(res, "BM_bvector_enumerator_is_valid()", free_mem);
+    while (1)
+    {
+        res = BM_bvector_enumerator_next_batch(bmeh1, arr, 100, &cnt);
+        BMERR_CHECK_GOTO(res, "BM_bvector_enumerator_next_batch()", free_mem);
+        for (k = 0; k < cnt; ++k)
+        {
+            if (!valid)
+            {
+                printf("1. batch enumerator overrun at %u \n", arr[k]);
+                res = 1; goto free_mem;
+            }
+            res = BM_bvector_enumerator_get_value(bmeh2, &pos);
+            BMERR_CHECK_GOTO(res, "BM_bvector_enumerator_get_value()", free_mem);
+            if (pos != arr[k])
+            {
+                printf("2. incorrect batch value %u expected %u \n", arr[k], pos);
+                res = 1; goto free_mem;
+            }
+            res = BM_bvector_enumerator_next(bmeh2, &valid, &pos);
+            BMERR_CHECK_GOTO(res, "BM_bvector_enumerator_next()", free_mem);
+        }
+        total += cnt;
+        if (cnt < 100)
+            break;
+    }
+    if (valid)
+    {
+        printf("3. batch enumerator stopped early at %u \n", (unsigned)total);
+        res = 1; goto free_mem;
+    }
+    res = BM_bvector_enumerator_is_valid(bmeh1, &valid);
+    BMERR_CHECK_GOTO(res, "BM_bvector_enumerator_is_valid()", free_mem);
+    if (valid)
+    {
+        printf("4. incorrect batch enumerator valid %i \n", valid);
+        res = 1; goto free_mem;
+    }
+    if (total != 66664 + 1001)
+    {
+        printf("5. incorrect batch total %u \n", (unsigned)total);
+        res = 1; goto free_mem;
+    }
+
+    free_mem:
+        BM_bvector_enumerator_free(bmeh2);
+        BM_bvector_enumerator_free(bmeh1);
+        BM_bvector_free(bmh1);
+
+    return res;
+}
+
+
+
+int CountANDLimitTest()
+{
+    int res = 0;
+    BM_BVHANDLE bmh1 = 0;
+    BM_BVHANDLE bmh2 = 0;
+    unsigned int count, count_lim, i;
+    unsigned int limits[] = { 0, 1, 2, 100, 5000, 66666, 66667, 100000 };
+
+    res = BM_bvector_construct(&bmh1, 0);
+    BMERR_CHECK(res, "BM_bvector_construct()");
+    res = BM_bvector_construct(&bmh2, 0);
+    BMERR_CHECK_GOTO(res, "BM_bvector_construct()", free_mem);
+
+    for (i = 0; i < 400000; i += 2)
+    {
+        res = BM_bvector_set_bit(bmh1, i, BM_TRUE);
+        BMERR_CHECK_GOTO(res, "BM_bvector_set_bit()", free_mem);
+    }
+    for (i = 0; i < 400000; i += 3)
+    {
+        res = BM_bvector_set_bit(bmh2, i, BM_TRUE);
+        BMERR_CHECK_GOTO(res, "BM_bvector_set_bit()", free_mem);
+    }
+    res = BM_bvector_optimize(bmh2, 3, 0);
+    BMERR_CHECK_GOTO(res, "BM_bvector_optimize()", free_mem);
+
+    res = BM_bvector_count_AND(bmh1, bmh2, &count);
+    BMERR_CHECK_GOTO(res, "BM_bvector_count_AND()", free_mem);
+    if (count != 66667)
+    {
+        printf("1. incorrect count_AND %u \n", count);
+        res = 1; goto free_mem;
+    }
+    for (i = 0; i < sizeof(limits)/sizeof(limits[0]); ++i)
+    {
+        res = BM_bvector_count_AND_limit(bmh1, bmh2, limits[i], &count_lim);
+        BMERR_CHECK_GOTO(res, "BM_bvector_count_AND_limit()", free_mem);
+        if (count_lim != (count < limits[i] ? count : limits[i]))
+        {
+            printf("2. incorrect count_AND_limit %u for limit %u \n", 
+                   count_lim, limits[i]);
+            res = 1; goto free_mem;
+        }
+    }
+
+    free_mem:
+        BM_bvector_free(bmh2);
+        BM_bvector_free(bmh1);
+
+    return res;
+}
+
+
+
+int SparseVectorSearchTest()
+{
+    int res = 0;
+    BM_SVHANDLE svh = 0;
+    BM_BVHANDLE bmh = 0;
+    unsigned int* arr = 0;
+    unsigned int i, pass, count, any, size, val;
+    const unsigned int arr_size = 100000;
+
+    res = BM_svector_construct(&svh, BM_TRUE);
+    BMERR_CHECK(res, "BM_svector_construct()");
+    res = BM_bvector_construct(&bmh, 0);
+    BMERR_CHECK_GOTO(res, "BM_bvector_construct()", free_mem);
+
+    arr = (unsigned int*) malloc(arr_size * sizeof(unsigned int));
+    if (!arr)
+    {
+        printf("Failed to allocate memory\n");
+        res = 1; goto free_mem;
+    }
+    for (i = 0; i < arr_size; ++i)
+        arr[i] = i % 100;
+    res = BM_svector_import(svh, arr, arr_size, 0);
+    BMERR_CHECK_GOTO(res, "BM_svector_import()", free_mem);
+
+    // elements [arr_size..200000) stay NULL
+    res = BM_svector_set_value(svh, 200000, 1000000);
+    BMERR_CHECK_GOTO(res, "BM_svector_set_value()", free_mem);
+    res = BM_svector_get_size(svh, &size);
+    BMERR_CHECK_GOTO(res, "BM_svector_get_size()", free_mem);
+    if (size != 200001)
+    {
+        printf("1. incorrect sparse vector size %u \n", size);
+        res = 1; goto free_mem;
+    }
+    res = BM_svector_get_value(svh, 12345, &val);
+    BMERR_CHECK_GOTO(res, "BM_svector_get_value()", free_mem);
+    if (val != 45)
+    {
+        printf("2. incorrect sparse vector value %u \n", val);
+        res = 1; goto free_mem;
+    }
+    res = BM_svector_get_value(svh, size, &val);
+    if (res != BM_ERR_RANGE)
+    {
+        printf("3. get_value out of range not detected \n");
+        res = 1; goto free_mem;
+    }
+
+    for (pass = 0; pass < 2; ++pass)
+    {
+        res = BM_svector_count_eq(svh, 7, &count);
+        BMERR_CHECK_GOTO(res, "BM_svector_count_eq()", free_mem);
+        if (count != 1000)
+        {
+            printf("4. incorrect count_eq %u \n", count);
+            res = 1; goto free_mem;
+        }
+        res = BM_svector_count_eq(svh, 0, &count); // NULLs are not 0
+        BMERR_CHECK_GOTO(res, "BM_svector_count_eq()", free_mem);
+        if (count != 1000)
+        {
+            printf("5. incorrect count_eq(0) %u \n", count);
+            res = 1; goto free_mem;
+        }
+        res = BM_svector_find_eq(svh, 1000000, bmh);
+        BMERR_CHECK_GOTO(res, "BM_svector_find_eq()", free_mem);
+        res = BM_bvector_count(bmh, &count);
+        BMERR_CHECK_GOTO(res, "BM_bvector_count()", free_mem);
+        if (count != 1)
+        {
+            printf("6. incorrect find_eq %u \n", count);
+            res = 1; goto free_mem;
+        }
+        res = BM_svector_any_eq(svh, 100, &any);
+        BMERR_CHECK_GOTO(res, "BM_svector_any_eq()", free_mem);
+        if (any)
+        {
+            printf("7. incorrect any_eq \n");
+            res = 1; goto free_mem;
+        }
+        res = BM_svector_any_eq(svh, 99, &any);
+        BMERR_CHECK_GOTO(res, "BM_svector_any_eq()", free_mem);
+        if (!any)
+        {
+            printf("8. incorrect any_eq \n");
+            res = 1; goto free_mem;
+        }
+        res = BM_svector_count_range(svh, 10, 19, &count);
+        BMERR_CHECK_GOTO(res, "BM_svector_count_range()", free_mem);
+        if (count != 10000)
+        {
+            printf("9. incorrect count_range %u \n", count);
+            res = 1; goto free_mem;
+        }
+        res = BM_svector_count_range(svh, 0, 2000000, &count);
+        BMERR_CHECK_GOTO(res, "BM_svector_count_range()", free_mem);
+        if (count != arr_size + 1)
+        {
+            printf("10. incorrect count_range %u \n", count);
+            res = 1; goto free_mem;
+        }
+        res = BM_svector_any_range(svh, 100, 999999, &any);
+        BMERR_CHECK_GOTO(res, "BM_svector_any_range()", free_mem);
+        if (any)
+        {
+            printf("11. incorrect any_range \n");
+            res = 1; goto free_mem;
+        }
+        res = BM_svector_optimize(svh);
+        BMERR_CHECK_GOTO(res, "BM_svector_optimize()", free_mem);
+    } // for pass
+
+    free_mem:
+        free(arr);
+        BM_bvector_free(bmh);
+        BM_svector_free(svh);
+
+    return res;
+}
+
 
 
 int main(void)
@@ -1143,6 +1649,54 @@ int main(void)
     }
     printf("\n---------------------------------- SerializationTest OK\n");
 
+    res = SerializationEstimateTest();
+    if (res != 0)
+    {
+        printf("\nSerializationEstimateTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- SerializationEstimateTest OK\n");
+
+    res = SerializationCRCTest();
+    if (res != 0)
+    {
+        printf("\nSerializationCRCTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- SerializationCRCTest OK\n");
+
+    res = CountANDBlobsTest();
+    if (res != 0)
+    {
+        printf("\nCountANDBlobsTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- CountANDBlobsTest OK\n");
+
+    res = EnumeratorBatchTest();
+    if (res != 0)
+    {
+        printf("\nEnumeratorBatchTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- EnumeratorBatchTest OK\n");
+
+    res = CountANDLimitTest();
+    if (res != 0)
+    {
+        printf("\nCountANDLimitTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- CountANDLimitTest OK\n");
+
+    res = SparseVectorSearchTest();
+    if (res != 0)
+    {
+        printf("\nSparseVectorSearchTest failed!\n");
+        return res;
+    }
+    printf("\n---------------------------------- SparseVectorSearchTest OK\n");
+
 
     
     printf("\nlibbm unit test OK\n");